@@ -70,6 +70,7 @@ It handles initialization and termination by subclassing wxApp.
 #include "AColor.h"
 #include "AudioIO.h"
 #include "Benchmark.h"
+#include "RenderBenchmark.h"
 #include "Clipboard.h"
 #include "CrashReport.h"
 #include "DirManager.h"
@@ -122,6 +123,7 @@ It handles initialization and termination by subclassing wxApp.
 
 #include "ModuleManager.h"
 
+#include "effects/EqualizationBenchmark.h"
 #include "import/Import.h"
 
 #if defined(EXPERIMENTAL_CRASH_REPORT)
@@ -1610,6 +1612,20 @@ bool AudacityApp::OnInit()
             QuitAudacity(true);
          }
 
+         if (parser->Found(wxT("render-benchmark")))
+         {
+            wxPrintf( "%s",
+               RunRenderBenchmark( ProjectSettings::Get( *project ) ) );
+            QuitAudacity(true);
+         }
+
+         if (parser->Found(wxT("equalization-benchmark")))
+         {
+            wxPrintf( "%s",
+               RunEqualizationBenchmark( ProjectSettings::Get( *project ) ) );
+            QuitAudacity(true);
+         }
+
          // As of wx3, there's no need to process the filename arguments as they
          // will be sent via the MacOpenFile() method.
 #if !defined(__WXMAC__)
@@ -2110,6 +2126,14 @@ std::unique_ptr<wxCmdLineParser> AudacityApp::ParseCommandLine()
    /*i18n-hint: This runs a set of automatic tests on Audacity itself */
    parser->AddSwitch(wxT("t"), wxT("test"), _("run self diagnostics"));
 
+   /*i18n-hint: This times the drawing of tracks, and prints the results */
+   parser->AddSwitch(wxT(""), wxT("render-benchmark"),
+                     _("print timings of offscreen track drawing"));
+
+   /*i18n-hint: This times the Equalization effect, and prints the results */
+   parser->AddSwitch(wxT(""), wxT("equalization-benchmark"),
+                     _("print timings of equalization"));
+
    /*i18n-hint: This displays the Audacity version */
    parser->AddSwitch(wxT("v"), wxT("version"), _("display Audacity version"));
 
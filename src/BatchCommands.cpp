@@ -19,6 +19,8 @@ processing.  See also MacrosWindow and ApplyMacroDialog.
 #include "Audacity.h" // for USE_* macros
 #include "BatchCommands.h"
 
+#include <algorithm>
+
 #include <wx/defs.h>
 #include <wx/dir.h>
 #include <wx/filedlg.h>
@@ -814,6 +816,76 @@ bool MacroCommands::ApplyEffectCommand(
    return res;
 }
 
+size_t MacroCommands::FindEffectChain( size_t begin )
+{
+   // In batch-debug, each command is reported and skipped on its own
+   int bDebug;
+   gPrefs->Read(wxT("/Batch/Debug"), &bDebug, false);
+   if( bDebug != 0 )
+      return begin;
+
+   auto &em = EffectManager::Get();
+   std::vector<PluginID> IDs;
+   auto end = begin;
+   for (; end < mCommandMacro.size(); ++end) {
+      const auto &command = mCommandMacro[end];
+      if (std::any_of( std::begin( SpecialCommands ), std::end( SpecialCommands ),
+         [&]( const std::pair<TranslatableString, CommandID> &special ){
+            return special.second == command; } ))
+         break;
+
+      const PluginID & ID = em.GetEffectByIdentifier( command );
+      if (ID.empty())
+         break;
+      const PluginDescriptor *plug = PluginManager::Get().GetPlugin(ID);
+      if (!plug ||
+          plug->GetPluginType() != PluginTypeEffect ||
+          plug->GetEffectType() != EffectTypeProcess)
+         break;
+
+      // One effect object can't hold two sets of parameters at once
+      if (make_iterator_range( IDs ).contains( ID ))
+         break;
+      IDs.push_back( ID );
+   }
+
+   return end;
+}
+
+bool MacroCommands::ApplyEffectChain( size_t begin, size_t end )
+{
+   AudacityProject *project = &mProject;
+   auto &settings = ProjectSettings::Get( *project );
+   // Recalc flags and enable items that may have become enabled.
+   MenuManager::Get(*project).UpdateMenus(false);
+   // enter batch mode...
+   bool prevShowMode = settings.GetShowId3Dialog();
+   project->mBatchMode++;
+   auto cleanup = finally( [&] {
+      // exit batch mode...
+      settings.SetShowId3Dialog(prevShowMode);
+      project->mBatchMode--;
+   } );
+
+   // IF nothing selected, THEN select everything, as in ApplyEffectCommand
+   SelectUtilities::SelectAllIfNone( *project );
+
+   // Transfer the parameters to all of the effects before applying any
+   auto &em = EffectManager::Get();
+   std::vector<PluginID> IDs;
+   std::vector< decltype( em.SetBatchProcessing( PluginID{} ) ) > scopes;
+   for (auto i = begin; i < end; ++i) {
+      const PluginID & ID = em.GetEffectByIdentifier( mCommandMacro[i] );
+      scopes.push_back( em.SetBatchProcessing( ID ) );
+      if (!em.SetEffectParameters( ID, mParamsMacro[i] ))
+         return false;
+      IDs.push_back( ID );
+   }
+
+   const CommandContext context( mProject );
+   return EffectUI::DoEffectChain( IDs, context );
+}
+
 bool MacroCommands::HandleTextualCommand( CommandManager &commandManager,
    const CommandID & Str,
    const CommandContext & context, CommandFlag flags, bool alwaysEnabled)
@@ -982,6 +1054,16 @@ bool MacroCommands::ApplyMacro(
 
    size_t i = 0;
    for (; i < mCommandMacro.size(); i++) {
+      // Apply consecutive effects together, so that they can be streamed
+      // into each other without writing every intermediate result
+      const auto end = FindEffectChain(i);
+      if (end > i + 1) {
+         if (!ApplyEffectChain(i, end) || mAbort)
+            break;
+         i = end - 1;
+         continue;
+      }
+
       const auto &command = mCommandMacro[i];
       auto iter = catalog.ByCommandId(command);
       const auto friendly = (iter == catalog.end())
@@ -79,6 +79,10 @@ class MacroCommands final {
       const PluginID & ID, const TranslatableString &friendlyCommand,
       const CommandID & command,
       const wxString & params, const CommandContext & Context);
+   // Return the end of the run of consecutive process effects starting at
+   // begin, which may be applied together with ApplyEffectChain
+   size_t FindEffectChain( size_t begin );
+   bool ApplyEffectChain( size_t begin, size_t end );
    bool ReportAndSkip( const TranslatableString & friendlyCommand, const wxString & params );
    void AbortBatch();
 
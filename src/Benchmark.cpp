@@ -10,7 +10,7 @@
 
 \class BenchmarkDialog
 \brief BenchmarkDialog is used for measuring performance and accuracy
-of the BlockFile system.
+of the BlockFile system, and the throughput of the FFT.
 
 *//*******************************************************************/
 
@@ -42,6 +42,7 @@ of the BlockFile system.
 #include "Sequence.h"
 #include "Prefs.h"
 #include "ProjectSettings.h"
+#include "RealFFTf.h"
 #include "ViewInfo.h"
 
 #include "FileNames.h"
@@ -67,6 +68,8 @@ private:
    void HoldPrint(bool hold);
    void FlushPrint();
 
+   void BenchmarkFFT();
+
    const ProjectSettings &mSettings;
 
    bool      mHoldPrint;
@@ -564,6 +567,8 @@ void BenchmarkDialog::OnRun( wxCommandEvent & WXUNUSED(event))
    Printf( XO("At 44100 Hz, 16-bits per sample, the estimated number of\n simultaneous tracks that could be played at once: %.1f\n" )
       .Format( (nChunks*chunkSize/44100.0)/(elapsed/1000.0) ) );
 
+   BenchmarkFFT();
+
    goto success;
 
  fail:
@@ -576,3 +581,39 @@ void BenchmarkDialog::OnRun( wxCommandEvent & WXUNUSED(event))
    Printf( XO("Benchmark completed successfully.\n") );
    HoldPrint(false);
 }
+
+void BenchmarkDialog::BenchmarkFFT()
+{
+   Printf( XO("Measuring FFT throughput (%s)...\n")
+      .Format( RealFFTfImplementation() ) );
+
+   wxTheApp->Yield();
+   FlushPrint();
+
+   // Transform batches of frames totalling 1M samples, repeatedly, until
+   // enough time has passed for a stable measurement
+   const size_t totalSamples = 1 << 20;
+   Floats buffer{ totalSamples };
+   for (size_t i = 0; i < totalSamples; i++)
+      buffer[i] = (rand() % 65536 - 32768) / 32768.0f;
+
+   for (size_t fftLen = 256; fftLen <= 65536; fftLen *= 2) {
+      const auto hFFT = GetFFT(fftLen);
+      const auto count = totalSamples / fftLen;
+
+      wxStopWatch timer;
+      long elapsed = 0;
+      size_t frames = 0;
+      do {
+         for (size_t ii = 0; ii < count; ++ii) {
+            RealFFTf(&buffer[ii * fftLen], hFFT.get());
+            InverseRealFFTf(&buffer[ii * fftLen], hFFT.get());
+         }
+         frames += count;
+      } while ((elapsed = timer.Time()) < 250);
+
+      Printf( XO("FFT size %ld: %.1f forward and inverse pairs per ms, %.1f million samples per second\n")
+         .Format( (long)fftLen, frames / (double)elapsed,
+            frames * fftLen / (elapsed * 1000.0) ) );
+   }
+}
@@ -44,6 +44,7 @@ out.
 
 #include <float.h>
 #include <cmath>
+#include <limits>
 
 #include <wx/utils.h>
 #include <wx/filefn.h>
@@ -100,7 +101,8 @@ BlockFile::BlockFile(wxFileNameWrapper &&fileName, size_t samples):
    mLockCount(0),
    mFileName(std::move(fileName)),
    mLen(samples),
-   mSummaryInfo(samples)
+   mSummaryInfo(samples),
+   mSum(std::numeric_limits<double>::quiet_NaN())
 {
    mSilentLog=FALSE;
 }
@@ -216,6 +218,7 @@ void BlockFile::CalcSummaryFromBuffer(const float *fbuffer, size_t len,
    float min, max;
    float sumsq;
    double totalSquares = 0.0;
+   double totalSum = 0.0;
    double fraction { 0.0 };
 
    // Recalc 256 summaries
@@ -226,6 +229,7 @@ void BlockFile::CalcSummaryFromBuffer(const float *fbuffer, size_t len,
       min = fbuffer[i * 256];
       max = fbuffer[i * 256];
       sumsq = ((float)min) * ((float)min);
+      totalSum += min;
       decltype(len) jcount = 256;
       if (jcount > len - i * 256) {
          jcount = len - i * 256;
@@ -234,6 +238,7 @@ void BlockFile::CalcSummaryFromBuffer(const float *fbuffer, size_t len,
       for (decltype(jcount) j = 1; j < jcount; j++) {
          float f1 = fbuffer[i * 256 + j];
          sumsq += ((float)f1) * ((float)f1);
+         totalSum += f1;
          if (f1 < min)
             min = f1;
          else if (f1 > max)
@@ -258,6 +263,7 @@ void BlockFile::CalcSummaryFromBuffer(const float *fbuffer, size_t len,
 
    // Calculate now while we can do it accurately
    mRMS = sqrt(totalSquares/len);
+   mSum = totalSum;
 
    // Recalc 64K summaries
    sumLen = (len + 65535) / 65536;
@@ -409,6 +415,46 @@ auto BlockFile::GetMinMaxRMS(bool)
    return { mMin, mMax, mRMS };
 }
 
+/// Sums the samples of a portion of this BlockFile, reading them all.
+double BlockFile::GetSum(size_t start, size_t len, bool mayThrow) const
+{
+   SampleBuffer blockData(len, floatSample);
+
+   this->ReadData(blockData.ptr(), floatSample, start, len, mayThrow);
+
+   double sum = 0;
+   const auto samples = (const float*)blockData.ptr();
+   for( decltype(len) i = 0; i < len; i++ )
+      sum += samples[i];
+
+   return sum;
+}
+
+/// Retrieves the sum of all samples of this BlockFile.  Newly made blocks
+/// compute it with their summaries; others read their samples only the
+/// first time.
+double BlockFile::GetSum(bool mayThrow) const
+{
+   double sum = mSum;
+   if (std::isnan(sum)) {
+      // Don't remember zeroes that stand in for data not yet available
+      // or not readable
+      const bool available = IsDataAvailable();
+      SampleBuffer blockData(mLen, floatSample);
+      const auto read =
+         this->ReadData(blockData.ptr(), floatSample, 0, mLen, mayThrow);
+
+      sum = 0;
+      const auto samples = (const float*)blockData.ptr();
+      for( decltype(mLen) i = 0; i < mLen; i++ )
+         sum += samples[i];
+
+      if (available && read == mLen)
+         mSum = sum;
+   }
+   return sum;
+}
+
 /// Retrieves a portion of the 256-byte summary buffer from this BlockFile.  This
 /// data provides information about the minimum value, the maximum
 /// value, and the maximum RMS value for every group of 256 samples in the
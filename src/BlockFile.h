@@ -18,6 +18,7 @@
 
 #include "ondemand/ODTaskThread.h"
 
+#include <atomic>
 #include <functional>
 
 class XMLWriter;
@@ -137,6 +138,11 @@ class PROFILE_DLL_API BlockFile /* not final, abstract */ {
                           bool mayThrow = true) const;
    /// Gets extreme values for the entire block
    virtual MinMaxRMS GetMinMaxRMS(bool mayThrow = true) const;
+   /// Gets the sum of the samples in the specified region
+   double GetSum(size_t start, size_t len, bool mayThrow = true) const;
+   /// Gets the sum of the samples of the entire block, reading them only
+   /// if the sum was not found with the summary
+   double GetSum(bool mayThrow = true) const;
    /// Returns the 256 byte summary data block
    virtual bool Read256(float *buffer, size_t start, size_t len);
    /// Returns the 64K summary data block
@@ -245,6 +251,9 @@ class PROFILE_DLL_API BlockFile /* not final, abstract */ {
    size_t mLen;
    SummaryInfo mSummaryInfo;
    float mMin, mMax, mRMS;
+   // Not saved with the summary, so NaN until found; the samples never
+   // change, so once found it stays valid
+   mutable std::atomic<double> mSum;
    mutable bool mSilentLog;
 };
 
@@ -103,7 +103,8 @@ enum {
    FreqFuncChoiceID,
    FreqAxisChoiceID,
    ReplotButtonID,
-   GridOnOffID
+   GridOnOffID,
+   RecalcTimerID
 };
 
 // These specify the minimum plot window width
@@ -180,6 +181,7 @@ BEGIN_EVENT_TABLE(FrequencyPlotDialog, wxDialogWrapper)
    EVT_BUTTON(wxID_HELP, FrequencyPlotDialog::OnGetURL)
    EVT_CHECKBOX(GridOnOffID, FrequencyPlotDialog::OnGridOnOff)
    EVT_COMMAND(wxID_ANY, EVT_FREQWINDOW_RECALC, FrequencyPlotDialog::OnRecalc)
+   EVT_TIMER(RecalcTimerID, FrequencyPlotDialog::OnTimer)
 END_EVENT_TABLE()
 
 FrequencyPlotDialog::FrequencyPlotDialog(wxWindow * parent, wxWindowID id,
@@ -197,6 +199,8 @@ FrequencyPlotDialog::FrequencyPlotDialog(wxWindow * parent, wxWindowID id,
    mMouseY = 0;
    mRate = 0;
    mDataLen = 0;
+   mFirstResults = false;
+   mTimer.SetOwner(this, RecalcTimerID);
 
    TranslatableStrings algChoices{
       XO("Spectrum") ,
@@ -535,6 +539,9 @@ FrequencyPlotDialog::FrequencyPlotDialog(wxWindow * parent, wxWindowID id,
 
 FrequencyPlotDialog::~FrequencyPlotDialog()
 {
+   // Join the worker threads before the tracks they read go away
+   mTimer.Stop();
+   mTask.reset();
 }
 
 void FrequencyPlotDialog::OnGetURL(wxCommandEvent & WXUNUSED(event))
@@ -549,6 +556,8 @@ bool FrequencyPlotDialog::Show(bool show)
    if (!show)
    {
       mFreqPlot->SetCursor(*mArrowCursor);
+      StopRecalc();
+      mTracks.clear();
    }
 
    bool shown = IsShown();
@@ -559,8 +568,7 @@ bool FrequencyPlotDialog::Show(bool show)
       if(dBRange < 90.)
          dBRange = 90.;
       GetAudio();
-      // Don't send an event.  We need the recalc right away.
-      // so that mAnalyst is valid when we paint.
+      // Don't send an event.  Start the recalc right away.
       //SendRecalcEvent();
       Recalc();
    }
@@ -572,59 +580,36 @@ bool FrequencyPlotDialog::Show(bool show)
 
 void FrequencyPlotDialog::GetAudio()
 {
-   mData.reset();
+   StopRecalc();
+   mTracks.clear();
    mDataLen = 0;
 
+   // Copy the selection, which shares blocks with the project rather than
+   // reading the samples, so that any length can be analyzed in the
+   // background while the user goes on editing
    int selcount = 0;
-   bool warning = false;
    for (auto track : TrackList::Get( *mProject ).Selected< const WaveTrack >()) {
       auto &selectedRegion = ViewInfo::Get( *mProject ).selectedRegion;
       if (selcount==0) {
          mRate = track->GetRate();
          auto start = track->TimeToLongSamples(selectedRegion.t0());
          auto end = track->TimeToLongSamples(selectedRegion.t1());
-         auto dataLen = end - start;
-         if (dataLen > 10485760) {
-            warning = true;
-            mDataLen = 10485760;
-         }
-         else
-            // dataLen is not more than 10 * 2 ^ 20
-            mDataLen = dataLen.as_size_t();
-         mData = Floats{ mDataLen };
-         // Don't allow throw for bad reads
-         track->Get((samplePtr)mData.get(), floatSample, start, mDataLen,
-                    fillZero, false);
+         mDataLen = end - start;
       }
       else {
          if (track->GetRate() != mRate) {
             AudacityMessageBox(
                XO(
 "To plot the spectrum, all selected tracks must be the same sample rate.") );
-            mData.reset();
+            mTracks.clear();
             mDataLen = 0;
             return;
          }
-         auto start = track->TimeToLongSamples(selectedRegion.t0());
-         Floats buffer2{ mDataLen };
-         // Again, stop exceptions
-         track->Get((samplePtr)buffer2.get(), floatSample, start, mDataLen,
-                    fillZero, false);
-         for (size_t i = 0; i < mDataLen; i++)
-            mData[i] += buffer2[i];
       }
+      mTracks.push_back( std::static_pointer_cast<const WaveTrack>(
+         track->Copy(selectedRegion.t0(), selectedRegion.t1(), false) ) );
       selcount++;
    }
-
-   if (selcount == 0)
-      return;
-
-   if (warning) {
-      auto msg = XO(
-"Too much audio was selected. Only the first %.1f seconds of audio will be analyzed.")
-         .Format(mDataLen / mRate);
-      AudacityMessageBox( msg );
-   }
 }
 
 void FrequencyPlotDialog::OnSize(wxSizeEvent & WXUNUSED(event))
@@ -660,7 +645,7 @@ void FrequencyPlotDialog::DrawBackground(wxMemoryDC & dc)
 
 void FrequencyPlotDialog::DrawPlot()
 {
-   if (!mData || mDataLen < mWindowSize || mAnalyst->GetProcessedSize() == 0) {
+   if (mTracks.empty() || mDataLen < mWindowSize || mAnalyst->GetProcessedSize() == 0) {
       wxMemoryDC memDC;
 
       vRuler->ruler.SetLog(false);
@@ -878,7 +863,8 @@ void FrequencyPlotDialog::PlotPaint(wxPaintEvent & event)
 
    dc.DrawBitmap( *mBitmap, 0, 0, true );
    // Fix for Bug 1226 "Plot Spectrum freezes... if insufficient samples selected"
-   if (!mData || mDataLen < mWindowSize)
+   if (mTracks.empty() || mDataLen < mWindowSize ||
+       mAnalyst->GetProcessedSize() == 0)
       return;
 
    dc.SetFont(mFreqFont);
@@ -999,35 +985,77 @@ void FrequencyPlotDialog::SendRecalcEvent()
 
 void FrequencyPlotDialog::Recalc()
 {
-   if (!mData || mDataLen < mWindowSize) {
-      DrawPlot();
-      return;
-   }
+   StopRecalc();
 
    SpectrumAnalyst::Algorithm alg =
       SpectrumAnalyst::Algorithm(mAlgChoice->GetSelection());
    int windowFunc = mFuncChoice->GetSelection();
 
-   wxWindow *hadFocus = FindFocus();
-   // In wxMac, the skipped window MUST be a top level window.  I'd originally made it
-   // just the mProgress window with the idea of preventing user interaction with the
-   // controls while the plot was being recalculated.  This doesn't appear to be necessary
-   // so just use the top level window instead.
-   {
-      Optional<wxWindowDisabler> blocker;
-      if (IsShown())
-         blocker.emplace(this);
-      wxYieldIfNeeded();
-
-      mAnalyst->Calculate(alg, windowFunc, mWindowSize, mRate,
-         mData.get(), mDataLen,
-         &mYMin, &mYMax, mProgress);
+   // Start clears any old results
+   if (!mAnalyst->Start(alg, windowFunc, mWindowSize, mRate) ||
+       mTracks.empty() || mDataLen < mWindowSize) {
+      DrawPlot();
+      return;
    }
-   if (hadFocus) {
-      hadFocus->SetFocus();
+
+   // Calculate on other threads, and poll for results, so that the dialog
+   // and the project stay responsive
+   mTask = std::make_unique<SpectrumAnalysisTask>(
+      *mAnalyst, mTracks, mDataLen);
+   mFirstResults = true;
+   mProgress->SetRange(1000);
+   mTimer.Start(200);
+   DrawPlot();
+}
+
+void FrequencyPlotDialog::StopRecalc()
+{
+   mTimer.Stop();
+   if (mTask) {
+      mTask.reset();
+      mProgress->Reset();
    }
+}
+
+void FrequencyPlotDialog::OnTimer(wxTimerEvent & WXUNUSED(event))
+{
+   if (!mTask)
+      return;
+
+   std::vector<float> sums;
+   bool done = false;
+   const auto windows = mTask->GetSums(sums, done);
+   if (mTask->Failed()) {
+      // Don't leave a plot of only part of the selection
+      StopRecalc();
+      mAnalyst->Start(SpectrumAnalyst::Algorithm(mAlgChoice->GetSelection()),
+         mFuncChoice->GetSelection(), mWindowSize, mRate);
+      DrawPlot();
+      AudacityMessageBox(
+         XO("Some of the selected audio could not be read, so its spectrum is not plotted."));
+      return;
+   }
+   const auto total = std::max<size_t>(1, mTask->GetTotalWindows());
+   mProgress->SetValue(1000 * windows / total);
+
+   if (done)
+      StopRecalc();
+
+   // Plot the average so far.  Prime the scrollbar on the first and the
+   // last results only, so that the user may pan in between.
+   if (windows > 0) {
+      ShowResults(sums, windows, mFirstResults || done);
+      mFirstResults = false;
+   }
+}
+
+void FrequencyPlotDialog::ShowResults(
+   const std::vector<float> &sums, size_t windows, bool primeScrollbar)
+{
+   mAnalyst->Finish(sums.data(), windows, &mYMin, &mYMax);
 
-   if (alg == SpectrumAnalyst::Spectrum) {
+   if (mAnalyst->GetProcessedSize() > 0 &&
+       mAlgChoice->GetSelection() == SpectrumAnalyst::Spectrum) {
       if(mYMin < -dBRange)
          mYMin = -dBRange;
       if(mYMax <= -dBRange)
@@ -1037,7 +1065,8 @@ void FrequencyPlotDialog::Recalc()
    }
 
    // Prime the scrollbar
-   mPanScroller->SetScrollbar(0, (mYMax - mYMin) * 100, (mYMax - mYMin) * 100, 1);
+   if (primeScrollbar)
+      mPanScroller->SetScrollbar(0, (mYMax - mYMin) * 100, (mYMax - mYMin) * 100, 1);
 
    DrawPlot();
 }
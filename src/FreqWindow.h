@@ -14,6 +14,7 @@
 #include <vector>
 #include <wx/font.h> // member variable
 #include <wx/statusbr.h> // to inherit
+#include <wx/timer.h> // member variable
 #include "SampleFormat.h"
 #include "SpectrumAnalyst.h"
 #include "widgets/wxPanelWrapper.h" // to inherit
@@ -28,6 +29,7 @@ class wxChoice;
 
 class AudacityProject;
 class FrequencyPlotDialog;
+class WaveTrack;
 class FreqGauge;
 class RulerPanel;
 
@@ -82,9 +84,13 @@ private:
    void OnReplot(wxCommandEvent & event);
    void OnGridOnOff(wxCommandEvent & event);
    void OnRecalc(wxCommandEvent & event);
+   void OnTimer(wxTimerEvent & event);
 
    void SendRecalcEvent();
    void Recalc();
+   void StopRecalc();
+   void ShowResults(const std::vector<float> &sums, size_t windows,
+      bool primeScrollbar);
    void DrawPlot();
    void DrawBackground(wxMemoryDC & dc);
 
@@ -130,10 +136,16 @@ private:
 
 
    double mRate;
-   size_t mDataLen;
-   Floats mData;
+   sampleCount mDataLen;
+   // Copies of the selected audio, sharing the project's blocks
+   std::vector< std::shared_ptr<const WaveTrack> > mTracks;
    size_t mWindowSize;
 
+   // Calculation in progress, and the timer polling it
+   std::unique_ptr<SpectrumAnalysisTask> mTask;
+   wxTimer mTimer;
+   bool mFirstResults;
+
    bool mLogAxis;
    float mYMin;
    float mYMax;
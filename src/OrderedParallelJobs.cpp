@@ -0,0 +1,159 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+OrderedParallelJobs.cpp
+
+*******************************************************************//**
+
+\class OrderedParallelJobs
+\brief Has worker threads make numbered pieces of output, which one
+thread takes in order.
+
+  Effects and resampling divide long selections into segments that can
+be computed independently, but whose output must be appended in order.
+Workers take the next segment as they become free.  The thread that runs
+them waits for the first segment not yet taken, and reports progress
+meanwhile.
+
+*//*******************************************************************/
+
+#include "Audacity.h"
+#include "OrderedParallelJobs.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "MemoryX.h"
+
+constexpr size_t OrderedParallelJobs::Unbounded;
+
+size_t OrderedParallelJobs::DefaultThreadCount(size_t nPieces)
+{
+   return std::max<size_t>(1,
+      std::min<size_t>(nPieces, std::thread::hardware_concurrency()));
+}
+
+OrderedParallelJobs::OrderedParallelJobs(size_t nThreads, size_t maxAhead)
+   : mNThreads{ std::max<size_t>(1, nThreads) }
+   , mMaxAhead{ maxAhead ? maxAhead : 2 * mNThreads }
+   , mCancelled{ false }
+{
+}
+
+bool OrderedParallelJobs::Run(size_t nPieces, const WorkFunction &work,
+   const TakeFunction &take, const ProgressFunction &progress)
+{
+   return Run( [=](size_t piece){ return piece < nPieces; },
+      work, take, progress );
+}
+
+bool OrderedParallelJobs::Run(const ClaimFunction &claim,
+   const WorkFunction &work, const TakeFunction &take,
+   const ProgressFunction &progress)
+{
+   // The joiner of an earlier run left this set
+   mCancelled = false;
+
+   // These are guarded by the mutex.  pending has the done flags of the
+   // pieces from the first not yet taken to the last claimed.
+   size_t nClaimed = 0;
+   size_t nTaken = 0;
+   bool exhausted = false;
+   std::deque<bool> pending;
+   std::exception_ptr error;
+
+   const auto worker = [&](size_t thread) {
+      try {
+         while (true) {
+            size_t piece;
+            {
+               std::unique_lock<std::mutex> lock{ mMutex };
+               mCondition.wait(lock, [&]{
+                  return mCancelled || exhausted ||
+                     nClaimed - nTaken < mMaxAhead; });
+               if (mCancelled || exhausted)
+                  break;
+               if (!claim(nClaimed)) {
+                  exhausted = true;
+                  break;
+               }
+               piece = nClaimed++;
+               pending.push_back(false);
+            }
+
+            work(thread, piece);
+
+            {
+               std::lock_guard<std::mutex> locker{ mMutex };
+               pending[piece - nTaken] = true;
+            }
+            mCondition.notify_all();
+         }
+      }
+      catch (...) {
+         std::lock_guard<std::mutex> locker{ mMutex };
+         if (!error)
+            error = std::current_exception();
+         mCancelled = true;
+      }
+      mCondition.notify_all();
+   };
+
+   bool result = true;
+   {
+      std::vector<std::thread> threads;
+      auto joiner = finally( [&] {
+         {
+            std::lock_guard<std::mutex> locker{ mMutex };
+            mCancelled = true;
+         }
+         mCondition.notify_all();
+         for (auto &thread : threads)
+            thread.join();
+      } );
+      for (size_t ii = 0; ii < mNThreads; ++ii)
+         threads.emplace_back(worker, ii);
+
+      // Only this thread takes pieces, in order
+      while (true) {
+         bool ready = false;
+         {
+            std::unique_lock<std::mutex> lock{ mMutex };
+            const auto finished = [&]{
+               return exhausted && nTaken == nClaimed; };
+            mCondition.wait_for(lock, std::chrono::milliseconds(50), [&]{
+               return error || finished() ||
+                  (!pending.empty() && pending.front()); });
+            if (error || finished())
+               break;
+            ready = !pending.empty() && pending.front();
+         }
+
+         if (ready) {
+            take(nTaken);
+
+            {
+               std::lock_guard<std::mutex> locker{ mMutex };
+               pending.pop_front();
+               ++nTaken;
+            }
+            mCondition.notify_all();
+         }
+
+         if (!progress(nTaken)) {
+            result = false;
+            break;
+         }
+      }
+   }
+
+   if (error)
+      std::rethrow_exception(error);
+
+   return result;
+}
@@ -0,0 +1,75 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+OrderedParallelJobs.h
+
+***********************************************************************/
+
+#ifndef __AUDACITY_ORDERED_PARALLEL_JOBS__
+#define __AUDACITY_ORDERED_PARALLEL_JOBS__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+/// \brief Has worker threads make numbered pieces of output, which the
+/// thread that calls Run() takes in order.
+///
+/// Workers begin pieces in order of their numbers, but may finish them in
+/// any order.  No piece is begun while the piece MaxAhead() before it is not
+/// yet taken, so that the memory of finished pieces waiting for earlier ones
+/// is bounded.  Only the thread that calls Run() takes pieces, so it may
+/// make block files.
+class OrderedParallelJobs
+{
+public:
+   /// Called on a worker thread, never by two at once, to ready the piece
+   /// with the given number; returns false when there are no more pieces
+   using ClaimFunction = std::function< bool(size_t piece) >;
+   /// Called on a worker thread to make a piece; thread is less than
+   /// ThreadCount(), and no two workers have the same
+   using WorkFunction = std::function< void(size_t thread, size_t piece) >;
+   /// Called on the thread of Run() for each finished piece, in order
+   using TakeFunction = std::function< void(size_t piece) >;
+   /// Called on the thread of Run() after each piece is taken, and at least
+   /// every 50 ms, with the number of pieces taken; returns false to cancel
+   using ProgressFunction = std::function< bool(size_t nTaken) >;
+
+   static constexpr size_t Unbounded = std::numeric_limits<size_t>::max();
+
+   /// One thread for each processor, but no more than there are pieces
+   static size_t DefaultThreadCount(size_t nPieces = Unbounded);
+
+   /// maxAhead is how many pieces may be begun from the first not yet
+   /// taken; 0 means twice the number of threads
+   explicit OrderedParallelJobs(size_t nThreads, size_t maxAhead = 0);
+
+   size_t ThreadCount() const { return mNThreads; }
+   size_t MaxAhead() const { return mMaxAhead; }
+
+   /// Whether work should stop early, because Run() was cancelled or
+   /// another piece failed; each Run() begins uncancelled
+   bool Cancelled() const { return mCancelled; }
+
+   /// Claims pieces until claim returns false, and returns false if
+   /// progress did.  Rethrows the first exception from any worker.
+   bool Run(const ClaimFunction &claim, const WorkFunction &work,
+      const TakeFunction &take, const ProgressFunction &progress);
+
+   /// The same, for a known number of pieces
+   bool Run(size_t nPieces, const WorkFunction &work,
+      const TakeFunction &take, const ProgressFunction &progress);
+
+private:
+   const size_t mNThreads;
+   const size_t mMaxAhead;
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::atomic<bool> mCancelled;
+};
+
+#endif
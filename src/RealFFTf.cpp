@@ -48,8 +48,22 @@
 
 #include <wx/thread.h>
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-#include "RealFFTf48x.h"
+// SSE is part of every x86-64 target; AVX is chosen at run time when the
+// compiler lets us build it without raising the baseline of the whole file.
+#if defined(__SSE__) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define REALFFTF_SSE
+#include <xmmintrin.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define REALFFTF_AVX
+#define REALFFTF_AVX_TARGET __attribute__((target("avx")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define REALFFTF_AVX
+#define REALFFTF_AVX_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+#endif
 #endif
 
 #ifndef M_PI
@@ -91,47 +105,59 @@ HFFT InitializeFFT(size_t fftlen)
       h->SinTable[h->BitReversed[i]+1]=(fft_type)-cos(2*M_PI*i/(2*h->Points));
    }
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   // NEW SSE FFT routines work on live data
-   for(size_t i = 0; i < 32; i++)
-      if((1 << i) & fftlen)
-         h->pow2Bits = i;
-#endif
-
    return h;
 }
 
-enum : size_t { MAX_HFFT = 10 };
-
-// Maintain a pool:
-static std::vector< std::unique_ptr<FFTParam> > hFFTArray(MAX_HFFT);
+// Maintain a cache of tables, one per size.  Tables are never modified after
+// initialization, so any number of threads may share one.  When the cache
+// is full, the table of the size least recently asked for, and not now in
+// use, makes room for a new size; if all are in use, the new table is not
+// kept.
+namespace {
+struct CachedFFT {
+   std::unique_ptr<FFTParam> pFFT;
+   size_t users;
+   unsigned long lastUse;
+};
+}
+static const size_t MAX_HFFT = 10;
+static std::vector< CachedFFT > hFFTArray;
+static unsigned long hFFTUseCount = 0;
 wxCriticalSection getFFTMutex;
 
 /* Get a handle to the FFT tables of the desired length */
 /* This version keeps common tables rather than allocating a NEW table every time */
 HFFT GetFFT(size_t fftlen)
 {
-   // To do:  smarter policy about when to retain in the pool and when to
-   // allocate a unique instance.
-
    wxCriticalSectionLocker locker{ getFFTMutex };
-   
-   size_t h = 0;
+
    auto n = fftlen/2;
-   auto size = hFFTArray.size();
-   for(;
-       (h < size) && hFFTArray[h] && (n != hFFTArray[h]->Points);
-       h++)
-      ;
-   if(h < size) {
-      if(hFFTArray[h] == NULL) {
-         hFFTArray[h].reset( InitializeFFT(fftlen).release() );
+   for (auto &entry : hFFTArray)
+      if (entry.pFFT->Points == n) {
+         ++entry.users;
+         entry.lastUse = ++hFFTUseCount;
+         return HFFT{ entry.pFFT.get() };
       }
-      return HFFT{ hFFTArray[h].get() };
-   } else {
-      // All buffers used, so fall back to allocating a NEW set of tables
-      return InitializeFFT(fftlen);
+
+   CachedFFT *pEntry = nullptr;
+   if (hFFTArray.size() < MAX_HFFT) {
+      hFFTArray.push_back({});
+      pEntry = &hFFTArray.back();
+   }
+   else {
+      for (auto &entry : hFFTArray)
+         if (entry.users == 0 &&
+             (!pEntry || entry.lastUse < pEntry->lastUse))
+            pEntry = &entry;
+      if (!pEntry)
+         // All kept tables are in use; the deleter frees this one
+         return InitializeFFT(fftlen);
    }
+
+   pEntry->pFFT.reset( InitializeFFT(fftlen).release() );
+   pEntry->users = 1;
+   pEntry->lastUse = ++hFFTUseCount;
+   return HFFT{ pEntry->pFFT.get() };
 }
 
 /* Release a previously requested handle to the FFT tables */
@@ -140,14 +166,289 @@ void FFTDeleter::operator() (FFTParam *hFFT) const
    wxCriticalSectionLocker locker{ getFFTMutex };
 
    auto it = hFFTArray.begin(), end = hFFTArray.end();
-   while (it != end && it->get() != hFFT)
+   while (it != end && it->pFFT.get() != hFFT)
       ++it;
    if ( it != end )
-      ;
+      --it->users;
    else
       delete hFFT;
 }
 
+namespace {
+
+/*
+*  One pass of the forward or inverse butterflies, over all groups, for a
+*  given number of butterflies per group.  The vector versions handle two
+*  (SSE) or four (AVX) butterflies at once, all sharing the twiddle factor
+*  of their group, and require at least that many butterflies per group.
+*/
+using ButterflyPass =
+   void (*)(fft_type *buffer, const FFTParam *h, size_t ButterfliesPerGroup);
+
+void ForwardPassScalar(
+   fft_type *buffer, const FFTParam *h, size_t ButterfliesPerGroup)
+{
+   fft_type *A,*B;
+   const fft_type *sptr;
+   const fft_type *endptr1,*endptr2;
+   fft_type v1,v2,sin,cos;
+
+   /*
+   *  Butterfly:
+   *     Ain-----Aout
+   *         \ /
+   *         / \
+   *     Bin-----Bout
+   */
+
+   endptr1 = buffer + h->Points * 2;
+   A = buffer;
+   B = buffer + ButterfliesPerGroup * 2;
+   sptr = h->SinTable.get();
+
+   while(A < endptr1)
+   {
+      sin = *sptr;
+      cos = *(sptr+1);
+      endptr2 = B;
+      while(A < endptr2)
+      {
+         v1 = *B * cos + *(B + 1) * sin;
+         v2 = *B * sin - *(B + 1) * cos;
+         *B = (*A + v1);
+         *(A++) = *(B++) - 2 * v1;
+         *B = (*A - v2);
+         *(A++) = *(B++) + 2 * v2;
+      }
+      A = B;
+      B += ButterfliesPerGroup * 2;
+      sptr += 2;
+   }
+}
+
+void InversePassScalar(
+   fft_type *buffer, const FFTParam *h, size_t ButterfliesPerGroup)
+{
+   fft_type *A,*B;
+   const fft_type *sptr;
+   const fft_type *endptr1,*endptr2;
+   fft_type v1,v2,sin,cos;
+
+   endptr1 = buffer + h->Points * 2;
+   A = buffer;
+   B = buffer + ButterfliesPerGroup * 2;
+   sptr = h->SinTable.get();
+
+   while(A < endptr1)
+   {
+      sin = *(sptr++);
+      cos = *(sptr++);
+      endptr2 = B;
+      while(A < endptr2)
+      {
+         v1 = *B * cos - *(B + 1) * sin;
+         v2 = *B * sin + *(B + 1) * cos;
+         *B = (*A + v1) * (fft_type)0.5;
+         *(A++) = *(B++) - v1;
+         *B = (*A + v2) * (fft_type)0.5;
+         *(A++) = *(B++) - v2;
+      }
+      A = B;
+      B += ButterfliesPerGroup * 2;
+   }
+}
+
+#ifdef REALFFTF_SSE
+
+// Each vector holds two complex values, (re, im, re, im).
+// Forward:  with v = (v1, -v2) per butterfly,  A' = A - v,  B' = A + v
+// Inverse:  with v = (v1, v2) per butterfly,  A' = (A - v)/2,  B' = (A + v)/2
+
+void ForwardPassSSE(
+   fft_type *buffer, const FFTParam *h, size_t ButterfliesPerGroup)
+{
+   const auto stride = ButterfliesPerGroup * 2;
+   const fft_type *sptr = h->SinTable.get();
+   for (fft_type *A = buffer, *end = buffer + h->Points * 2;
+        A < end; A += 2 * stride, sptr += 2) {
+      const fft_type sin = sptr[0], cos = sptr[1];
+      // Multipliers of the duplicated real and imaginary parts of B
+      const __m128 reMul = _mm_setr_ps(cos, -sin, cos, -sin);
+      const __m128 imMul = _mm_setr_ps(sin, cos, sin, cos);
+      fft_type *B = A + stride;
+      for (size_t ii = 0; ii < stride; ii += 4) {
+         const __m128 a = _mm_loadu_ps(A + ii);
+         const __m128 b = _mm_loadu_ps(B + ii);
+         const __m128 re = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0));
+         const __m128 im = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1));
+         const __m128 v =
+            _mm_add_ps(_mm_mul_ps(re, reMul), _mm_mul_ps(im, imMul));
+         _mm_storeu_ps(A + ii, _mm_sub_ps(a, v));
+         _mm_storeu_ps(B + ii, _mm_add_ps(a, v));
+      }
+   }
+}
+
+void InversePassSSE(
+   fft_type *buffer, const FFTParam *h, size_t ButterfliesPerGroup)
+{
+   const auto stride = ButterfliesPerGroup * 2;
+   const __m128 half = _mm_set1_ps(0.5f);
+   const fft_type *sptr = h->SinTable.get();
+   for (fft_type *A = buffer, *end = buffer + h->Points * 2;
+        A < end; A += 2 * stride, sptr += 2) {
+      const fft_type sin = sptr[0], cos = sptr[1];
+      const __m128 reMul = _mm_setr_ps(cos, sin, cos, sin);
+      const __m128 imMul = _mm_setr_ps(-sin, cos, -sin, cos);
+      fft_type *B = A + stride;
+      for (size_t ii = 0; ii < stride; ii += 4) {
+         const __m128 a = _mm_loadu_ps(A + ii);
+         const __m128 b = _mm_loadu_ps(B + ii);
+         const __m128 re = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0));
+         const __m128 im = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1));
+         const __m128 v =
+            _mm_add_ps(_mm_mul_ps(re, reMul), _mm_mul_ps(im, imMul));
+         _mm_storeu_ps(A + ii, _mm_mul_ps(_mm_sub_ps(a, v), half));
+         _mm_storeu_ps(B + ii, _mm_mul_ps(_mm_add_ps(a, v), half));
+      }
+   }
+}
+
+#endif
+
+#ifdef REALFFTF_AVX
+
+REALFFTF_AVX_TARGET
+void ForwardPassAVX(
+   fft_type *buffer, const FFTParam *h, size_t ButterfliesPerGroup)
+{
+   const auto stride = ButterfliesPerGroup * 2;
+   const fft_type *sptr = h->SinTable.get();
+   for (fft_type *A = buffer, *end = buffer + h->Points * 2;
+        A < end; A += 2 * stride, sptr += 2) {
+      const fft_type sin = sptr[0], cos = sptr[1];
+      const __m256 reMul =
+         _mm256_setr_ps(cos, -sin, cos, -sin, cos, -sin, cos, -sin);
+      const __m256 imMul =
+         _mm256_setr_ps(sin, cos, sin, cos, sin, cos, sin, cos);
+      fft_type *B = A + stride;
+      for (size_t ii = 0; ii < stride; ii += 8) {
+         const __m256 a = _mm256_loadu_ps(A + ii);
+         const __m256 b = _mm256_loadu_ps(B + ii);
+         const __m256 re = _mm256_moveldup_ps(b);
+         const __m256 im = _mm256_movehdup_ps(b);
+         const __m256 v = _mm256_add_ps(
+            _mm256_mul_ps(re, reMul), _mm256_mul_ps(im, imMul));
+         _mm256_storeu_ps(A + ii, _mm256_sub_ps(a, v));
+         _mm256_storeu_ps(B + ii, _mm256_add_ps(a, v));
+      }
+   }
+}
+
+REALFFTF_AVX_TARGET
+void InversePassAVX(
+   fft_type *buffer, const FFTParam *h, size_t ButterfliesPerGroup)
+{
+   const auto stride = ButterfliesPerGroup * 2;
+   const __m256 half = _mm256_set1_ps(0.5f);
+   const fft_type *sptr = h->SinTable.get();
+   for (fft_type *A = buffer, *end = buffer + h->Points * 2;
+        A < end; A += 2 * stride, sptr += 2) {
+      const fft_type sin = sptr[0], cos = sptr[1];
+      const __m256 reMul =
+         _mm256_setr_ps(cos, sin, cos, sin, cos, sin, cos, sin);
+      const __m256 imMul =
+         _mm256_setr_ps(-sin, cos, -sin, cos, -sin, cos, -sin, cos);
+      fft_type *B = A + stride;
+      for (size_t ii = 0; ii < stride; ii += 8) {
+         const __m256 a = _mm256_loadu_ps(A + ii);
+         const __m256 b = _mm256_loadu_ps(B + ii);
+         const __m256 re = _mm256_moveldup_ps(b);
+         const __m256 im = _mm256_movehdup_ps(b);
+         const __m256 v = _mm256_add_ps(
+            _mm256_mul_ps(re, reMul), _mm256_mul_ps(im, imMul));
+         _mm256_storeu_ps(A + ii, _mm256_mul_ps(_mm256_sub_ps(a, v), half));
+         _mm256_storeu_ps(B + ii, _mm256_mul_ps(_mm256_add_ps(a, v), half));
+      }
+   }
+}
+
+bool CPUHasAVX()
+{
+#if defined(__GNUC__)
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx");
+#else
+   int info[4];
+   __cpuid(info, 1);
+   // Require the AVX and OSXSAVE bits, then ask whether the operating system
+   // preserves the YMM registers
+   const int mask = (1 << 28) | (1 << 27);
+   return (info[2] & mask) == mask && (_xgetbv(0) & 6) == 6;
+#endif
+}
+
+#endif
+
+// The passes used for each width of butterfly group, chosen once for
+// the CPU we run on
+struct ButterflyKernels
+{
+   ButterflyKernels()
+   {
+#ifdef REALFFTF_SSE
+      forward2 = ForwardPassSSE;
+      inverse2 = InversePassSSE;
+      name = "SSE";
+#endif
+#ifdef REALFFTF_AVX
+      if (CPUHasAVX()) {
+         forward4 = ForwardPassAVX;
+         inverse4 = InversePassAVX;
+         name = "AVX";
+      }
+      else
+#endif
+      {
+         forward4 = forward2;
+         inverse4 = inverse2;
+      }
+   }
+
+   ButterflyPass Forward(size_t ButterfliesPerGroup) const
+   {
+      return ButterfliesPerGroup >= 4 ? forward4
+         : ButterfliesPerGroup >= 2 ? forward2
+         : ForwardPassScalar;
+   }
+
+   ButterflyPass Inverse(size_t ButterfliesPerGroup) const
+   {
+      return ButterfliesPerGroup >= 4 ? inverse4
+         : ButterfliesPerGroup >= 2 ? inverse2
+         : InversePassScalar;
+   }
+
+   ButterflyPass forward2{ ForwardPassScalar };
+   ButterflyPass inverse2{ InversePassScalar };
+   ButterflyPass forward4{ ForwardPassScalar };
+   ButterflyPass inverse4{ InversePassScalar };
+   const char *name{ "scalar" };
+};
+
+const ButterflyKernels &Kernels()
+{
+   static const ButterflyKernels kernels;
+   return kernels;
+}
+
+}
+
+const char *RealFFTfImplementation()
+{
+   return Kernels().name;
+}
+
 /*
 *  Forward FFT routine.  Must call GetFFT(fftlen) first!
 *
@@ -169,50 +470,15 @@ void FFTDeleter::operator() (FFTParam *hFFT) const
 void RealFFTf(fft_type *buffer, const FFTParam *h)
 {
    fft_type *A,*B;
-   const fft_type *sptr;
-   const fft_type *endptr1,*endptr2;
    const int *br1,*br2;
    fft_type HRplus,HRminus,HIplus,HIminus;
    fft_type v1,v2,sin,cos;
 
-   auto ButterfliesPerGroup = h->Points/2;
-
-   /*
-   *  Butterfly:
-   *     Ain-----Aout
-   *         \ /
-   *         / \
-   *     Bin-----Bout
-   */
-
-   endptr1 = buffer + h->Points * 2;
-
-   while(ButterfliesPerGroup > 0)
-   {
-      A = buffer;
-      B = buffer + ButterfliesPerGroup * 2;
-      sptr = h->SinTable.get();
+   const auto &kernels = Kernels();
+   for (auto ButterfliesPerGroup = h->Points/2;
+        ButterfliesPerGroup > 0; ButterfliesPerGroup >>= 1)
+      kernels.Forward(ButterfliesPerGroup)(buffer, h, ButterfliesPerGroup);
 
-      while(A < endptr1)
-      {
-         sin = *sptr;
-         cos = *(sptr+1);
-         endptr2 = B;
-         while(A < endptr2)
-         {
-            v1 = *B * cos + *(B + 1) * sin;
-            v2 = *B * sin - *(B + 1) * cos;
-            *B = (*A + v1);
-            *(A++) = *(B++) - 2 * v1;
-            *B = (*A - v2);
-            *(A++) = *(B++) + 2 * v2;
-         }
-         A = B;
-         B += ButterfliesPerGroup * 2;
-         sptr += 2;
-      }
-      ButterfliesPerGroup >>= 1;
-   }
    /* Massage output to get the output for a real input sequence. */
    br1 = h->BitReversed.get() + 1;
    br2 = h->BitReversed.get() + h->Points - 1;
@@ -271,14 +537,10 @@ void RealFFTf(fft_type *buffer, const FFTParam *h)
 void InverseRealFFTf(fft_type *buffer, const FFTParam *h)
 {
    fft_type *A,*B;
-   const fft_type *sptr;
-   const fft_type *endptr1,*endptr2;
    const int *br1;
    fft_type HRplus,HRminus,HIplus,HIminus;
    fft_type v1,v2,sin,cos;
 
-   auto ButterfliesPerGroup = h->Points / 2;
-
    /* Massage input to get the input for a real output sequence. */
    A = buffer + 2;
    B = buffer + h->Points * 2 - 2;
@@ -314,41 +576,10 @@ void InverseRealFFTf(fft_type *buffer, const FFTParam *h)
    buffer[0]=v1;
    buffer[1]=v2;
 
-   /*
-   *  Butterfly:
-   *     Ain-----Aout
-   *         \ /
-   *         / \
-   *     Bin-----Bout
-   */
-
-   endptr1 = buffer + h->Points * 2;
-
-   while(ButterfliesPerGroup > 0)
-   {
-      A = buffer;
-      B = buffer + ButterfliesPerGroup * 2;
-      sptr = h->SinTable.get();
-
-      while(A < endptr1)
-      {
-         sin = *(sptr++);
-         cos = *(sptr++);
-         endptr2 = B;
-         while(A < endptr2)
-         {
-            v1 = *B * cos - *(B + 1) * sin;
-            v2 = *B * sin + *(B + 1) * cos;
-            *B = (*A + v1) * (fft_type)0.5;
-            *(A++) = *(B++) - v1;
-            *B = (*A + v2) * (fft_type)0.5;
-            *(A++) = *(B++) - v2;
-         }
-         A = B;
-         B += ButterfliesPerGroup * 2;
-      }
-      ButterfliesPerGroup >>= 1;
-   }
+   const auto &kernels = Kernels();
+   for (auto ButterfliesPerGroup = h->Points/2;
+        ButterfliesPerGroup > 0; ButterfliesPerGroup >>= 1)
+      kernels.Inverse(ButterfliesPerGroup)(buffer, h, ButterfliesPerGroup);
 }
 
 void ReorderToFreq(const FFTParam *hFFT, const fft_type *buffer,
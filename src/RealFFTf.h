@@ -12,9 +12,6 @@ struct FFTParam {
    ArrayOf<int> BitReversed;
    ArrayOf<fft_type> SinTable;
    size_t Points;
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   int pow2Bits;
-#endif
 };
 
 struct FFTDeleter{
@@ -28,6 +25,8 @@ using HFFT = std::unique_ptr<
 HFFT GetFFT(size_t);
 void RealFFTf(fft_type *, const FFTParam *);
 void InverseRealFFTf(fft_type *, const FFTParam *);
+/* Name of the butterfly implementation chosen for this CPU */
+const char *RealFFTfImplementation();
 void ReorderToTime(const FFTParam *hFFT, const fft_type *buffer, fft_type *TimeOut);
 void ReorderToFreq(const FFTParam *hFFT, const fft_type *buffer,
 		   fft_type *RealOut, fft_type *ImagOut);
@@ -0,0 +1,244 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RenderBenchmark.cpp
+
+*******************************************************************//**
+
+\file RenderBenchmark.cpp
+\brief Measures the drawing of wave tracks without a TrackPanel.
+
+  Synthetic tracks, with a chosen number of clips and envelope points
+and a mix of waveform and spectrogram views, are drawn into a
+wxMemoryDC exactly as TrackPanel would draw them, while the view
+scrolls and zooms.  Nothing is shown on screen, so this can run in
+continuous integration, given only a virtual X server on Linux:
+
+   xvfb-run audacity --render-benchmark
+
+*//*******************************************************************/
+
+#include "Audacity.h"
+#include "RenderBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <math.h>
+#include <vector>
+
+#include <wx/bitmap.h>
+#include <wx/dcmemory.h>
+#include <wx/string.h>
+
+#include "DirManager.h"
+#include "SampleFormat.h"
+#include "SelectedRegion.h"
+#include "TrackArtist.h"
+#include "TrackPanelDrawingContext.h"
+#include "Envelope.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+#include "ViewInfo.h"
+#include "tracks/playabletrack/wavetrack/ui/WaveTrackView.h"
+#include "tracks/playabletrack/wavetrack/ui/WaveTrackViewConstants.h"
+
+namespace {
+
+struct Scenario
+{
+   const char *name;
+   size_t nTracks;
+   size_t nClips;             // per track
+   size_t nEnvelopePoints;    // per clip
+   size_t nSpectrumTracks;    // the first ones show spectrograms
+   double seconds;            // length of each track
+};
+
+const Scenario Scenarios[] = {
+   { "waveform",          8,  1,  0, 0, 120.0 },
+   { "clips+envelopes",   8, 24, 16, 0, 120.0 },
+   { "spectrogram",       4,  1,  0, 4,  30.0 },
+   { "mixed",             8,  6,  4, 4,  60.0 },
+};
+
+// Samples per pixel at which to draw each scenario
+const double Zooms[] = { 8.0, 128.0, 2048.0 };
+
+const double Rate = 44100.0;
+const int Width = 1600;
+const int TrackHeight = 150;
+const size_t ScrollSteps = 8;
+
+std::shared_ptr<WaveTrack> MakeTrack(
+   TrackFactory &factory, const Scenario &scenario, size_t iTrack )
+{
+   auto track = factory.NewWaveTrack(int16Sample, Rate);
+
+   // Each clip fills most of its share of the track, leaving a gap
+   const double span = scenario.seconds / scenario.nClips;
+   const auto clipLen = size_t(0.9 * span * Rate);
+
+   // A chirp under a slow tremolo, with some noise
+   const size_t chunk = 65536;
+   Floats buffer{ chunk };
+   unsigned noise = 12345u + iTrack;
+   double phase = 0;
+   for (size_t ii = 0; ii < scenario.nClips; ++ii) {
+      const double offset = ii * span;
+      auto clip = track->CreateClip();
+      clip->SetOffset(offset);
+
+      for (size_t done = 0; done < clipLen;) {
+         const auto len = std::min(chunk, clipLen - done);
+         for (size_t jj = 0; jj < len; ++jj) {
+            const double t = offset + (done + jj) / Rate;
+            phase += 2 * M_PI * (100.0 + 50.0 * t * (iTrack + 1)) / Rate;
+            noise = noise * 1664525u + 1013904223u;
+            buffer[jj] = 0.5 * sin(phase) * (0.6 + 0.4 * sin(t))
+               + 0.05 * ((noise >> 8) / double(1 << 24) - 0.5);
+         }
+         clip->Append((samplePtr)buffer.get(), floatSample, len);
+         done += len;
+      }
+      clip->Flush();
+
+      auto envelope = clip->GetEnvelope();
+      for (size_t jj = 0; jj < scenario.nEnvelopePoints; ++jj)
+         envelope->InsertOrReplace(
+            offset + (jj + 0.5) * 0.9 * span / scenario.nEnvelopePoints,
+            (jj % 2) ? 1.0 : 0.5);
+   }
+
+   WaveTrackView::Get(*track).SetDisplay(
+      iTrack < scenario.nSpectrumTracks
+         ? WaveTrackViewConstants::Spectrum
+         : WaveTrackViewConstants::Waveform);
+
+   return track;
+}
+
+// Accumulates times and cache use over the frames of one phase
+struct Measurement
+{
+   size_t frames{ 0 };
+   double waveformSeconds{ 0 };
+   double spectrumSeconds{ 0 };
+   WaveClipCacheStatistics statistics;
+};
+
+wxString FormatMeasurement( const Scenario &scenario, double zoom,
+   const char *phase, const Measurement &measurement )
+{
+   const auto &statistics = measurement.statistics;
+   const auto perFrame = [&]( double seconds ){
+      return 1000.0 * seconds / std::max<size_t>(1, measurement.frames);
+   };
+   const auto percent = [&]( size_t part, size_t whole ){
+      return whole ? 100.0 * part / whole : 0.0;
+   };
+   return wxString::Format(
+      "%-16s %6.0f %-12s %6lu %10.3f %10.3f %8.1f%% %8.1f%%\n",
+      scenario.name, zoom, phase,
+      (unsigned long)measurement.frames,
+      perFrame(measurement.waveformSeconds),
+      perFrame(measurement.spectrumSeconds),
+      percent(statistics.waveColumnsReused, statistics.waveColumns),
+      percent(statistics.specColumnsReused, statistics.specColumns));
+}
+
+}
+
+wxString RunRenderBenchmark( const ProjectSettings &settings )
+{
+   using Clock = std::chrono::steady_clock;
+
+   wxString result;
+   result += wxString::Format(
+      "%-16s %6s %-12s %6s %10s %10s %9s %9s\n",
+      "scenario", "spp", "phase", "frames",
+      "wave ms", "spec ms", "wave hit", "spec hit");
+
+   for (const auto &scenario : Scenarios) {
+      ZoomInfo zoomInfo(0.0, ZoomInfo::GetDefaultZoom());
+      zoomInfo.SetWidth(Width);
+      SelectedRegion selectedRegion;
+      auto dd = DirManager::Create();
+      TrackFactory factory{ settings, dd, &zoomInfo };
+
+      std::vector< std::shared_ptr<WaveTrack> > tracks;
+      for (size_t ii = 0; ii < scenario.nTracks; ++ii)
+         tracks.push_back(MakeTrack(factory, scenario, ii));
+
+      wxBitmap bitmap(Width, TrackHeight * scenario.nTracks);
+      wxMemoryDC dc;
+      dc.SelectObject(bitmap);
+
+      TrackArtist artist{ nullptr };
+      artist.pZoomInfo = &zoomInfo;
+      artist.pSelectedRegion = &selectedRegion;
+      artist.drawEnvelope = scenario.nEnvelopePoints > 0;
+      TrackPanelDrawingContext context{ dc, {}, {}, &artist };
+
+      // Draw all tracks once, as TrackPanel would after a full refresh
+      const auto drawFrame = [&]( Measurement &measurement ){
+         for (size_t ii = 0; ii < tracks.size(); ++ii) {
+            const wxRect rect{ 0, int(ii) * TrackHeight, Width, TrackHeight };
+            const auto displays = WaveTrackView::Get(*tracks[ii]).GetDisplays();
+            for (const auto &pSubView :
+                 WaveTrackView::Get(*tracks[ii]).GetAllSubViews()) {
+               const auto display = pSubView->SubViewType().id;
+               if (displays.empty() || displays[0].id != display)
+                  continue;
+               const auto start = Clock::now();
+               for (unsigned iPass = 0; iPass < TrackArtist::NPasses; ++iPass)
+                  pSubView->Draw(context, rect, iPass);
+               const std::chrono::duration<double> elapsed =
+                  Clock::now() - start;
+               if (display == WaveTrackViewConstants::Spectrum)
+                  measurement.spectrumSeconds += elapsed.count();
+               else
+                  measurement.waveformSeconds += elapsed.count();
+            }
+         }
+         ++measurement.frames;
+      };
+
+      // Run some frames, and report them together
+      const auto phase = [&]( double zoom, const char *name,
+         size_t nFrames, const std::function<void(size_t)> &before ){
+         Measurement measurement;
+         WaveClip::ResetCacheStatistics();
+         for (size_t ii = 0; ii < nFrames; ++ii) {
+            before(ii);
+            drawFrame(measurement);
+         }
+         measurement.statistics = WaveClip::GetCacheStatistics();
+         result += FormatMeasurement(scenario, zoom, name, measurement);
+      };
+
+      for (const auto zoom : Zooms) {
+         const double pixelsPerSecond = Rate / zoom;
+         const double quarterScreen = Width / (4 * pixelsPerSecond);
+         const double start =
+            std::max(0.0, scenario.seconds / 2 - 2 * quarterScreen);
+
+         zoomInfo.SetZoom(pixelsPerSecond);
+         zoomInfo.h = start;
+         phase(zoom, "first", 1, []( size_t ){});
+         phase(zoom, "redraw", 4, []( size_t ){});
+         phase(zoom, "scroll", ScrollSteps, [&]( size_t ){
+            zoomInfo.h += quarterScreen; });
+         phase(zoom, "scroll back", ScrollSteps, [&]( size_t ){
+            zoomInfo.h -= quarterScreen; });
+         phase(zoom, "zoom out", 1, [&]( size_t ){
+            zoomInfo.SetZoom(pixelsPerSecond / 2); });
+      }
+
+      dc.SelectObject(wxNullBitmap);
+   }
+
+   WaveClip::ResetCacheStatistics();
+   return result;
+}
@@ -0,0 +1,20 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RenderBenchmark.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_RENDER_BENCHMARK__
+#define __AUDACITY_RENDER_BENCHMARK__
+
+class ProjectSettings;
+class wxString;
+
+// Draws synthetic tracks offscreen at several zooms and scroll positions,
+// and returns a plain text report of the drawing times of each kind of
+// view and of the wave and spectrogram cache reuse
+wxString RunRenderBenchmark( const ProjectSettings &settings );
+
+#endif // define __AUDACITY_RENDER_BENCHMARK__
@@ -25,8 +25,13 @@
 #include "Resample.h"
 #include "Prefs.h"
 #include "Internat.h"
+#include "OrderedParallelJobs.h"
 #include "../include/audacity/ComponentInterface.h"
 
+#include <limits>
+#include <math.h>
+#include <vector>
+
 #include <soxr.h>
 
 Resample::Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor)
@@ -118,3 +123,161 @@ void Resample::SetMethod(const bool useBestMethod)
    else
       mMethod = FastMethodSetting.ReadEnum();
 }
+
+void Resample::Reset()
+{
+   soxr_clear(mHandle.get());
+}
+
+namespace {
+
+// Input given to the resampler at a time
+const size_t InputBlockLen = 65536;
+// About this much input is resampled in a segment
+const size_t IdealSegmentLen = 1 << 20;
+// libsoxr resamples with the phases of an exact ratio only when neither
+// side of the ratio is more than this
+const size_t MaxPeriod = 2048;
+
+// Returns the least count of input samples that gives a whole count of
+// output samples at the factor, or zero if there is none small enough
+size_t FindPeriod(double factor)
+{
+   for (size_t period = 1; period <= MaxPeriod; ++period) {
+      const auto output = floor(period * factor + 0.5);
+      if (fabs(period * factor - output) < 1e-9)
+         return output <= MaxPeriod ? period : 0;
+   }
+   return 0;
+}
+
+// Resamples input from start to end, and gives the output after the
+// first skip samples, but no more than keep, to putOutput; returns false
+// if more output was wanted but onBlock returned false after a block of
+// input
+bool ResampleRange(Resample &resample, double factor,
+   sampleCount start, sampleCount end, sampleCount skip, sampleCount keep,
+   const Resample::InputFunction &getInput,
+   const Resample::OutputFunction &putOutput,
+   const std::function< bool(sampleCount) > &onBlock)
+{
+   Floats inBuffer{ InputBlockLen };
+   // factor is at most 100-fold so this shouldn't overflow size_t
+   const auto outBufferLen = size_t( factor * InputBlockLen + 10 );
+   Floats outBuffer{ outBufferLen };
+
+   // Keep going as long as there is something to feed the resampler with,
+   // or the resampler still gives output
+   auto pos = start;
+   size_t outGenerated = 0;
+   while (keep > 0 && (pos < end || outGenerated > 0)) {
+      const auto inLen = limitSampleBufferSize( InputBlockLen, end - pos );
+      const bool isLast = (pos + inLen == end);
+      getInput(inBuffer.get(), pos, inLen);
+
+      const auto results = resample.Process(factor, inBuffer.get(), inLen,
+         isLast, outBuffer.get(), outBufferLen);
+      pos += results.first;
+      outGenerated = results.second;
+
+      const auto skipped = limitSampleBufferSize( outGenerated, skip );
+      skip -= skipped;
+      const auto kept =
+         limitSampleBufferSize( outGenerated - skipped, keep );
+      keep -= kept;
+      if (kept > 0)
+         putOutput(outBuffer.get() + skipped, kept);
+
+      if (keep > 0 && !onBlock(pos))
+         return false;
+   }
+   return true;
+}
+
+}
+
+bool Resample::ProcessConstantRate(double factor, sampleCount len,
+   const InputFunction &getInput, const OutputFunction &putOutput,
+   const ProgressFunction &progress)
+{
+   // The low quality method interpolates with phases that do not repeat
+   // exactly, so it has only one pass
+   const auto period =
+      BestMethodSetting.ReadEnum() == 0 ? 0 : FindPeriod(factor);
+
+   // Enough input before and after each segment, for the filters of any
+   // method, rounded up to the period
+   const size_t margin = period == 0 ? 0 :
+      size_t(ceil(std::max(16384.0, 16384.0 / factor) / period)) * period;
+   const auto segmentLen = std::max<size_t>(IdealSegmentLen, 8 * margin)
+      / std::max<size_t>(1, period) * period;
+
+   // Output of the whole stream starts a segment's output; a large number
+   // stands for all that there is
+   const auto OutputPosition = [&](sampleCount pos) {
+      return sampleCount{ llrint(pos.as_double() * factor) };
+   };
+   const sampleCount all = std::numeric_limits<long long>::max();
+
+   if (period == 0 || len <= sampleCount{ segmentLen }) {
+      // One pass
+      Resample resample(true, factor, factor);
+      return ResampleRange(resample, factor, 0, len, 0, all,
+         getInput, putOutput, progress);
+   }
+
+   struct Segment {
+      sampleCount start;
+      sampleCount end;
+      std::vector<float> output;
+   };
+   std::vector<Segment> segments;
+   for (sampleCount start = 0; start < len; start += segmentLen)
+      segments.push_back({ start,
+         start + limitSampleBufferSize( segmentLen, len - start ), {} });
+
+   OrderedParallelJobs parallelJobs{
+      OrderedParallelJobs::DefaultThreadCount(segments.size()) };
+
+   // Constructing a resampler reads preferences, which should be done only
+   // on this thread
+   std::vector< std::unique_ptr<Resample> > resamplers;
+   for (size_t ii = 0; ii < parallelJobs.ThreadCount(); ++ii)
+      resamplers.push_back(std::make_unique<Resample>(true, factor, factor));
+
+   const auto work = [&](size_t thread, size_t ii) {
+      auto &resample = *resamplers[thread];
+      auto &segment = segments[ii];
+
+      // Start and end the input where the output is at whole samples
+      const bool last = (ii + 1 == segments.size());
+      const auto from = segment.start -
+         std::min(segment.start, sampleCount{ margin });
+      const auto to = last ? len : std::min(len, segment.end + margin);
+      const auto skip =
+         OutputPosition(segment.start) - OutputPosition(from);
+      const auto keep = last ? all :
+         OutputPosition(segment.end) - OutputPosition(segment.start);
+
+      resample.Reset();
+      segment.output.reserve(
+         size_t((segment.end - segment.start).as_double() * factor) + 1);
+      const auto append = [&](const float *buffer, size_t len) {
+         segment.output.insert(segment.output.end(), buffer, buffer + len);
+      };
+      ResampleRange(resample, factor, from, to, skip, keep, getInput, append,
+         [&](sampleCount) { return !parallelJobs.Cancelled(); });
+   };
+
+   // Only this thread gives output, taking segments in order
+   return parallelJobs.Run( segments.size(), work,
+      [&](size_t ii) {
+         auto &output = segments[ii].output;
+         putOutput(output.data(), output.size());
+         std::vector<float>{}.swap(output);
+      },
+      [&](size_t nTaken) {
+         return progress(
+            nTaken < segments.size() ? segments[nTaken].start : len);
+      } );
+}
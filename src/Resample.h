@@ -16,6 +16,8 @@
 
 #include "SampleFormat.h"
 
+#include <functional>
+
 template< typename Enum > class EnumSetting;
 
 struct soxr;
@@ -74,6 +76,39 @@ class Resample final
                         float  *outBuffer,
                         size_t  outBufferLen);
 
+   /// Forgets all input, as if just constructed
+   void Reset();
+
+   using InputFunction =
+      std::function< void(float *buffer, sampleCount start, size_t len) >;
+   using OutputFunction =
+      std::function< void(const float *buffer, size_t len) >;
+   using ProgressFunction = std::function< bool(sampleCount inputDone) >;
+
+   /** @brief Resamples a whole stream at a constant factor, with the best
+    * method.
+    *
+    * When the factor is a ratio of small enough integers, the input is cut
+    * into segments that start where the output starts at a whole sample,
+    * and worker threads resample the segments at once.  Each also
+    * resamples some input before and after it, so that the output is just
+    * as from one pass.  Otherwise there is one pass on this thread.
+    *
+    * The output includes all that the resampler gives after the last
+    * input, so that there are len times factor samples, rounded to the
+    * nearest.
+    @param getInput Gives len samples of input from start; it may be called
+    on several threads at once
+    @param putOutput Takes the next output; called on this thread, in order
+    @param progress Called on this thread with the count of input samples
+    done; it may return false to stop
+    @return false if progress stopped it
+   */
+   static bool ProcessConstantRate(double factor, sampleCount len,
+                        const InputFunction &getInput,
+                        const OutputFunction &putOutput,
+                        const ProgressFunction &progress);
+
  protected:
    void SetMethod(const bool useBestMethod);
 
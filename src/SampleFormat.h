@@ -14,6 +14,9 @@
 #include "Audacity.h"
 
 #include "MemoryX.h"
+#include <functional>
+#include <utility>
+#include <vector>
 #include <wx/defs.h>
 
 #include "audacity/Types.h"
@@ -155,4 +158,15 @@ using Floats = ArrayOf<float>;
 using FloatBuffers = ArraysOf<float>;
 using Doubles = ArrayOf<double>;
 
+// Runs of samples, as pairs of start and end positions
+using SampleRuns = std::vector< std::pair< sampleCount, sampleCount > >;
+
+// Filters applied to samples before their loudness is measured.  A weighting
+// filters len samples in place, continuing from the samples it was last
+// given; a factory makes one at rest, for samples of the given rate.  The
+// factory is a plain function, so that measurements kept for one can be
+// told from those of another.
+using LoudnessWeighting = std::function< void(float *buffer, size_t len) >;
+using LoudnessWeightingFactory = LoudnessWeighting (*)(double rate);
+
 #endif
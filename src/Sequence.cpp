@@ -383,6 +383,201 @@ float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
    return sqrt(sumsq / length.as_double() );
 }
 
+double Sequence::GetSum(sampleCount start, sampleCount len, bool mayThrow) const
+{
+   if (len == 0 || mBlock.size() == 0)
+      return 0.0;
+
+   double sum = 0.0;
+   sampleCount length = 0;
+
+   unsigned int block0 = FindBlock(start);
+   unsigned int block1 = FindBlock(start + len - 1);
+
+   // Whole blocks in the middle of this region use their remembered sums,
+   // read from disk only the first time they are needed
+   for (unsigned b = block0 + 1; b < block1; b++) {
+      const SeqBlock &theBlock = mBlock[b];
+      const auto &theFile = theBlock.f;
+      sum += theFile->GetSum(mayThrow);
+      length += theFile->GetLength();
+   }
+
+   // The first and last blocks may overlap the region only partly
+   {
+      const SeqBlock &theBlock = mBlock[block0];
+      const auto &theFile = theBlock.f;
+      auto s0 = ( start - theBlock.start ).as_size_t();
+      const auto maxl0 =
+         (theBlock.start + theFile->GetLength() - start).as_size_t();
+      wxASSERT(maxl0 <= mMaxSamples);
+      const auto l0 = limitSampleBufferSize( maxl0, len );
+
+      sum += (s0 == 0 && l0 == theFile->GetLength())
+         ? theFile->GetSum(mayThrow)
+         : theFile->GetSum(s0, l0, mayThrow);
+      length += l0;
+   }
+
+   if (block1 > block0) {
+      const SeqBlock &theBlock = mBlock[block1];
+      const auto &theFile = theBlock.f;
+
+      const auto l0 = ( start + len - theBlock.start ).as_size_t();
+      wxASSERT(l0 <= mMaxSamples);
+
+      sum += (l0 == theFile->GetLength())
+         ? theFile->GetSum(mayThrow)
+         : theFile->GetSum(0, l0, mayThrow);
+      length += l0;
+   }
+
+   wxASSERT(length == len);
+
+   return sum;
+}
+
+namespace {
+
+// Returns the first index from ii, before len, where a sample is quiet
+// (below level) if quiet is false, or not quiet if it is true; or len
+size_t FindLevelChange(const float *buffer, size_t ii, size_t len,
+   double level, bool quiet)
+{
+   // Test whole groups without branching, which the compiler can vectorize
+   const size_t Group = 16;
+   const unsigned same = quiet ? Group : 0;
+   for (; ii + Group <= len; ii += Group) {
+      unsigned count = 0;
+      for (size_t jj = 0; jj < Group; ++jj)
+         count += (fabs(buffer[ii + jj]) < level);
+      if (count != same)
+         break;
+   }
+   while (ii < len && (fabs(buffer[ii]) < level) == quiet)
+      ++ii;
+   return ii;
+}
+
+}
+
+void Sequence::FindQuietRuns(sampleCount start, sampleCount len, double level,
+   sampleCount minLength, SampleRuns &runs, bool mayThrow) const
+{
+   if (len == 0 || mBlock.size() == 0)
+      return;
+
+   const auto end = start + len;
+   bool open = false;
+   sampleCount runStart = 0;
+   const auto quiet = [&](sampleCount where) {
+      if (!open)
+         open = true, runStart = where;
+   };
+   const auto loud = [&](sampleCount where) {
+      if (open) {
+         if (where - runStart >= minLength || runStart == start)
+            runs.push_back({ runStart, where });
+         open = false;
+      }
+   };
+
+   // A frame of the 256 sample summary that is not quiet has at least one
+   // loud sample.  So a run at least this long contains some quiet frame,
+   // and reaches no further than the frames next to it.  Samples of a frame
+   // with loud frames on both sides then need not be read.
+   const bool skipLoud = minLength >= 2 * 256 - 1;
+
+   enum Kind : char { Quiet, Loud, Unknown };
+   std::vector<Kind> kinds;
+   Floats summary, buffer;
+   size_t summaryLen = 0, bufferLen = 0;
+
+   unsigned int block0 = FindBlock(start);
+   unsigned int block1 = FindBlock(end - 1);
+   for (auto b = block0; b <= block1; ++b) {
+      const SeqBlock &theBlock = mBlock[b];
+      const auto &theFile = theBlock.f;
+      const auto blockLen = theFile->GetLength();
+      // The part of the block in the region
+      const auto s0 = (std::max(start, theBlock.start) - theBlock.start)
+         .as_size_t();
+      const auto s1 = (std::min(end, theBlock.start + blockLen) - theBlock.start)
+         .as_size_t();
+
+      const bool summarized = theFile->IsSummaryAvailable();
+      if (summarized) {
+         auto results = theFile->GetMinMaxRMS(mayThrow);
+         if (std::max(-results.min, results.max) < level) {
+            quiet(theBlock.start + s0);
+            continue;
+         }
+      }
+
+      // Classify the frames of the summary that overlap the region
+      const auto frame0 = s0 / 256;
+      const auto nFrames = (s1 + 255) / 256 - frame0;
+      kinds.assign(nFrames, Unknown);
+      if (summarized) {
+         if (summaryLen < 3 * nFrames)
+            summary.reinit(summaryLen = 3 * nFrames);
+         if (theFile->Read256(summary.get(), frame0, nFrames)) {
+            for (size_t ii = 0; ii < nFrames; ++ii) {
+               const auto f0 = (frame0 + ii) * 256;
+               const auto f1 = std::min(f0 + 256, blockLen);
+               if (std::max(-summary[3 * ii], summary[3 * ii + 1]) < level)
+                  kinds[ii] = Quiet;
+               else if (f0 >= s0 && f1 <= s1)
+                  kinds[ii] = Loud;
+            }
+         }
+      }
+
+      // Read samples of the frames that need it, several frames at a time
+      // where they are consecutive
+      const auto needed = [&](size_t ii) {
+         return kinds[ii] == Unknown || (kinds[ii] == Loud && !(skipLoud &&
+            ii > 0 && kinds[ii - 1] == Loud &&
+            ii + 1 < nFrames && kinds[ii + 1] == Loud));
+      };
+      for (size_t ii = 0; ii < nFrames;) {
+         const auto f0 = std::max(s0, (frame0 + ii) * 256);
+         if (kinds[ii] == Quiet) {
+            quiet(theBlock.start + f0);
+            ++ii;
+         }
+         else if (!needed(ii)) {
+            // Any run here is too short to report
+            open = false;
+            ++ii;
+         }
+         else {
+            auto jj = ii + 1;
+            while (jj < nFrames && needed(jj))
+               ++jj;
+            const auto f1 = std::min(s1, (frame0 + jj) * 256);
+            if (bufferLen < f1 - f0)
+               buffer.reinit(bufferLen = f1 - f0);
+            Read((samplePtr)buffer.get(), floatSample, theBlock, f0, f1 - f0,
+               mayThrow);
+            for (size_t kk = 0; kk < f1 - f0;) {
+               const bool isQuiet = fabs(buffer[kk]) < level;
+               if (isQuiet)
+                  quiet(theBlock.start + f0 + kk);
+               else
+                  loud(theBlock.start + f0 + kk);
+               kk = FindLevelChange(buffer.get(), kk + 1, f1 - f0, level,
+                  isQuiet);
+            }
+            ii = jj;
+         }
+      }
+   }
+
+   if (open)
+      runs.push_back({ runStart, end });
+}
+
 std::unique_ptr<Sequence> Sequence::Copy(sampleCount s0, sampleCount s1) const
 {
    auto dest = std::make_unique<Sequence>(mDirManager, mSampleFormat);
@@ -168,6 +168,14 @@ class PROFILE_DLL_API Sequence final : public XMLTagHandler{
    std::pair<float, float> GetMinMax(
       sampleCount start, sampleCount len, bool mayThrow) const;
    float GetRMS(sampleCount start, sampleCount len, bool mayThrow) const;
+   double GetSum(sampleCount start, sampleCount len, bool mayThrow) const;
+
+   // Appends the maximal runs of samples in the region whose absolute
+   // values are all less than level, omitting those shorter than minLength
+   // that don't touch either end of the region.  Summaries show most runs
+   // without reading samples.
+   void FindQuietRuns(sampleCount start, sampleCount len, double level,
+      sampleCount minLength, SampleRuns &runs, bool mayThrow) const;
 
    //
    // Getting block size and alignment information
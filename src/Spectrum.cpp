@@ -18,6 +18,7 @@
 #include <math.h>
 
 #include "SampleFormat.h"
+#include "SpectrumTransformer.h"
 
 bool ComputeSpectrum(const float * data, size_t width,
                      size_t windowSize,
@@ -39,41 +40,45 @@ bool ComputeSpectrum(const float * data, size_t width,
    Floats in{ windowSize };
    Floats out{ windowSize };
    Floats out2{ windowSize };
+   Floats win{ windowSize };
 
-   size_t start = 0;
-   unsigned windows = 0;
-   while (start + windowSize <= width) {
-      for (size_t i = 0; i < windowSize; i++)
-         in[i] = data[start + i];
-
-      WindowFunc(windowFunc, windowSize, in.get());
-
-      if (autocorrelation) {
-         // Take FFT
-         RealFFT(windowSize, in.get(), out.get(), out2.get());
-         // Compute power
-         for (size_t i = 0; i < windowSize; i++)
-            in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
-
-         // Tolonen and Karjalainen recommend taking the cube root
-         // of the power, instead of the square root
-
-         for (size_t i = 0; i < windowSize; i++)
-            in[i] = powf(in[i], 1.0f / 3.0f);
-
-         // Take FFT
-         RealFFT(windowSize, in.get(), out.get(), out2.get());
+   for (size_t i = 0; i < windowSize; i++)
+      win[i] = 1.0f;
+   WindowFunc(windowFunc, windowSize, win.get());
+
+   SpectrumTransformer transformer{ windowSize, half, win.get() };
+   const auto windows = transformer.CountFrames(width);
+
+   transformer.Process(data, width,
+      [&](float *frames, size_t count, size_t) {
+         if (!autocorrelation) {
+            transformer.AccumulatePower(frames, count, processed.get());
+            return true;
+         }
+
+         for (size_t frame = 0; frame < count; frame++) {
+            // Take FFT (already done) and compute power
+            transformer.Unpack(frames + frame * windowSize,
+               out.get(), out2.get());
+            for (size_t i = 0; i < windowSize; i++)
+               in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
+
+            // Tolonen and Karjalainen recommend taking the cube root
+            // of the power, instead of the square root
+
+            for (size_t i = 0; i < windowSize; i++)
+               in[i] = powf(in[i], 1.0f / 3.0f);
+
+            // Take FFT
+            RealFFT(windowSize, in.get(), out.get(), out2.get());
+
+            // Take real part of result
+            for (size_t i = 0; i < half; i++)
+              processed[i] += out[i];
+         }
+         return true;
       }
-      else
-         PowerSpectrum(windowSize, in.get(), out.get());
-
-      // Take real part of result
-      for (size_t i = 0; i < half; i++)
-        processed[i] += out[i];
-
-      start += half;
-      windows++;
-   }
+   );
 
    if (autocorrelation) {
 
@@ -15,6 +15,11 @@
 This class is used to do the 'find peaks' snapping both in FreqPlot
 and in the spectrogram spectral selection.
 
+*//****************************************************************//**
+
+\class SpectrumAnalysisTask
+\brief Runs a SpectrumAnalyst over long selections on worker threads.
+
 *//*******************************************************************/
 
 /*
@@ -26,8 +31,10 @@ and in the spectrogram spectral selection.
 #include "Audacity.h"
 #include "SpectrumAnalyst.h"
 #include "FFT.h"
+#include "SpectrumTransformer.h"
 
 #include "SampleFormat.h"
+#include "WaveTrack.h"
 #include <wx/dcclient.h>
 
 FreqGauge::FreqGauge(wxWindow * parent, wxWindowID winid)
@@ -95,6 +102,33 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
                                 const float *data, size_t dataLen,
                                 float *pYMin, float *pYMax,
                                 FreqGauge *progress)
+{
+   if (!Start(alg, windowFunc, windowSize, rate))
+      return false;
+
+   if (dataLen < windowSize) {
+      return false;
+   }
+
+   if (progress) {
+      progress->SetRange(dataLen);
+   }
+
+   Accumulator accumulator{ *this };
+   accumulator.Process(data, dataLen, progress);
+
+   if (progress) {
+      // Reset for next time
+      progress->Reset();
+   }
+
+   Finish(accumulator.sums.data(), accumulator.windows, pYMin, pYMax);
+
+   return true;
+}
+
+bool SpectrumAnalyst::Start(Algorithm alg, int windowFunc,
+                            size_t windowSize, double rate)
 {
    // Wipe old data
    mProcessed.resize(0);
@@ -111,70 +145,88 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
       return false;
    }
 
-   if (dataLen < windowSize) {
-      return false;
-   }
-
    // Now repopulate
    mRate = rate;
    mWindowSize = windowSize;
    mAlg = alg;
 
-   auto half = mWindowSize / 2;
-   mProcessed.resize(mWindowSize);
+   mWindow.assign(mWindowSize, 1.0f);
+   WindowFunc(windowFunc, mWindowSize, mWindow.data());
 
-   Floats in{ mWindowSize };
-   Floats out{ mWindowSize };
-   Floats out2{ mWindowSize };
-   Floats win{ mWindowSize };
+   return true;
+}
 
-   for (size_t i = 0; i < mWindowSize; i++) {
-      mProcessed[i] = 0.0f;
-      win[i] = 1.0f;
-   }
+size_t SpectrumAnalyst::CountWindows(sampleCount len) const
+{
+   const auto half = mWindowSize / 2;
+   if (half == 0 || len < mWindowSize)
+      return 0;
+   return ((len - mWindowSize) / half).as_size_t() + 1;
+}
 
-   WindowFunc(windowFunc, mWindowSize, win.get());
+SpectrumAnalyst::Accumulator::Accumulator(const SpectrumAnalyst &analyst)
+   : sums(analyst.mWindowSize, 0.0f)
+   , mAnalyst{ analyst }
+   , mTransformer{
+      analyst.mWindowSize, analyst.mWindowSize / 2, analyst.mWindow.data() }
+   , in{ analyst.mWindowSize }
+   , out{ analyst.mWindowSize }
+   , out2{ analyst.mWindowSize }
+{
+}
 
-   // Scale window such that an amplitude of 1.0 in the time domain
-   // shows an amplitude of 0dB in the frequency domain
-   double wss = 0;
-   for (size_t i = 0; i<mWindowSize; i++)
-      wss += win[i];
-   if(wss > 0)
-      wss = 4.0 / (wss*wss);
-   else
-      wss = 1.0;
+void SpectrumAnalyst::Accumulator::Reset()
+{
+   std::fill(sums.begin(), sums.end(), 0.0f);
+   windows = 0;
+}
 
-   if (progress) {
-      progress->SetRange(dataLen);
-   }
+void SpectrumAnalyst::Accumulator::Process(
+   const float *data, size_t len, FreqGauge *progress)
+{
+   const auto half = mAnalyst.mWindowSize / 2;
+   mTransformer.Process(data, len,
+      [&](float *frames, size_t count, size_t first) {
+         ProcessBatch(frames, count);
+
+         // Update the progress bar
+         if (progress) {
+            progress->SetValue((first + count - 1) * half);
+         }
 
-   size_t start = 0;
-   int windows = 0;
-   while (start + mWindowSize <= dataLen) {
-      for (size_t i = 0; i < mWindowSize; i++)
-         in[i] = win[i] * data[start + i];
+         return true;
+      }
+   );
+}
 
-      switch (alg) {
-         case Spectrum:
-            PowerSpectrum(mWindowSize, in.get(), out.get());
+bool SpectrumAnalyst::Accumulator::ProcessBatch(float *frames, size_t count)
+{
+   const auto alg = mAnalyst.mAlg;
+   const auto windowSize = mAnalyst.mWindowSize;
+   const auto half = windowSize / 2;
 
-            for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
-            break;
+   windows += count;
+
+   if (alg == Spectrum) {
+      mTransformer.AccumulatePower(frames, count, sums.data());
+      return true;
+   }
 
+   for (size_t frame = 0; frame < count; frame++) {
+      // Frames arrive windowed and transformed
+      mTransformer.Unpack(frames + frame * windowSize, out.get(), out2.get());
+
+      switch (alg) {
          case Autocorrelation:
          case CubeRootAutocorrelation:
          case EnhancedAutocorrelation:
 
-            // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
             // Compute power
-            for (size_t i = 0; i < mWindowSize; i++)
+            for (size_t i = 0; i < windowSize; i++)
                in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
 
             if (alg == Autocorrelation) {
-               for (size_t i = 0; i < mWindowSize; i++)
+               for (size_t i = 0; i < windowSize; i++)
                   in[i] = sqrt(in[i]);
             }
             if (alg == CubeRootAutocorrelation ||
@@ -182,26 +234,24 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
                // Tolonen and Karjalainen recommend taking the cube root
                // of the power, instead of the square root
 
-               for (size_t i = 0; i < mWindowSize; i++)
+               for (size_t i = 0; i < windowSize; i++)
                   in[i] = pow(in[i], 1.0f / 3.0f);
             }
             // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
+            RealFFT(windowSize, in.get(), out.get(), out2.get());
 
             // Take real part of result
             for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
+               sums[i] += out[i];
             break;
 
          case Cepstrum:
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
-
             // Compute log power
             // Set a sane lower limit assuming maximum time amplitude of 1.0
             {
                float power;
-               float minpower = 1e-20*mWindowSize*mWindowSize;
-               for (size_t i = 0; i < mWindowSize; i++)
+               float minpower = 1e-20*windowSize*windowSize;
+               for (size_t i = 0; i < windowSize; i++)
                {
                   power = (out[i] * out[i]) + (out2[i] * out2[i]);
                   if(power < minpower)
@@ -210,11 +260,11 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
                      in[i] = log(power);
                }
                // Take IFFT
-               InverseRealFFT(mWindowSize, in.get(), NULL, out.get());
+               InverseRealFFT(windowSize, in.get(), NULL, out.get());
 
                // Take real part of result
                for (size_t i = 0; i < half; i++)
-                  mProcessed[i] += out[i];
+                  sums[i] += out[i];
             }
 
             break;
@@ -223,20 +273,27 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
             wxASSERT(false);
             break;
       }                         //switch
+   }
 
-      // Update the progress bar
-      if (progress) {
-         progress->SetValue(start);
-      }
+   return true;
+}
 
-      start += half;
-      windows++;
-   }
+void SpectrumAnalyst::Finish(const float *sums, size_t windows,
+                             float *pYMin, float *pYMax)
+{
+   auto half = mWindowSize / 2;
+   mProcessed.assign(sums, sums + mWindowSize);
+   std::vector<float> out(half);
 
-   if (progress) {
-      // Reset for next time
-      progress->Reset();
-   }
+   // Scale window such that an amplitude of 1.0 in the time domain
+   // shows an amplitude of 0dB in the frequency domain
+   double wss = 0;
+   for (size_t i = 0; i<mWindowSize; i++)
+      wss += mWindow[i];
+   if(wss > 0)
+      wss = 4.0 / (wss*wss);
+   else
+      wss = 1.0;
 
    float mYMin = 1000000, mYMax = -1000000;
    double scale;
@@ -333,8 +390,6 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
       *pYMin = mYMin;
    if (pYMax)
       *pYMax = mYMax;
-
-   return true;
 }
 
 const float *SpectrumAnalyst::GetProcessed() const
@@ -509,3 +564,110 @@ float SpectrumAnalyst::CubicMaximize(float y0, float y1, float y2, float y3, flo
       return x2;
    }
 }
+
+SpectrumAnalysisTask::SpectrumAnalysisTask(const SpectrumAnalyst &analyst,
+   std::vector< std::shared_ptr<const WaveTrack> > tracks, sampleCount len)
+   : mAnalyst{ analyst }
+   , mTracks{ std::move(tracks) }
+   , mTotalWindows{ analyst.CountWindows(len) }
+   , mSums(analyst.mWindowSize, 0.0f)
+{
+   // Read about a million samples at a time, whatever the window size
+   const auto half = mAnalyst.mWindowSize / 2;
+   mWindowsPerChunk = std::max<size_t>(1, (1 << 20) / std::max<size_t>(1, half));
+   mNumChunks = (mTotalWindows + mWindowsPerChunk - 1) / mWindowsPerChunk;
+
+   const auto nThreads = std::max<size_t>(1, std::min<size_t>(mNumChunks,
+      std::thread::hardware_concurrency()));
+
+   // If a thread fails to start, stop and join those already started,
+   // because destroying a joinable thread terminates
+   bool started = false;
+   auto joiner = finally( [&] {
+      if (!started) {
+         Cancel();
+         for (auto &thread : mThreads)
+            thread.join();
+      }
+   } );
+   for (size_t ii = 0; ii < nThreads; ++ii)
+      mThreads.emplace_back([this]{ Worker(); });
+   started = true;
+}
+
+SpectrumAnalysisTask::~SpectrumAnalysisTask()
+{
+   Cancel();
+   for (auto &thread : mThreads)
+      thread.join();
+}
+
+void SpectrumAnalysisTask::Cancel()
+{
+   mCancel.store(true, std::memory_order_relaxed);
+}
+
+size_t SpectrumAnalysisTask::GetSums(std::vector<float> &sums, bool &done) const
+{
+   std::lock_guard<std::mutex> locker{ mMutex };
+   sums = mSums;
+   done = (mWorkersDone == mThreads.size());
+   return mWindowsDone;
+}
+
+void SpectrumAnalysisTask::Worker()
+{
+   const auto windowSize = mAnalyst.mWindowSize;
+   const auto half = windowSize / 2;
+   const auto maxLen = (mWindowsPerChunk - 1) * half + windowSize;
+
+   SpectrumAnalyst::Accumulator accumulator{ mAnalyst };
+   Floats buffer{ maxLen };
+   Floats buffer2{ maxLen };
+
+   while (!mCancel.load(std::memory_order_relaxed)) {
+      const auto chunk = mNextChunk++;
+      if (chunk >= mNumChunks)
+         break;
+
+      // The chunk's windows, and the samples they cover
+      const auto firstWindow = chunk * mWindowsPerChunk;
+      const auto nWindows =
+         std::min(mWindowsPerChunk, mTotalWindows - firstWindow);
+      const auto start = sampleCount{ firstWindow } * half;
+      const auto len = (nWindows - 1) * half + windowSize;
+
+      // Sum the tracks.  Don't allow throw for bad reads on this thread,
+      // but don't let the zeroes that replace them pass for audio.
+      bool first = true;
+      bool good = true;
+      for (const auto &pTrack : mTracks) {
+         auto dest = first ? buffer.get() : buffer2.get();
+         if (!pTrack->Get((samplePtr)dest, floatSample, start, len,
+                          fillZero, false)) {
+            good = false;
+            break;
+         }
+         if (!first)
+            for (size_t i = 0; i < len; i++)
+               buffer[i] += buffer2[i];
+         first = false;
+      }
+      if (!good) {
+         mFailed.store(true, std::memory_order_relaxed);
+         Cancel();
+         break;
+      }
+
+      accumulator.Reset();
+      accumulator.Process(buffer.get(), len);
+
+      std::lock_guard<std::mutex> locker{ mMutex };
+      for (size_t i = 0; i < half; i++)
+         mSums[i] += accumulator.sums[i];
+      mWindowsDone += accumulator.windows;
+   }
+
+   std::lock_guard<std::mutex> locker{ mMutex };
+   ++mWorkersDone;
+}
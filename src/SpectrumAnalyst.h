@@ -12,10 +12,17 @@
 #ifndef __AUDACITY_SPECTRUM_ANALYST__
 #define __AUDACITY_SPECTRUM_ANALYST__
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <wx/statusbr.h>
 
+#include "SpectrumTransformer.h"
+
 class FreqGauge;
+class WaveTrack;
 
 class AUDACITY_DLL_API SpectrumAnalyst
 {
@@ -42,6 +49,42 @@ public:
       float *pYMin = NULL, float *pYMax = NULL, // outputs
       FreqGauge *progress = NULL);
 
+   // Calculate in pieces:  Start, then sum frames with any number of
+   // Accumulators, possibly on other threads, then Finish with the sums.
+   // Start returns true iff the inputs are valid, and clears the results.
+   bool Start(Algorithm alg,
+      int windowFunc, // see FFT.h for values
+      size_t windowSize, double rate);
+   void Finish(const float *sums, size_t windows,
+      float *pYMin = NULL, float *pYMax = NULL); // outputs
+
+   // How many frames, each half a window after the previous, fit in len
+   size_t CountWindows(sampleCount len) const;
+
+   // Sums per-frame results of the algorithm chosen by Start, for
+   // contiguous pieces of the signal
+   class Accumulator
+   {
+   public:
+      explicit Accumulator(const SpectrumAnalyst &analyst);
+
+      // Add all whole frames of data
+      void Process(const float *data, size_t len,
+         FreqGauge *progress = NULL);
+      // Zero the sums
+      void Reset();
+
+      std::vector<float> sums; // window size, only the lower half is used
+      size_t windows{ 0 };
+
+   private:
+      bool ProcessBatch(float *frames, size_t count);
+
+      const SpectrumAnalyst &mAnalyst;
+      SpectrumTransformer mTransformer;
+      Floats in, out, out2;
+   };
+
    const float *GetProcessed() const;
    int GetProcessedSize() const;
 
@@ -53,12 +96,61 @@ private:
    float CubicMaximize(float y0, float y1, float y2, float y3, float * max) const;
 
 private:
+   friend class SpectrumAnalysisTask;
+
    Algorithm mAlg;
    double mRate;
    size_t mWindowSize;
+   std::vector<float> mWindow;
    std::vector<float> mProcessed;
 };
 
+// Runs a SpectrumAnalyst over the sum of some tracks on worker threads,
+// a chunk at a time, so that memory use does not depend on the length
+// and the caller is not blocked.  Partial sums can be taken at any time
+// for a progressive display.
+class AUDACITY_DLL_API SpectrumAnalysisTask
+{
+public:
+   // analyst must have been started; tracks must all have its rate and
+   // must not be modified while the task runs; the first len samples of
+   // each are analyzed
+   SpectrumAnalysisTask(const SpectrumAnalyst &analyst,
+      std::vector< std::shared_ptr<const WaveTrack> > tracks,
+      sampleCount len);
+   // Cancels and waits for the workers
+   ~SpectrumAnalysisTask();
+
+   void Cancel();
+
+   // Copies the sums so far and returns how many windows they include
+   size_t GetSums(std::vector<float> &sums, bool &done) const;
+   size_t GetTotalWindows() const { return mTotalWindows; }
+   // True if samples could not be read; the workers then stop, and the
+   // sums lack the unread chunks
+   bool Failed() const { return mFailed.load(std::memory_order_relaxed); }
+
+private:
+   void Worker();
+
+   const SpectrumAnalyst mAnalyst;
+   const std::vector< std::shared_ptr<const WaveTrack> > mTracks;
+   const size_t mTotalWindows;
+   size_t mWindowsPerChunk;
+   size_t mNumChunks;
+
+   std::atomic<size_t> mNextChunk{ 0 };
+   std::atomic<bool> mCancel{ false };
+   std::atomic<bool> mFailed{ false };
+
+   mutable std::mutex mMutex;
+   std::vector<float> mSums;
+   size_t mWindowsDone{ 0 };
+   size_t mWorkersDone{ 0 };
+
+   std::vector<std::thread> mThreads;
+};
+
 class AUDACITY_DLL_API FreqGauge final : public wxStatusBar
 {
 public:
@@ -0,0 +1,99 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrumTransformer.cpp
+
+*******************************************************************//**
+
+\class SpectrumTransformer
+\brief Batched short-time Fourier transform, shared by the spectral
+effects and analyses.
+
+*//*******************************************************************/
+
+#include "SpectrumTransformer.h"
+
+#include <algorithm>
+
+SpectrumTransformer::SpectrumTransformer(size_t windowSize, size_t stepSize,
+   const float *window, size_t batchSize)
+   : mWindowSize{ windowSize }
+   , mStepSize{ std::max<size_t>(1, stepSize) }
+   , mBatchSize{ std::max<size_t>(1, batchSize) }
+   , hFFT{ GetFFT(windowSize) }
+   , mWindow{ windowSize }
+   , mFrames{ mBatchSize * windowSize }
+{
+   if (window)
+      std::copy(window, window + windowSize, mWindow.get());
+   else
+      std::fill(mWindow.get(), mWindow.get() + windowSize, 1.0f);
+}
+
+size_t SpectrumTransformer::CountFrames(sampleCount len) const
+{
+   if (len < mWindowSize)
+      return 0;
+   return ((len - mWindowSize) / mStepSize).as_size_t() + 1;
+}
+
+bool SpectrumTransformer::Flush(
+   size_t count, size_t first, const BatchConsumer &consumer)
+{
+   const float *const window = mWindow.get();
+   for (size_t ii = 0; ii < count; ++ii) {
+      float *const frame = mFrames.get() + ii * mWindowSize;
+      for (size_t jj = 0; jj < mWindowSize; ++jj)
+         frame[jj] *= window[jj];
+      RealFFTf(frame, hFFT.get());
+   }
+   return consumer(mFrames.get(), count, first);
+}
+
+bool SpectrumTransformer::Process(
+   const float *data, size_t len, const BatchConsumer &consumer)
+{
+   const auto nFrames = CountFrames(len);
+   size_t count = 0, first = 0;
+   for (size_t frame = 0; frame < nFrames; ++frame) {
+      const float *const src = data + frame * mStepSize;
+      std::copy(src, src + mWindowSize, mFrames.get() + count * mWindowSize);
+      if (++count == mBatchSize) {
+         if (!Flush(count, first, consumer))
+            return false;
+         first += count;
+         count = 0;
+      }
+   }
+   return count == 0 || Flush(count, first, consumer);
+}
+
+void SpectrumTransformer::AccumulatePower(
+   const float *frames, size_t count, float *sums) const
+{
+   const auto half = mWindowSize / 2;
+   const int *const bitReversed = hFFT->BitReversed.get();
+   for (size_t ii = 0; ii < count; ++ii) {
+      const float *const frame = frames + ii * mWindowSize;
+      // Handle the (real-only) DC
+      sums[0] += frame[0] * frame[0];
+      for (size_t jj = 1; jj < half; ++jj) {
+         const float re = frame[bitReversed[jj]];
+         const float im = frame[bitReversed[jj] + 1];
+         sums[jj] += re * re + im * im;
+      }
+   }
+}
+
+void SpectrumTransformer::Unpack(
+   const float *frame, float *real, float *imag) const
+{
+   const auto half = mWindowSize / 2;
+   ReorderToFreq(hFFT.get(), frame, real, imag);
+   // Fill in the upper half using symmetry properties
+   for (size_t ii = half + 1; ii < mWindowSize; ++ii) {
+      real[ii] = real[mWindowSize - ii];
+      imag[ii] = -imag[mWindowSize - ii];
+   }
+}
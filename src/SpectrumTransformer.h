@@ -0,0 +1,72 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrumTransformer.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SPECTRUM_TRANSFORMER__
+#define __AUDACITY_SPECTRUM_TRANSFORMER__
+
+#include "Audacity.h"
+
+#include <functional>
+#include "RealFFTf.h"
+#include "SampleFormat.h"
+
+/// Short-time Fourier transform of a signal: windows overlapping frames
+/// spaced by a fixed step, and transforms them with RealFFTf several at a
+/// time.  Consumers receive whole batches of frames, so that per-bin loops
+/// run across frames without a function call for each.
+class AUDACITY_DLL_API SpectrumTransformer
+{
+public:
+   /*!
+    @param windowSize a power of two
+    @param stepSize distance between starts of successive frames
+    @param window windowSize analysis window values; if null, rectangular
+    @param batchSize how many frames are transformed before each callback
+    */
+   SpectrumTransformer(size_t windowSize, size_t stepSize,
+      const float *window, size_t batchSize = 16);
+
+   size_t GetWindowSize() const { return mWindowSize; }
+   size_t GetStepSize() const { return mStepSize; }
+   size_t GetBatchSize() const { return mBatchSize; }
+   const FFTParam *GetFFTParam() const { return hFFT.get(); }
+
+   /// Receives count transformed frames, each GetWindowSize() values long and
+   /// contiguous, in the packed bit-reversed order that RealFFTf leaves.
+   /// first is the number of frames passed in earlier batches.
+   /// Frames may be modified in place.  Return false to stop early.
+   using BatchConsumer =
+      std::function< bool(float *frames, size_t count, size_t first) >;
+
+   /// How many whole frames fit in len samples
+   size_t CountFrames(sampleCount len) const;
+
+   /// Transform every whole frame of data, of len samples
+   /// @return false if the consumer stopped early
+   bool Process(const float *data, size_t len, const BatchConsumer &consumer);
+
+   /// Add power of bins 0 ... GetWindowSize() / 2 - 1 of count frames to sums
+   void AccumulatePower(const float *frames, size_t count, float *sums) const;
+
+   /// Unpack one transformed frame into full conjugate-symmetric spectra,
+   /// each GetWindowSize() long, as from RealFFT
+   void Unpack(const float *frame, float *real, float *imag) const;
+
+private:
+   // Window and transform the frames now in mFrames
+   bool Flush(size_t count, size_t first, const BatchConsumer &consumer);
+
+   const size_t mWindowSize;
+   const size_t mStepSize;
+   const size_t mBatchSize;
+   HFFT hFFT;
+   Floats mWindow;
+   Floats mFrames;
+};
+
+#endif
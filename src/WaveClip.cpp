@@ -24,6 +24,8 @@
 #include "Experimental.h"
 
 #include <math.h>
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <vector>
 #include <wx/log.h>
@@ -258,12 +260,101 @@ public:
       return count_if(begin + startIn, begin + endIn, bind2nd(less<int>(), 0));
    }
 
+   // How many columns of this cache make up one column at the given zoom,
+   // or zero if that zoom is not an integer multiple of this cache's.
+   // The accumulated difference over numPixels columns must be less than
+   // one sample, as for an exact match of zoom.
+   size_t ReuseRatio(double samplesPerPixel, size_t numPixels) const
+   {
+      if (pps <= 0 || len == 0)
+         return 0;
+      const double oldSamplesPerPixel = rate / pps;
+      const double ratio = floor(0.5 + samplesPerPixel / oldSamplesPerPixel);
+      if (ratio < 1.0 ||
+          fabs(samplesPerPixel - ratio * oldSamplesPerPixel) * numPixels >= 1.0)
+         return 0;
+      return ratio;
+   }
+
+   // Fill columns of another cache from this one.  Column zero of dest
+   // begins at sample position origin and spans ratio columns of this.
+   // Columns of dest already flagged in filled are left alone; those
+   // filled here get flagged.  Returns how many columns were filled.
+   size_t CopyTo(WaveCache &dest, double origin, size_t ratio,
+                 std::vector<char> &filled) const
+   {
+      if (pps <= 0 || len == 0 || ratio == 0)
+         return 0;
+      const double samplesPerPixel = rate / pps;
+      const double where0 = where[1].as_double() - samplesPerPixel;
+      const long oldX0 = floor(0.5 + (origin - where0) / samplesPerPixel);
+      if (fabs(where0 + oldX0 * samplesPerPixel - origin) >= 1.0)
+         // The column boundaries are out of phase
+         return 0;
+
+      // Range of dest columns lying wholly within this cache
+      const long step = ratio;
+      const long xBegin = oldX0 >= 0 ? 0 : (step - 1 - oldX0) / step;
+      const long xEnd = std::min<long>(dest.len,
+         std::max(0L, ((long)len - oldX0) / step));
+
+      size_t result = 0;
+      for (long x = xBegin; x < xEnd; ++x) {
+         if (filled[x])
+            continue;
+         const long j0 = oldX0 + x * step;
+         if (step == 1) {
+            dest.min[x] = min[j0];
+            dest.max[x] = max[j0];
+            dest.rms[x] = rms[j0];
+            dest.bl[x] = bl[j0];
+         }
+         else {
+            // Aggregate, weighting rms by the samples in each column
+            float theMin = min[j0], theMax = max[j0];
+            int theBl = bl[j0];
+            double sumsq = 0, denom = 0;
+            for (long j = j0; j < j0 + step; ++j) {
+               theMin = std::min(theMin, min[j]);
+               theMax = std::max(theMax, max[j]);
+               // Any column not yet computed (negative) taints the result
+               theBl = std::min(theBl, bl[j]);
+               const double count =
+                  std::max(1.0, (where[j + 1] - where[j]).as_double());
+               sumsq += double(rms[j]) * rms[j] * count;
+               denom += count;
+            }
+            dest.min[x] = theMin;
+            dest.max[x] = theMax;
+            dest.rms[x] = (float)sqrt(sumsq / denom);
+            dest.bl[x] = theBl;
+         }
+         filled[x] = 1;
+         ++result;
+      }
+      return result;
+   }
+
 protected:
    std::vector<InvalidRegion> mRegions;
    ODLock mRegionsMutex;
 
 };
 
+// Weighted powers of the hops of a clip, for loudness measurement; valid
+// while the clip keeps the same samples, rate and place in the track, for
+// the same weighting
+class LoudnessPowers {
+public:
+   LoudnessWeightingFactory weighting;
+   int rate;
+   sampleCount start;
+   sampleCount numSamples;
+   size_t hopSize;
+   sampleCount firstHop;
+   std::vector<double> powers;
+};
+
 static void ComputeSpectrumUsingRealFFTf
    (float * __restrict buffer, const FFTParam *hFFT,
     const float * __restrict window, size_t len, float * __restrict out)
@@ -326,6 +417,13 @@ WaveClip::WaveClip(const WaveClip& orig,
    mSpecCache = std::make_unique<SpecCache>();
    mSpecPxCache = std::make_unique<SpecPxCache>(1);
 
+   {
+      ODLocker locker(&orig.mLoudnessMutex);
+      if (orig.mLoudnessDirty == orig.mDirty)
+         mLoudnessPowers = orig.mLoudnessPowers;
+   }
+   mLoudnessDirty = mDirty;
+
    if ( copyCutlines )
       for (const auto &clip: orig.mCutLines)
          mCutLines.push_back
@@ -398,6 +496,106 @@ bool WaveClip::GetSamples(samplePtr buffer, sampleFormat format,
    return mSequence->Get(buffer, format, start, len, mayThrow);
 }
 
+double WaveClip::GetSampleSum(sampleCount start, size_t len,
+                              bool mayThrow) const
+{
+   return mSequence->GetSum(start, len, mayThrow);
+}
+
+void WaveClip::FindQuietRuns(sampleCount start, sampleCount len, double level,
+                             sampleCount minLength, SampleRuns &runs,
+                             bool mayThrow) const
+{
+   mSequence->FindQuietRuns(start, len, level, minLength, runs, mayThrow);
+}
+
+bool WaveClip::AddLoudnessPowers(size_t hopSize, sampleCount firstHop,
+                                 size_t nHops, double *powers,
+                                 LoudnessWeightingFactory weighting,
+                                 bool cache,
+                                 const std::function<bool(sampleCount)> &progress,
+                                 bool mayThrow) const
+{
+   const auto clipStart = GetStartSample();
+   const auto numSamples = GetNumSamples();
+   const auto clipEnd = clipStart + numSamples;
+   const auto from = std::max(clipStart, firstHop * hopSize);
+   const auto to = std::min(clipEnd, (firstHop + nHops) * hopSize);
+   if (from >= to)
+      return true;
+
+   std::shared_ptr<const LoudnessPowers> pPowers;
+   {
+      ODLocker locker(&mLoudnessMutex);
+      if (mLoudnessPowers && mLoudnessDirty == mDirty &&
+          mLoudnessPowers->weighting == weighting &&
+          mLoudnessPowers->rate == mRate &&
+          mLoudnessPowers->start == clipStart &&
+          mLoudnessPowers->numSamples == numSamples &&
+          mLoudnessPowers->hopSize == hopSize)
+         pPowers = mLoudnessPowers;
+   }
+
+   if (!pPowers) {
+      // Weight the whole clip to keep its powers, or else only up to the
+      // end of the range.  Either way the filters start at rest at the
+      // clip's start, so that the powers are the same on both paths.
+      const auto begin = clipStart;
+      const auto end = cache ? clipEnd : to;
+      auto pNew = std::make_shared<LoudnessPowers>();
+      pNew->weighting = weighting;
+      pNew->rate = mRate;
+      pNew->start = clipStart;
+      pNew->numSamples = numSamples;
+      pNew->hopSize = hopSize;
+      pNew->firstHop = begin / hopSize;
+      pNew->powers.resize(
+         ((end - 1) / hopSize - pNew->firstHop + 1).as_size_t(), 0.0);
+
+      auto filter = weighting(mRate);
+      const auto maxLen = mSequence->GetMaxBlockSize();
+      Floats buffer{ maxLen };
+      for (auto pos = begin; pos < end;) {
+         const auto len = limitSampleBufferSize(
+            mSequence->GetBestBlockSize(pos - clipStart), end - pos);
+         GetSamples((samplePtr)buffer.get(), floatSample, pos - clipStart,
+            len, mayThrow);
+         filter(buffer.get(), len);
+
+         // Sum each run of samples that lies in one hop
+         for (size_t ii = 0; ii < len;) {
+            const auto hop = (pos + ii) / hopSize;
+            const auto count = limitSampleBufferSize(
+               len - ii, (hop + 1) * hopSize - (pos + ii));
+            double sum = 0;
+            for (size_t jj = ii; jj < ii + count; ++jj) {
+               const double value = buffer[jj];
+               sum += value * value;
+            }
+            pNew->powers[(hop - pNew->firstHop).as_size_t()] += sum;
+            ii += count;
+         }
+
+         pos += len;
+         if (!progress(pos - begin))
+            return false;
+      }
+
+      if (cache) {
+         ODLocker locker(&mLoudnessMutex);
+         mLoudnessPowers = pNew;
+         mLoudnessDirty = mDirty;
+      }
+      pPowers = pNew;
+   }
+
+   const auto lastHop = (to - 1) / hopSize;
+   for (auto hop = from / hopSize; hop <= lastHop; ++hop)
+      powers[(hop - firstHop).as_size_t()] +=
+         pPowers->powers[(hop - pPowers->firstHop).as_size_t()];
+   return true;
+}
+
 void WaveClip::SetSamples(samplePtr buffer, sampleFormat format,
                    sampleCount start, size_t len)
 // STRONG-GUARANTEE
@@ -489,6 +687,8 @@ void WaveClip::ClearWaveCache()
 {
    ODLocker locker(&mWaveCacheMutex);
    mWaveCache = std::make_unique<WaveCache>();
+   for (auto &pCache : mWaveCacheRing)
+      pCache.reset();
 }
 
 ///Adds an invalid region to the wavecache so it redraws that portion only.
@@ -497,52 +697,53 @@ void WaveClip::AddInvalidRegion(sampleCount startSample, sampleCount endSample)
    ODLocker locker(&mWaveCacheMutex);
    if(mWaveCache!=NULL)
       mWaveCache->AddInvalidRegion(startSample,endSample);
+   for (auto &pCache : mWaveCacheRing)
+      if (pCache)
+         pCache->AddInvalidRegion(startSample, endSample);
 }
 
 namespace {
 
+// Returns false, and no correction, if old and NEW caches are disjoint.
+// The old cache may be at a finer zoom, given by oldSamplesPerPixel.
 inline
-void findCorrection(const std::vector<sampleCount> &oldWhere, size_t oldLen,
+bool findCorrection(const std::vector<sampleCount> &oldWhere, size_t oldLen,
+         double oldSamplesPerPixel,
          size_t newLen,
          double t0, double rate, double samplesPerPixel,
-         int &oldX0, double &correction)
+         double &correction)
 {
    // Mitigate the accumulation of location errors
    // in copies of copies of ... of caches.
    // Look at the loop that populates "where" below to understand this.
 
    // Find the sample position that is the origin in the old cache.
-   const double oldWhere0 = oldWhere[1].as_double() - samplesPerPixel;
-   const double oldWhereLast = oldWhere0 + oldLen * samplesPerPixel;
+   const double oldWhere0 = oldWhere[1].as_double() - oldSamplesPerPixel;
+   const double oldWhereLast = oldWhere0 + oldLen * oldSamplesPerPixel;
    // Find the length in samples of the old cache.
    const double denom = oldWhereLast - oldWhere0;
 
    // What sample would go in where[0] with no correction?
    const double guessWhere0 = t0 * rate;
 
+   correction = 0.0;
    if ( // Skip if old and NEW are disjoint:
       oldWhereLast <= guessWhere0 ||
       guessWhere0 + newLen * samplesPerPixel <= oldWhere0 ||
       // Skip unless denom rounds off to at least 1.
       denom < 0.5)
-   {
-      // The computation of oldX0 in the other branch
-      // may underflow and the assertion would be violated.
-      oldX0 =  oldLen;
-      correction = 0.0;
-   }
-   else
-   {
-      // What integer position in the old cache array does that map to?
-      // (even if it is out of bounds)
-      oldX0 = floor(0.5 + oldLen * (guessWhere0 - oldWhere0) / denom);
-      // What sample count would the old cache have put there?
-      const double where0 = oldWhere0 + double(oldX0) * samplesPerPixel;
-      // What correction is needed to align the NEW cache with the old?
-      const double correction0 = where0 - guessWhere0;
-      correction = std::max(-samplesPerPixel, std::min(samplesPerPixel, correction0));
-      wxASSERT(correction == correction0);
-   }
+      return false;
+
+   // What integer position in the old cache array does that map to?
+   // (even if it is out of bounds)
+   const int oldX0 = floor(0.5 + oldLen * (guessWhere0 - oldWhere0) / denom);
+   // What sample count would the old cache have put there?
+   const double where0 = oldWhere0 + double(oldX0) * oldSamplesPerPixel;
+   // What correction is needed to align the NEW cache with the old?
+   const double correction0 = where0 - guessWhere0;
+   correction = std::max(-samplesPerPixel, std::min(samplesPerPixel, correction0));
+   wxASSERT(correction == correction0);
+   return true;
 }
 
 inline void
@@ -563,6 +764,50 @@ fillWhere(std::vector<sampleCount> &where, size_t len, double bias, double corre
 // clipping calculations
 //
 
+namespace {
+// The counts behind WaveClipCacheStatistics
+struct AtomicCacheStatistics
+{
+   std::atomic<size_t> waveRequests{ 0 };
+   std::atomic<size_t> waveColumns{ 0 };
+   std::atomic<size_t> waveColumnsReused{ 0 };
+
+   std::atomic<size_t> specRequests{ 0 };
+   std::atomic<size_t> specColumns{ 0 };
+   std::atomic<size_t> specColumnsReused{ 0 };
+};
+
+AtomicCacheStatistics &CacheStatistics()
+{
+   static AtomicCacheStatistics statistics;
+   return statistics;
+}
+}
+
+WaveClipCacheStatistics WaveClip::GetCacheStatistics()
+{
+   const auto &counts = CacheStatistics();
+   WaveClipCacheStatistics statistics;
+   statistics.waveRequests = counts.waveRequests;
+   statistics.waveColumns = counts.waveColumns;
+   statistics.waveColumnsReused = counts.waveColumnsReused;
+   statistics.specRequests = counts.specRequests;
+   statistics.specColumns = counts.specColumns;
+   statistics.specColumnsReused = counts.specColumnsReused;
+   return statistics;
+}
+
+void WaveClip::ResetCacheStatistics()
+{
+   auto &counts = CacheStatistics();
+   counts.waveRequests = 0;
+   counts.waveColumns = 0;
+   counts.waveColumnsReused = 0;
+   counts.specRequests = 0;
+   counts.specColumns = 0;
+   counts.specColumnsReused = 0;
+}
+
 bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
                                double pixelsPerSecond, bool &isLoadingOD) const
 {
@@ -570,8 +815,9 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
 
    const size_t numPixels = (int)display.width;
 
-   size_t p0 = 0;         // least column requiring computation
-   size_t p1 = numPixels; // greatest column requiring computation, plus one
+   auto &statistics = CacheStatistics();
+   ++statistics.waveRequests;
+   statistics.waveColumns += numPixels;
 
    float *min;
    float *max;
@@ -579,6 +825,9 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
    int *bl;
    std::vector<sampleCount> *pWhere;
 
+   // Columns already satisfied from older caches
+   std::vector<char> filled(numPixels, 0);
+
    if (allocated) {
       // assume ownWhere is filled.
       min = &display.min[0];
@@ -594,19 +843,16 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
       const double tstep = 1.0 / pixelsPerSecond;
       const double samplesPerPixel = mRate * tstep;
 
-      // Make a tolerant comparison of the pps values in this wise:
-      // accumulated difference of times over the number of pixels is less than
-      // a sample period.
-      const bool ppsMatch = mWaveCache &&
-         (fabs(tstep - 1.0 / mWaveCache->pps) * numPixels < (1.0 / mRate));
-
-      const bool match =
-         mWaveCache &&
-         ppsMatch &&
-         mWaveCache->len > 0 &&
-         mWaveCache->dirty == mDirty;
+      // Can this cache contribute columns at the requested zoom?
+      const auto reuseRatio = [&](const std::unique_ptr<WaveCache> &pCache) {
+         return (pCache &&
+                 pCache->dirty == mDirty &&
+                 pCache->rate == mRate)
+            ? pCache->ReuseRatio(samplesPerPixel, numPixels)
+            : 0;
+      };
 
-      if (match &&
+      if (reuseRatio(mWaveCache) == 1 &&
          mWaveCache->start == t0 &&
          mWaveCache->len >= numPixels) {
          mWaveCache->LoadInvalidRegions(mSequence.get(), true);
@@ -619,28 +865,29 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
          display.bl = &mWaveCache->bl[0];
          display.where = &mWaveCache->where[0];
          isLoadingOD = mWaveCache->numODPixels > 0;
+         statistics.waveColumnsReused += numPixels;
          return true;
       }
 
-      std::unique_ptr<WaveCache> oldCache(std::move(mWaveCache));
+      // Retire the current cache to the front of the ring, dropping the
+      // least recent one
+      if (mWaveCache && mWaveCache->len > 0) {
+         std::move_backward(mWaveCacheRing.begin(), mWaveCacheRing.end() - 1,
+            mWaveCacheRing.end());
+         mWaveCacheRing[0] = std::move(mWaveCache);
+      }
 
-      int oldX0 = 0;
+      // Align the NEW columns with those of the most recent cache that
+      // overlaps them, at the same zoom or an integer fraction of it
       double correction = 0.0;
-      size_t copyBegin = 0, copyEnd = 0;
-      if (match) {
-         findCorrection(oldCache->where, oldCache->len, numPixels,
-            t0, mRate, samplesPerPixel,
-            oldX0, correction);
-         // Remember our first pixel maps to oldX0 in the old cache,
-         // possibly out of bounds.
-         // For what range of pixels can data be copied?
-         copyBegin = std::min<size_t>(numPixels, std::max(0, -oldX0));
-         copyEnd = std::min<size_t>(numPixels, std::max(0,
-            (int)oldCache->len - oldX0
-         ));
+      for (const auto &pCache : mWaveCacheRing) {
+         if (reuseRatio(pCache) > 0 &&
+             findCorrection(pCache->where, pCache->len,
+                mRate / pCache->pps, numPixels,
+                t0, mRate, samplesPerPixel,
+                correction))
+            break;
       }
-      if (!(copyEnd > copyBegin))
-         oldCache.reset(0);
 
       mWaveCache = std::make_unique<WaveCache>(numPixels, pixelsPerSecond, mRate, t0, mDirty);
       min = &mWaveCache->min[0];
@@ -652,35 +899,28 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
       fillWhere(*pWhere, numPixels, 0.0, correction,
          t0, mRate, samplesPerPixel);
 
-      // The range of pixels we must fetch from the Sequence:
-      p0 = (copyBegin > 0) ? 0 : copyEnd;
-      p1 = (copyEnd >= numPixels) ? copyBegin : numPixels;
-
-      // Optimization: if the old cache is good and overlaps
-      // with the current one, re-use as much of the cache as
-      // possible
-
-      if (oldCache) {
+      // Optimization: copy, or aggregate, as much as possible from the
+      // retired caches, most recent first, so that scrolling back and
+      // forth or zooming out does not fetch from the Sequence again
+      const double origin = t0 * mRate + correction;
+      for (auto &pCache : mWaveCacheRing) {
+         const auto ratio = reuseRatio(pCache);
+         if (ratio == 0)
+            continue;
 
          //TODO: only load inval regions if
          //necessary.  (usually is the case, so no rush.)
          //also, we should be updating the NEW cache, but here we are patching the old one up.
-         oldCache->LoadInvalidRegions(mSequence.get(), false);
-         oldCache->ClearInvalidRegions();
-
-         // Copy what we can from the old cache.
-         const int length = copyEnd - copyBegin;
-         const size_t sizeFloats = length * sizeof(float);
-         const int srcIdx = (int)copyBegin + oldX0;
-         memcpy(&min[copyBegin], &oldCache->min[srcIdx], sizeFloats);
-         memcpy(&max[copyBegin], &oldCache->max[srcIdx], sizeFloats);
-         memcpy(&rms[copyBegin], &oldCache->rms[srcIdx], sizeFloats);
-         memcpy(&bl[copyBegin], &oldCache->bl[srcIdx], length * sizeof(int));
+         pCache->LoadInvalidRegions(mSequence.get(), false);
+         pCache->ClearInvalidRegions();
+
+         statistics.waveColumnsReused +=
+            pCache->CopyTo(*mWaveCache, origin, ratio, filled);
       }
    }
 
-   if (p1 > p0) {
-      // Cache was not used or did not satisfy the whole request
+   // Fetch one run of columns that no cache could supply
+   const auto fetch = [&](size_t p0, size_t p1) {
       std::vector<sampleCount> &where = *pWhere;
 
       /* handle values in the append buffer */
@@ -762,11 +1002,24 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
                                         &bl[p0],
                                         p1-p0,
                                         &where[p0]))
-         {
-            isLoadingOD=false;
             return false;
-         }
       }
+      return true;
+   };
+
+   for (size_t p0 = 0; p0 < numPixels;) {
+      if (filled[p0]) {
+         ++p0;
+         continue;
+      }
+      auto p1 = p0 + 1;
+      while (p1 < numPixels && !filled[p1])
+         ++p1;
+      if (!fetch(p0, p1)) {
+         isLoadingOD=false;
+         return false;
+      }
+      p0 = p1;
    }
 
    //find the number of OD pixels - the only way to do this is by recounting
@@ -1219,6 +1472,10 @@ bool WaveClip::GetSpectrogram(WaveTrackCache &waveTrackCache,
    const WaveTrack *const track = waveTrackCache.GetTrack().get();
    const SpectrogramSettings &settings = track->GetSpectrogramSettings();
 
+   auto &statistics = CacheStatistics();
+   ++statistics.specRequests;
+   statistics.specColumns += numPixels;
+
    bool match =
       mSpecCache &&
       mSpecCache->len > 0 &&
@@ -1230,6 +1487,7 @@ bool WaveClip::GetSpectrogram(WaveTrackCache &waveTrackCache,
        mSpecCache->len >= numPixels) {
       spectrogram = &mSpecCache->freq[0];
       where = &mSpecCache->where[0];
+      statistics.specColumnsReused += numPixels;
 
       return false;  //hit cache completely
    }
@@ -1269,6 +1527,8 @@ bool WaveClip::GetSpectrogram(WaveTrackCache &waveTrackCache,
       copyEnd = std::min((int)numPixels, std::max(0,
          (int)mSpecCache->len - oldX0
       ));
+      if (copyEnd > copyBegin)
+         statistics.specColumnsReused += copyEnd - copyBegin;
    }
 
    // Resize the cache, keep the contents unchanged.
@@ -1908,79 +2168,46 @@ void WaveClip::Resample(int rate, ProgressDialog *progress)
       return; // Nothing to do
 
    double factor = (double)rate / (double)mRate;
-   ::Resample resample(true, factor, factor); // constant rate resampling
-
-   const size_t bufsize = 65536;
-   Floats inBuffer{ bufsize };
-   Floats outBuffer{ bufsize };
-   sampleCount pos = 0;
-   bool error = false;
-   int outGenerated = 0;
    auto numSamples = mSequence->GetNumSamples();
 
    auto newSequence =
       std::make_unique<Sequence>(mSequence->GetDirManager(), mSequence->GetSampleFormat());
 
-   /**
-    * We want to keep going as long as we have something to feed the resampler
-    * with OR as long as the resampler spews out samples (which could continue
-    * for a few iterations after we stop feeding it)
-    */
-   while (pos < numSamples || outGenerated > 0)
-   {
-      const auto inLen = limitSampleBufferSize( bufsize, numSamples - pos );
-
-      bool isLast = ((pos + inLen) == numSamples);
-
-      if (!mSequence->Get((samplePtr)inBuffer.get(), floatSample, pos, inLen, true))
-      {
-         error = true;
-         break;
-      }
-
-      const auto results = resample.Process(factor, inBuffer.get(), inLen, isLast,
-                                            outBuffer.get(), bufsize);
-      outGenerated = results.second;
-
-      pos += results.first;
-
-      if (outGenerated < 0)
-      {
-         error = true;
-         break;
-      }
-
-      newSequence->Append((samplePtr)outBuffer.get(), floatSample,
-                          outGenerated);
-
-      if (progress)
-      {
-         auto updateResult = progress->Update(
-            pos.as_long_long(),
-            numSamples.as_long_long()
-         );
-         error = (updateResult != ProgressResult::Success);
-         if (error)
-            throw UserException{};
-      }
-   }
+   // Resample in segments on several threads when the factor allows it
+   ::Resample::ProcessConstantRate(factor, numSamples,
+      [&](float *buffer, sampleCount pos, size_t len) {
+         if (!mSequence->Get((samplePtr)buffer, floatSample, pos, len, true))
+            throw SimpleMessageBoxException{
+               XO("Resampling failed.")
+            };
+      },
+      [&](const float *buffer, size_t len) {
+         newSequence->Append((samplePtr)buffer, floatSample, len);
+      },
+      [&](sampleCount pos) {
+         if (progress)
+         {
+            auto updateResult = progress->Update(
+               pos.as_long_long(),
+               numSamples.as_long_long()
+            );
+            if (updateResult != ProgressResult::Success)
+               throw UserException{};
+         }
+         return true;
+      });
 
-   if (error)
-      throw SimpleMessageBoxException{
-         XO("Resampling failed.")
-      };
-   else
-   {
-      // Use NOFAIL-GUARANTEE in these steps
+   // Use NOFAIL-GUARANTEE in these steps
 
-      // Invalidate wave display cache
-      mWaveCache = std::make_unique<WaveCache>();
-      // Invalidate the spectrum display cache
-      mSpecCache = std::make_unique<SpecCache>();
+   // Invalidate wave display cache
+   mWaveCache = std::make_unique<WaveCache>();
+   for (auto &pCache : mWaveCacheRing)
+      pCache.reset();
+   // Invalidate the spectrum display cache
+   mSpecCache = std::make_unique<SpecCache>();
 
-      mSequence = std::move(newSequence);
-      mRate = rate;
-   }
+   mSequence = std::move(newSequence);
+   mRate = rate;
 }
 
 // Used by commands which interact with clips using the keyboard.
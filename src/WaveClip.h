@@ -22,6 +22,8 @@
 
 #include <wx/longlong.h>
 
+#include <array>
+#include <functional>
 #include <vector>
 
 class BlockArray;
@@ -29,6 +31,7 @@ class BlockFile;
 using BlockFilePtr = std::shared_ptr<BlockFile>;
 class DirManager;
 class Envelope;
+class LoudnessPowers;
 class ProgressDialog;
 class Sequence;
 class SpectrogramSettings;
@@ -170,6 +173,19 @@ public:
    }
 };
 
+// Counts of display columns requested from all clips, and of those
+// supplied by the wave and spectrogram caches, for benchmarking
+struct WaveClipCacheStatistics
+{
+   size_t waveRequests{ 0 };
+   size_t waveColumns{ 0 };
+   size_t waveColumnsReused{ 0 };
+
+   size_t specRequests{ 0 };
+   size_t specColumns{ 0 };
+   size_t specColumnsReused{ 0 };
+};
+
 class AUDACITY_DLL_API WaveClip final : public XMLTagHandler
 {
 private:
@@ -235,6 +251,25 @@ public:
 
    bool GetSamples(samplePtr buffer, sampleFormat format,
                    sampleCount start, size_t len, bool mayThrow = true) const;
+   // Sum of the samples in the same range that GetSamples would copy
+   double GetSampleSum(sampleCount start, size_t len,
+                       bool mayThrow = true) const;
+   // Runs of quiet samples in the same range; see Sequence::FindQuietRuns
+   void FindQuietRuns(sampleCount start, sampleCount len, double level,
+                      sampleCount minLength, SampleRuns &runs,
+                      bool mayThrow = true) const;
+   // Adds to powers[ii] the power of the clip's samples in hop firstHop + ii
+   // of the track, hops being hopSize samples from the track's start, after
+   // a filter made by weighting, which starts at rest at the clip's start.
+   // If cache, the powers of the whole clip are found and kept until it
+   // changes or another weighting is given.  progress is given the count of
+   // samples read, and stops this if it returns false.
+   bool AddLoudnessPowers(size_t hopSize, sampleCount firstHop, size_t nHops,
+                          double *powers,
+                          LoudnessWeightingFactory weighting,
+                          bool cache,
+                          const std::function<bool(sampleCount)> &progress,
+                          bool mayThrow = true) const;
    void SetSamples(samplePtr buffer, sampleFormat format,
                    sampleCount start, size_t len);
 
@@ -264,6 +299,10 @@ public:
                        const sampleCount *& where,
                        size_t numPixels,
                        double t0, double pixelsPerSecond) const;
+   // Counts since the last reset; clips on any thread may add to them
+   static WaveClipCacheStatistics GetCacheStatistics();
+   static void ResetCacheStatistics();
+
    std::pair<float, float> GetMinMax(
       double t0, double t1, bool mayThrow = true) const;
    float GetRMS(double t0, double t1, bool mayThrow = true) const;
@@ -378,8 +417,18 @@ protected:
    std::unique_ptr<Envelope> mEnvelope;
 
    mutable std::unique_ptr<WaveCache> mWaveCache;
+   // Caches displaced from mWaveCache by scrolling or zooming, most recent
+   // first.  Their columns are copied, or aggregated when the zoom ratio is
+   // an integer multiple, before any audio is fetched again.
+   static constexpr size_t WaveCacheRingSize = 4;
+   mutable std::array<std::unique_ptr<WaveCache>, WaveCacheRingSize>
+      mWaveCacheRing;
    mutable ODLock       mWaveCacheMutex {};
    mutable std::unique_ptr<SpecCache> mSpecCache;
+   // Shared with copies of the clip, which have the same samples
+   mutable std::shared_ptr<const LoudnessPowers> mLoudnessPowers;
+   mutable int          mLoudnessDirty { -1 };
+   mutable ODLock       mLoudnessMutex {};
    SampleBuffer  mAppendBuffer {};
    size_t        mAppendBufferLen { 0 };
 
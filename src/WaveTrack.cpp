@@ -1856,6 +1856,123 @@ float WaveTrack::GetRMS(double t0, double t1, bool mayThrow) const
    return length > 0 ? sqrt(sumsq / length.as_double()) : 0.0;
 }
 
+double WaveTrack::GetSum(sampleCount start, size_t len,
+                         bool mayThrow, sampleCount * pNumWithinClips) const
+{
+   double sum = 0.0;
+   sampleCount samplesSummed = 0;
+
+   // Iterate the clips.  They are not necessarily sorted by time.
+   for (const auto &clip: mClips)
+   {
+      auto clipStart = clip->GetStartSample();
+      auto clipEnd = clip->GetEndSample();
+
+      if (clipEnd > start && clipStart < start+len)
+      {
+         // Clip sample region and requested region overlap, as in Get()
+         auto samplesToSum =
+            std::min( start+len - clipStart, clip->GetNumSamples() );
+         decltype(samplesToSum) inclipDelta = 0;
+         if (clipStart < start)
+         {
+            inclipDelta = start - clipStart;
+            samplesToSum -= inclipDelta;
+         }
+
+         sum += clip->GetSampleSum(
+            inclipDelta, samplesToSum.as_size_t(), mayThrow);
+         samplesSummed += samplesToSum;
+      }
+   }
+   if( pNumWithinClips )
+      *pNumWithinClips = samplesSummed;
+   return sum;
+}
+
+bool WaveTrack::AddLoudnessPowers(size_t hopSize, sampleCount firstHop,
+   size_t nHops, double *powers, LoudnessWeightingFactory weighting,
+   const std::function<bool(sampleCount)> &progress, bool mayThrow) const
+{
+   const auto start = firstHop * hopSize;
+   const auto end = (firstHop + nHops) * hopSize;
+   sampleCount done = 0;
+
+   // Iterate the clips.  They are not necessarily sorted by time.
+   for (const auto &clip: mClips)
+   {
+      auto clipStart = clip->GetStartSample();
+      auto clipEnd = clip->GetEndSample();
+
+      if (clipEnd > start && clipStart < end)
+      {
+         // The clip is weighted from its start, and weighting all of it
+         // costs little more than most of it
+         const auto read = std::min(clipEnd, end) - clipStart;
+         const bool cache = read * 2 >= clipEnd - clipStart;
+         sampleCount clipDone = 0;
+         if (!clip->AddLoudnessPowers(hopSize, firstHop, nHops, powers,
+               weighting, cache,
+               [&](sampleCount count) {
+                  clipDone = count;
+                  return progress(done + clipDone);
+               }, mayThrow))
+            return false;
+         done += clipDone;
+      }
+   }
+   return true;
+}
+
+SampleRuns WaveTrack::FindQuietRuns(sampleCount start, sampleCount end,
+   double level, sampleCount minLength, bool mayThrow) const
+{
+   // Find runs in clips and gaps in order of time, joining those that meet
+   SampleRuns found;
+   const auto add = [&](sampleCount s0, sampleCount s1) {
+      if (!found.empty() && found.back().second == s0)
+         found.back().second = s1;
+      else
+         found.push_back({ s0, s1 });
+   };
+   // Zeroes are quiet unless level is not positive
+   const bool gapsQuiet = level > 0;
+
+   auto pos = start;
+   SampleRuns clipRuns;
+   for (const auto clip : SortedClipArray()) {
+      auto clipStart = clip->GetStartSample();
+      auto clipEnd = clip->GetEndSample();
+      if (clipEnd <= pos)
+         continue;
+      if (clipStart >= end)
+         break;
+
+      if (clipStart > pos) {
+         if (gapsQuiet)
+            add(pos, clipStart);
+         pos = clipStart;
+      }
+      const auto s1 = std::min(end, clipEnd);
+      clipRuns.clear();
+      clip->FindQuietRuns(pos - clipStart, s1 - pos, level, minLength,
+         clipRuns, mayThrow);
+      for (const auto &run : clipRuns)
+         add(run.first + clipStart, run.second + clipStart);
+      pos = s1;
+   }
+   if (pos < end && gapsQuiet)
+      add(pos, end);
+
+   // Runs found in a clip may be short where they touch its ends
+   SampleRuns runs;
+   for (const auto &run : found)
+      if (run.second - run.first >= minLength ||
+          run.first == start || run.second == end)
+         runs.push_back(run);
+   return runs;
+}
+
 bool WaveTrack::Get(samplePtr buffer, sampleFormat format,
                     sampleCount start, size_t len, fillFormat fill,
                     bool mayThrow, sampleCount * pNumWithinClips) const
@@ -13,6 +13,7 @@
 
 #include "Track.h"
 
+#include <functional>
 #include <vector>
 #include <wx/longlong.h>
 
@@ -260,6 +261,29 @@ private:
    // May assume precondition: t0 <= t1
    float GetRMS(double t0, double t1, bool mayThrow = true) const;
 
+   // Sum of the samples in the range that Get would copy from within clips,
+   // using the sums of whole blocks when they are known
+   double GetSum(sampleCount start, size_t len,
+      bool mayThrow = true,
+      sampleCount * pNumWithinClips = nullptr) const;
+
+   // Runs of samples between start and end whose absolute values are all
+   // less than level, omitting those shorter than minLength that don't
+   // touch start or end.  Space between clips counts as zeroes.  Block
+   // summaries spare most reading of samples.
+   SampleRuns FindQuietRuns(sampleCount start, sampleCount end, double level,
+      sampleCount minLength, bool mayThrow = true) const;
+
+   // Adds to powers[ii] the weighted power of the samples in hop
+   // firstHop + ii, where hops are hopSize samples from the start of the
+   // track; see WaveClip::AddLoudnessPowers.  Clips mostly read keep their
+   // powers for later measurements.  progress is given the count
+   // of samples read, and stops this if it returns false.
+   bool AddLoudnessPowers(size_t hopSize, sampleCount firstHop, size_t nHops,
+      double *powers, LoudnessWeightingFactory weighting,
+      const std::function<bool(sampleCount)> &progress,
+      bool mayThrow = true) const;
+
    //
    // MM: We now have more than one sequence and envelope per track, so
    // instead of GetSequence() and GetEnvelope() we have the following
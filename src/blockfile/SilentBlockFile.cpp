@@ -21,6 +21,7 @@ BlockFile{ wxFileNameWrapper{}, sampleLen }
    mMin = 0.;
    mMax = 0.;
    mRMS = 0.;
+   mSum = 0.;
 }
 
 SilentBlockFile::~SilentBlockFile()
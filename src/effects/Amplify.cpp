@@ -132,6 +132,26 @@ size_t EffectAmplify::ProcessBlock(float **inBlock, float **outBlock, size_t blo
 
    return blockLen;
 }
+
+bool EffectAmplify::RealtimeInitialize()
+{
+   return true;
+}
+
+bool EffectAmplify::RealtimeFinalize()
+{
+   return true;
+}
+
+size_t EffectAmplify::RealtimeProcess(int WXUNUSED(group),
+                                      float **inbuf,
+                                      float **outbuf,
+                                      size_t numSamples)
+{
+   // No state to keep per processor
+   return ProcessBlock(inbuf, outbuf, numSamples);
+}
+
 bool EffectAmplify::DefineParams( ShuttleParams & S ){
    S.SHUTTLE_PARAM( mRatio, Ratio );
    if (!IsBatchProcessing())
@@ -184,6 +204,32 @@ bool EffectAmplify::LoadFactoryDefaults()
 
 // Effect implementation
 
+bool EffectAmplify::SupportsParallelProcessing()
+{
+   return true;
+}
+
+bool EffectAmplify::SupportsChaining()
+{
+   return true;
+}
+
+bool EffectAmplify::SupportsSegmentedProcessing(
+   double WXUNUSED(sampleRate), size_t &warmUp)
+{
+   warmUp = 0;
+   return true;
+}
+
+bool EffectAmplify::ResetParallelProcessor(int WXUNUSED(group),
+   unsigned WXUNUSED(numChannels), ChannelNames WXUNUSED(chanMap),
+   float WXUNUSED(sampleRate),
+   sampleCount WXUNUSED(start), sampleCount WXUNUSED(len))
+{
+   // No state to keep per processor
+   return true;
+}
+
 bool EffectAmplify::Init()
 {
    mPeak = 0.0;
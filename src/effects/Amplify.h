@@ -46,6 +46,12 @@ public:
    unsigned GetAudioInCount() override;
    unsigned GetAudioOutCount() override;
    size_t ProcessBlock(float **inBlock, float **outBlock, size_t blockLen) override;
+   bool RealtimeInitialize() override;
+   bool RealtimeFinalize() override;
+   size_t RealtimeProcess(int group,
+                               float **inbuf,
+                               float **outbuf,
+                               size_t numSamples) override;
    bool DefineParams( ShuttleParams & S ) override;
    bool GetAutomationParameters(CommandParameters & parms) override;
    bool SetAutomationParameters(CommandParameters & parms) override;
@@ -53,6 +59,12 @@ public:
 
    // Effect implementation
 
+   bool SupportsParallelProcessing() override;
+   bool SupportsSegmentedProcessing(double sampleRate, size_t &warmUp) override;
+   bool ResetParallelProcessor(int group, unsigned numChannels,
+      ChannelNames chanMap, float sampleRate,
+      sampleCount start, sampleCount len) override;
+   bool SupportsChaining() override;
    bool Init() override;
    void Preview(bool dryOnly) override;
    void PopulateOrExchange(ShuttleGui & S) override;
@@ -11,15 +11,13 @@
 \class EffectAutoDuck
 \brief Implements the Auto Ducking effect
 
-\class AutoDuckRegion
-\brief a struct that holds a start and end time.
-
 *******************************************************************/
 
 #include "../Audacity.h"
 #include "AutoDuck.h"
 #include "LoadEffects.h"
 
+#include <algorithm>
 #include <math.h>
 #include <float.h>
 
@@ -55,22 +53,6 @@ Param( MaximumPause,       double,  wxT("MaximumPause"),     1.0,     0.0,     D
 static const size_t kBufSize = 131072u;     // number of samples to process at once
 static const size_t kRMSWindowSize = 100u;  // samples in circular RMS window buffer
 
-/*
- * A auto duck region and an array of auto duck regions
- */
-
-struct AutoDuckRegion
-{
-   AutoDuckRegion(double t0, double t1)
-   {
-      this->t0 = t0;
-      this->t1 = t1;
-   }
-
-   double t0;
-   double t1;
-};
-
 /*
  * Effect implementation
  */
@@ -296,14 +278,27 @@ bool EffectAutoDuck::Process()
 
    double threshold = DB_TO_LINEAR(mThresholdDb);
 
+   // Where every sample of the window is below this level, the threshold
+   // can't be exceeded, and block summaries find such runs without reading
+   // the samples
+   const double quietLevel = threshold;
+
    // adjust the threshold so we can compare it to the rmsSum value
    threshold = threshold * threshold * kRMSWindowSize;
 
+   // Duck the tracks as soon as each region is found, in the same pass as
+   // the analysis; regions never overlap, because the pause is at least
+   // as long as the two outer fades
+   CopyInputTracks(); // Set up mOutputTracks.
+   const auto duck = [&](double t0, double t1, double progress) {
+      for( auto iterTrack : mOutputTracks->Selected< WaveTrack >() )
+         if (ApplyDuckFade(iterTrack, t0, t1, progress))
+            return true;
+      return false;
+   };
+
    int rmsPos = 0;
    float rmsSum = 0;
-   // to make the progress bar appear more natural, we first look for all
-   // duck regions and apply them all at once afterwards
-   std::vector<AutoDuckRegion> regions;
    bool inDuckRegion = false;
    {
       Floats rmsWindow{ kRMSWindowSize, true };
@@ -316,66 +311,138 @@ bool EffectAutoDuck::Process()
 
       auto pos = start;
 
-      while (pos < end)
-      {
-         const auto len = limitSampleBufferSize( kBufSize, end - pos );
-         
-         mControlTrack->Get((samplePtr)buf.get(), floatSample, pos, len);
+      // Ends a region where the maximum pause has been exceeded at i
+      const auto endRegion = [&](sampleCount i) {
+         // do the actual duck fade and reset all values
+         double duckRegionEnd =
+            mControlTrack->LongSamplesToTime(i - curSamplesPause);
+
+         inDuckRegion = false;
 
-         for (auto i = pos; i < pos + len; i++)
+         return duck(duckRegionStart - mOuterFadeDownLen,
+            duckRegionEnd + mOuterFadeUpLen,
+            (i - start).as_double() / (end - start).as_double());
+      };
+
+      // Examines each sample in [from, to)
+      const auto analyze = [&](sampleCount from, sampleCount to) {
+         while (from < to)
          {
-            rmsSum -= rmsWindow[rmsPos];
-            // i - pos is bounded by len:
-            auto index = ( i - pos ).as_size_t();
-            rmsWindow[rmsPos] = buf[ index ] * buf[ index ];
-            rmsSum += rmsWindow[rmsPos];
-            rmsPos = (rmsPos + 1) % kRMSWindowSize;
+            const auto len = limitSampleBufferSize( kBufSize, to - from );
 
-            bool thresholdExceeded = rmsSum > threshold;
+            mControlTrack->Get((samplePtr)buf.get(), floatSample, from, len);
 
-            if (thresholdExceeded)
+            for (auto i = from; i < from + len; i++)
             {
-               // everytime the threshold is exceeded, reset our count for
-               // the number of pause samples
-               curSamplesPause = 0;
+               rmsSum -= rmsWindow[rmsPos];
+               // i - from is bounded by len:
+               auto index = ( i - from ).as_size_t();
+               rmsWindow[rmsPos] = buf[ index ] * buf[ index ];
+               rmsSum += rmsWindow[rmsPos];
+               rmsPos = (rmsPos + 1) % kRMSWindowSize;
+
+               bool thresholdExceeded = rmsSum > threshold;
 
-               if (!inDuckRegion)
+               if (thresholdExceeded)
                {
-                  // the threshold has been exceeded for the first time, so
-                  // let the duck region begin here
-                  inDuckRegion = true;
-                  duckRegionStart = mControlTrack->LongSamplesToTime(i);
+                  // everytime the threshold is exceeded, reset our count for
+                  // the number of pause samples
+                  curSamplesPause = 0;
+
+                  if (!inDuckRegion)
+                  {
+                     // the threshold has been exceeded for the first time, so
+                     // let the duck region begin here
+                     inDuckRegion = true;
+                     duckRegionStart = mControlTrack->LongSamplesToTime(i);
+                  }
+               }
+
+               if (!thresholdExceeded && inDuckRegion)
+               {
+                  // the threshold has not been exceeded and we are in a duck
+                  // region, but only fade in if the maximum pause has been
+                  // exceeded
+                  curSamplesPause += 1;
+
+                  if (curSamplesPause >= minSamplesPause && endRegion(i))
+                     return false;
                }
             }
 
-            if (!thresholdExceeded && inDuckRegion)
+            from += len;
+         }
+         return true;
+      };
+
+      // Passes over [from, to), known to be below the threshold throughout,
+      // as analyze() would
+      const auto skip = [&](sampleCount from, sampleCount to) {
+         if (inDuckRegion && minSamplesPause == 0)
+         {
+            // analyze() ends the region at the first quiet sample, having
+            // counted a pause of one sample
+            curSamplesPause = 1;
+            if (endRegion(from))
+               return false;
+         }
+         else if (inDuckRegion)
+         {
+            // curSamplesPause is less than minSamplesPause, or the region
+            // would have ended
+            const auto needed = minSamplesPause - curSamplesPause;
+            if (needed <= to - from)
             {
-               // the threshold has not been exceeded and we are in a duck
-               // region, but only fade in if the maximum pause has been
-               // exceeded
-               curSamplesPause += 1;
+               curSamplesPause = minSamplesPause;
+               if (endRegion(from + needed - 1))
+                  return false;
+            }
+            else
+               curSamplesPause += to - from;
+         }
 
-               if (curSamplesPause >= minSamplesPause)
-               {
-                  // do the actual duck fade and reset all values
-                  double duckRegionEnd =
-                     mControlTrack->LongSamplesToTime(i - curSamplesPause);
+         // The window now holds only quiet samples, and refilling it from
+         // zero after the skip keeps it so
+         std::fill(rmsWindow.get(), rmsWindow.get() + kRMSWindowSize, 0.0f);
+         rmsSum = 0;
+         rmsPos = 0;
+         return true;
+      };
 
-                  regions.push_back(AutoDuckRegion(
-                     duckRegionStart - mOuterFadeDownLen,
-                     duckRegionEnd + mOuterFadeUpLen));
+      while (pos < end)
+      {
+         const auto len = limitSampleBufferSize( kBufSize, end - pos );
 
-                  inDuckRegion = false;
-               }
+         // Runs of quiet samples are skipped, but for a window's length at
+         // each end, where the window may still hold louder samples, or
+         // needs to be filled again
+         const auto runs = mControlTrack->FindQuietRuns(pos, pos + len,
+            quietLevel, 4 * kRMSWindowSize);
+         auto next = pos;
+         for (const auto &run : runs)
+         {
+            const auto skipStart = run.first + kRMSWindowSize;
+            const auto skipEnd = run.second - kRMSWindowSize;
+            if (skipEnd <= skipStart)
+               continue;
+            if (!analyze(next, skipStart) || !skip(skipStart, skipEnd))
+            {
+               cancel = true;
+               break;
             }
+            next = skipEnd;
+         }
+         if (cancel || !analyze(next, pos + len))
+         {
+            cancel = true;
+            break;
          }
 
          pos += len;
 
          if (TotalProgress(
             (pos - start).as_double() /
-            (end - start).as_double() /
-            (GetNumWaveTracks() + 1)
+            (end - start).as_double()
          ))
          {
             cancel = true;
@@ -384,38 +451,12 @@ bool EffectAutoDuck::Process()
       }
 
       // apply last duck fade, if any
-      if (inDuckRegion)
+      if (!cancel && inDuckRegion)
       {
          double duckRegionEnd =
             mControlTrack->LongSamplesToTime(end - curSamplesPause);
-         regions.push_back(AutoDuckRegion(
-            duckRegionStart - mOuterFadeDownLen,
-            duckRegionEnd + mOuterFadeUpLen));
-      }
-   }
-
-   if (!cancel)
-   {
-      CopyInputTracks(); // Set up mOutputTracks.
-
-      int trackNum = 0;
-
-      for( auto iterTrack : mOutputTracks->Selected< WaveTrack >() )
-      {
-         for (size_t i = 0; i < regions.size(); i++)
-         {
-            const AutoDuckRegion& region = regions[i];
-            if (ApplyDuckFade(trackNum, iterTrack, region.t0, region.t1))
-            {
-               cancel = true;
-               break;
-            }
-         }
-
-         if (cancel)
-            break;
-
-         trackNum++;
+         cancel = duck(duckRegionStart - mOuterFadeDownLen,
+            duckRegionEnd + mOuterFadeUpLen, 1.0);
       }
    }
 
@@ -530,8 +571,8 @@ bool EffectAutoDuck::TransferDataFromWindow()
 // EffectAutoDuck implementation
 
 // this currently does an exponential fade
-bool EffectAutoDuck::ApplyDuckFade(int trackNum, WaveTrack* t,
-                                   double t0, double t1)
+bool EffectAutoDuck::ApplyDuckFade(WaveTrack* t,
+                                   double t0, double t1, double progress)
 {
    bool cancel = false;
 
@@ -581,10 +622,7 @@ bool EffectAutoDuck::ApplyDuckFade(int trackNum, WaveTrack* t,
 
       pos += len;
 
-      float curTime = t->LongSamplesToTime(pos);
-      float fractionFinished = (curTime - mT0) / (mT1 - mT0);
-      if (TotalProgress( (trackNum + 1 + fractionFinished) /
-                         (GetNumWaveTracks() + 1) ))
+      if (TotalProgress(progress))
       {
          cancel = true;
          break;
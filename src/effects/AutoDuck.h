@@ -57,7 +57,8 @@ public:
 private:
    // EffectAutoDuck implementation
 
-   bool ApplyDuckFade(int trackNum, WaveTrack *t, double t0, double t1);
+   // Returns true if the user cancelled; progress is of the whole effect
+   bool ApplyDuckFade(WaveTrack *t, double t0, double t1, double progress);
 
    void OnValueChanged(wxCommandEvent & evt);
 
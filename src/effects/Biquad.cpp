@@ -11,11 +11,28 @@ Max Maisel
 
 #include "Biquad.h"
 #include "Audacity.h"
+#include <algorithm>
 #include <cmath>
 
 #define square(a) ((a)*(a))
 #define PI M_PI
 
+namespace {
+
+/// Samples taken through all sections of a cascade before the next ones
+const size_t CascadeChunk = 256;
+/// Channels whose recurrences ProcessChannels() interleaves
+const size_t MaxLanes = 8;
+
+/// Zeroes feedback too small to matter, before it decays into denormal
+/// numbers, which are very slow to compute with on many processors
+inline double FlushDenormal(double fValue)
+{
+   return std::fabs(fValue) < 1e-30 ? 0 : fValue;
+}
+
+}
+
 Biquad::Biquad()
 {
    fNumerCoeffs[B0] = 1;
@@ -34,10 +51,129 @@ void Biquad::Reset()
    fPrevPrevOut = 0;
 }
 
-void Biquad::Process(float* pfIn, float* pfOut, int iNumSamples)
+void Biquad::Process(const float* pfIn, float* pfOut, size_t iNumSamples)
+{
+   // Like ProcessOne(), but with coefficients and state in locals, so
+   // the compiler may keep them in registers; tiny feedback state is
+   // flushed at the end
+   const double b0 = fNumerCoeffs[B0];
+   const double b1 = fNumerCoeffs[B1];
+   const double b2 = fNumerCoeffs[B2];
+   const double a1 = fDenomCoeffs[A1];
+   const double a2 = fDenomCoeffs[A2];
+   double prevIn = fPrevIn;
+   double prevPrevIn = fPrevPrevIn;
+   double prevOut = fPrevOut;
+   double prevPrevOut = fPrevPrevOut;
+   for (size_t i = 0; i < iNumSamples; i++)
+   {
+      const float fIn = pfIn[i];
+      const double fOut = double(fIn) * b0 +
+            prevIn * b1 +
+            prevPrevIn * b2 -
+            prevOut * a1 -
+            prevPrevOut * a2;
+      prevPrevIn = prevIn;
+      prevIn = fIn;
+      prevPrevOut = prevOut;
+      prevOut = fOut;
+      pfOut[i] = fOut;
+   }
+   fPrevIn = prevIn;
+   fPrevPrevIn = prevPrevIn;
+   fPrevOut = FlushDenormal(prevOut);
+   fPrevPrevOut = FlushDenormal(prevPrevOut);
+}
+
+void Biquad::ProcessCascade(Biquad* pBiquads, size_t nBiquads,
+   const float* pfIn, float* pfOut, size_t iNumSamples)
+{
+   if (nBiquads == 0)
+   {
+      if (pfIn != pfOut)
+         std::copy(pfIn, pfIn + iNumSamples, pfOut);
+      return;
+   }
+
+   // Take a short run of samples through every section while it is still
+   // in the cache
+   for (size_t start = 0; start < iNumSamples; start += CascadeChunk)
+   {
+      const auto len = std::min(CascadeChunk, iNumSamples - start);
+      pBiquads[0].Process(pfIn + start, pfOut + start, len);
+      for (size_t iBiquad = 1; iBiquad < nBiquads; iBiquad++)
+         pBiquads[iBiquad].Process(pfOut + start, pfOut + start, len);
+   }
+}
+
+void Biquad::ProcessChannels(Biquad* const* ppCascades, size_t nBiquads,
+   const float* const* ppfIn, float* const* ppfOut,
+   size_t nChannels, size_t iNumSamples)
 {
-   for (int i = 0; i < iNumSamples; i++)
-      *pfOut++ = ProcessOne(*pfIn++);
+   for (size_t first = 0; first < nChannels; first += MaxLanes)
+   {
+      const auto nLanes = std::min(MaxLanes, nChannels - first);
+
+      if (nBiquads == 0)
+         for (size_t lane = 0; lane < nLanes; lane++)
+            if (ppfIn[first + lane] != ppfOut[first + lane])
+               std::copy(ppfIn[first + lane],
+                  ppfIn[first + lane] + iNumSamples, ppfOut[first + lane]);
+
+      for (size_t iBiquad = 0; iBiquad < nBiquads; iBiquad++)
+      {
+         // Gather one section of each channel into lanes.  The channels
+         // don't depend on each other, so one sample of all of them is
+         // computed before the next, and their multiplications overlap
+         // instead of each waiting for the previous output.
+         double b0[MaxLanes], b1[MaxLanes], b2[MaxLanes];
+         double a1[MaxLanes], a2[MaxLanes];
+         double prevIn[MaxLanes], prevPrevIn[MaxLanes];
+         double prevOut[MaxLanes], prevPrevOut[MaxLanes];
+         const float* pfIn[MaxLanes];
+         float* pfOut[MaxLanes];
+         for (size_t lane = 0; lane < nLanes; lane++)
+         {
+            const Biquad& biquad = ppCascades[first + lane][iBiquad];
+            b0[lane] = biquad.fNumerCoeffs[B0];
+            b1[lane] = biquad.fNumerCoeffs[B1];
+            b2[lane] = biquad.fNumerCoeffs[B2];
+            a1[lane] = biquad.fDenomCoeffs[A1];
+            a2[lane] = biquad.fDenomCoeffs[A2];
+            prevIn[lane] = biquad.fPrevIn;
+            prevPrevIn[lane] = biquad.fPrevPrevIn;
+            prevOut[lane] = biquad.fPrevOut;
+            prevPrevOut[lane] = biquad.fPrevPrevOut;
+            pfIn[lane] = iBiquad == 0 ? ppfIn[first + lane] : ppfOut[first + lane];
+            pfOut[lane] = ppfOut[first + lane];
+         }
+
+         for (size_t i = 0; i < iNumSamples; i++)
+            for (size_t lane = 0; lane < nLanes; lane++)
+            {
+               const float fIn = pfIn[lane][i];
+               const double fOut = double(fIn) * b0[lane] +
+                     prevIn[lane] * b1[lane] +
+                     prevPrevIn[lane] * b2[lane] -
+                     prevOut[lane] * a1[lane] -
+                     prevPrevOut[lane] * a2[lane];
+               prevPrevIn[lane] = prevIn[lane];
+               prevIn[lane] = fIn;
+               prevPrevOut[lane] = prevOut[lane];
+               prevOut[lane] = fOut;
+               pfOut[lane][i] = fOut;
+            }
+
+         for (size_t lane = 0; lane < nLanes; lane++)
+         {
+            Biquad& biquad = ppCascades[first + lane][iBiquad];
+            biquad.fPrevIn = prevIn[lane];
+            biquad.fPrevPrevIn = prevPrevIn[lane];
+            biquad.fPrevOut = FlushDenormal(prevOut[lane]);
+            biquad.fPrevPrevOut = FlushDenormal(prevPrevOut[lane]);
+         }
+      }
+   }
 }
 
 const double Biquad::s_fChebyCoeffs[MAX_Order][MAX_Order + 1] =
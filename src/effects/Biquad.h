@@ -19,7 +19,16 @@ struct Biquad
 {
    Biquad();
    void Reset();
-   void Process(float* pfIn, float* pfOut, int iNumSamples);
+   void Process(const float* pfIn, float* pfOut, size_t iNumSamples);
+
+   /// Passes samples through biquads in series; pfIn may equal pfOut
+   static void ProcessCascade(Biquad* pBiquads, size_t nBiquads,
+      const float* pfIn, float* pfOut, size_t iNumSamples);
+   /// Passes several channels at once, each through its own series of
+   /// nBiquads biquads, so that their recurrences overlap
+   static void ProcessChannels(Biquad* const* ppCascades, size_t nBiquads,
+      const float* const* ppfIn, float* const* ppfOut,
+      size_t nChannels, size_t iNumSamples);
 
    enum
    {
@@ -489,54 +489,21 @@ bool EffectChangeSpeed::ProcessOne(WaveTrack * track,
    //to make it a double now than it is to do it later
    auto len = (end - start).as_double();
 
-   // Initiate processing buffers, most likely shorter than
-   // the length of the selection being processed.
-   auto inBufferSize = track->GetMaxBlockSize();
-
-   Floats inBuffer{ inBufferSize };
-
-   // mFactor is at most 100-fold so this shouldn't overflow size_t
-   auto outBufferSize = size_t( mFactor * inBufferSize + 10 );
-   Floats outBuffer{ outBufferSize };
-
-   // Set up the resampling stuff for this track.
-   Resample resample(true, mFactor, mFactor); // constant rate resampling
-
-   //Go through the track one buffer at a time. samplePos counts which
-   //sample the current buffer starts at.
-   bool bResult = true;
-   auto samplePos = start;
-   while (samplePos < end) {
-      //Get a blockSize of samples (smaller than the size of the buffer)
-      auto blockSize = limitSampleBufferSize(
-         track->GetBestBlockSize(samplePos),
-         end - samplePos
-      );
-
-      //Get the samples from the track and put them in the buffer
-      track->Get((samplePtr) inBuffer.get(), floatSample, samplePos, blockSize);
-
-      const auto results = resample.Process(mFactor,
-                                    inBuffer.get(),
-                                    blockSize,
-                                    ((samplePos + blockSize) >= end),
-                                    outBuffer.get(),
-                                    outBufferSize);
-      const auto outgen = results.second;
-
-      if (outgen > 0)
-         outputTrack->Append((samplePtr)outBuffer.get(), floatSample,
-                             outgen);
-
-      // Increment samplePos
-      samplePos += results.first;
-
-      // Update the Progress meter
-      if (TrackProgress(mCurTrackNum, (samplePos - start).as_double() / len)) {
-         bResult = false;
-         break;
-      }
-   }
+   //Resample the selection, in segments on several threads when
+   //mFactor allows it, appending the output in order.  The output
+   //includes the resampler's tail, so its length is that of the
+   //selection times mFactor.
+   bool bResult = Resample::ProcessConstantRate(mFactor, end - start,
+      [&](float *buffer, sampleCount pos, size_t count) {
+         track->Get((samplePtr) buffer, floatSample, start + pos, count);
+      },
+      [&](const float *buffer, size_t count) {
+         outputTrack->Append((samplePtr)buffer, floatSample, count);
+      },
+      [&](sampleCount done) {
+         // Update the Progress meter
+         return !TrackProgress(mCurTrackNum, done.as_double() / len);
+      });
 
    // Flush the output WaveTrack (since it's buffered, too)
    outputTrack->Flush();
@@ -28,6 +28,7 @@
 #include "ClickRemoval.h"
 #include "LoadEffects.h"
 
+#include <algorithm>
 #include <math.h>
 
 #include <wx/intl.h>
@@ -265,6 +266,22 @@ bool EffectClickRemoval::ProcessOne(int count, WaveTrack * track, sampleCount st
    return bResult;
 }
 
+// Positions whose window sums are found at once
+static const size_t WindowSumsChunk = 256;
+
+// Sums ww values from each of len positions of b2.  Each sum is taken in
+// the same order as one at a time, so results are the same, but the inner
+// loop runs over positions and the compiler can vectorize it.
+static void WindowSums(const float *b2, int ww, float *sums, size_t len)
+{
+   std::fill(sums, sums + len, 0.0f);
+   for (int j = 0; j < ww; j++) {
+      const float *row = b2 + j;
+      for (size_t k = 0; k < len; k++)
+         sums[k] += row[k];
+   }
+}
+
 bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
 {
    bool bResult = false; // This effect usually does nothing.
@@ -277,6 +294,7 @@ bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
    int s2 = sep/2;
    Floats ms_seq{ len };
    Floats b2{ len };
+   Floats sums{ WindowSumsChunk };
 
    for( i=0; i<len; i++)
       b2[i] = buffer[i]*buffer[i];
@@ -305,11 +323,15 @@ bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
    for(wrc=mClickWidth/4; wrc>=1; wrc /= 2) {
       ww = mClickWidth/wrc;
 
+      size_t chunkStart = 0;
+      size_t chunkEnd = 0;
       for( i=0; i<len-sep; i++ ){
-         msw = 0;
-         for( j=0; (int)j<ww; j++) {
-            msw += b2[i+s2+j];
+         if (i >= chunkEnd) {
+            chunkStart = i;
+            chunkEnd = std::min(len-sep, i + WindowSumsChunk);
+            WindowSums(&b2[i+s2], ww, sums.get(), chunkEnd - chunkStart);
          }
+         msw = sums[i - chunkStart];
          msw /= ww;
 
          if(msw >= mThresholdLevel * ms_seq[i]/10) {
@@ -326,6 +348,8 @@ bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
                   b2[j] = buffer[j]*buffer[j];
                }
                left=0;
+               // The sums ahead may include what was just repaired
+               chunkEnd = 0;
             } else if(left != 0) {
                left = 0;
             }
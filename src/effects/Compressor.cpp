@@ -28,7 +28,9 @@
 #include "Compressor.h"
 #include "LoadEffects.h"
 
+#include <limits>
 #include <math.h>
+#include <utility>
 
 #include <wx/brush.h>
 #include <wx/checkbox.h>
@@ -95,6 +97,7 @@ EffectCompressor::EffectCompressor()
    mNoiseFloor = 0.01;
    mCompression = 0.5;
    mFollowLen = 0;
+   mLatency = 0;
 
    SetLinearEffectFlag(false);
 }
@@ -127,7 +130,87 @@ EffectType EffectCompressor::GetType()
    return EffectTypeProcess;
 }
 
+bool EffectCompressor::SupportsRealtime()
+{
+#if defined(EXPERIMENTAL_REALTIME_AUDACITY_EFFECTS)
+   return true;
+#else
+   return false;
+#endif
+}
+
 // EffectClientInterface implementation
+
+unsigned EffectCompressor::GetAudioInCount()
+{
+   return 1;
+}
+
+unsigned EffectCompressor::GetAudioOutCount()
+{
+   return 1;
+}
+
+sampleCount EffectCompressor::GetLatency()
+{
+   return mLatency;
+}
+
+bool EffectCompressor::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelNames WXUNUSED(chanMap))
+{
+   // Offline, the lookahead can cover the whole attack, so that output
+   // follows the envelope of the two pass effect
+   InstanceInit(mMaster, mSampleRate, std::numeric_limits<size_t>::max());
+   mLatency = 0;
+
+   return true;
+}
+
+size_t EffectCompressor::ProcessBlock(float **inBlock, float **outBlock, size_t blockLen)
+{
+   // Only the first block delays the output, by the lookahead
+   mLatency = mMaster.count == 0 ? mMaster.lookahead : 0;
+
+   return InstanceProcess(mMaster, inBlock, outBlock, blockLen);
+}
+
+bool EffectCompressor::RealtimeInitialize()
+{
+   SetBlockSize(512);
+
+   mSlaves.clear();
+
+   return true;
+}
+
+bool EffectCompressor::RealtimeAddProcessor(unsigned WXUNUSED(numChannels), float sampleRate)
+{
+   EffectCompressorState slave;
+
+   // Nothing compensates for latency during playback, so look nowhere
+   // ahead: the output keeps time with the other tracks, and attacks begin
+   // when the level rises instead of before
+   InstanceInit(slave, sampleRate, 0);
+
+   mSlaves.push_back(std::move(slave));
+
+   return true;
+}
+
+bool EffectCompressor::RealtimeFinalize()
+{
+   mSlaves.clear();
+
+   return true;
+}
+
+size_t EffectCompressor::RealtimeProcess(int group,
+                                          float **inbuf,
+                                          float **outbuf,
+                                          size_t numSamples)
+{
+   return InstanceProcess(mSlaves[group], inbuf, outbuf, numSamples);
+}
 bool EffectCompressor::DefineParams( ShuttleParams & S ){
    S.SHUTTLE_PARAM( mThresholdDB, Threshold );
    S.SHUTTLE_PARAM( mNoiseFloorDB, NoiseFloor );
@@ -208,6 +291,21 @@ bool EffectCompressor::Startup()
    return true;
 }
 
+bool EffectCompressor::SupportsChaining()
+{
+   // Normalizing needs all of the compressed output first
+   return !mNormalize;
+}
+
+bool EffectCompressor::Process()
+{
+   if (mNormalize)
+      return EffectTwoPassSimpleMono::Process();
+
+   // Otherwise one pass of ProcessBlock calls compresses the tracks
+   return Effect::Process();
+}
+
 namespace {
 
 TranslatableString ThresholdFormat( int value )
@@ -394,6 +492,14 @@ bool EffectCompressor::TransferDataFromWindow()
 
 // EffectTwoPassSimpleMono implementation
 
+bool EffectCompressor::ProcessPass()
+{
+   if (mNormalize)
+      return EffectTwoPassSimpleMono::ProcessPass();
+
+   return Effect::ProcessPass();
+}
+
 bool EffectCompressor::NewTrackPass1()
 {
    mThreshold = DB_TO_LINEAR(mThresholdDB);
@@ -660,6 +766,145 @@ float EffectCompressor::DoCompression(float value, double env)
    return out;
 }
 
+void EffectCompressor::InstanceInit(EffectCompressorState & data, float sampleRate, size_t maxLookahead)
+{
+   data.sampleRate = sampleRate;
+
+   // After this many samples, the attack takes any level up to full scale
+   // down to the threshold, where it no longer matters.  The lookahead
+   // stays the same if the attack time changes during playback.
+   data.lookahead = std::min(maxLookahead,
+      size_t(ceil(sampleRate * mAttackTime + 0.5)));
+   data.attackPowers.reinit(data.lookahead + 1);
+
+   InstanceUpdate(data);
+
+   data.circleSize = 100;
+   data.circle.reinit(data.circleSize, true);
+   data.circlePos = 0;
+   data.rmsSum = 0.0;
+   data.noiseCounter = 100;
+   data.lastLevel = data.threshold;
+
+   data.input.reinit(data.lookahead + 1, true);
+   data.levels.reinit(data.lookahead + 1, true);
+   data.count = 0;
+   data.peaks.clear();
+}
+
+void EffectCompressor::InstanceUpdate(EffectCompressorState & data)
+{
+   data.thresholdDB = mThresholdDB;
+   data.noiseFloorDB = mNoiseFloorDB;
+   data.ratio = mRatio;
+   data.attackTime = mAttackTime;
+   data.decayTime = mDecayTime;
+   data.usePeak = mUsePeak;
+
+   const auto sampleRate = data.sampleRate;
+   data.threshold = DB_TO_LINEAR(mThresholdDB);
+   data.noiseFloor = DB_TO_LINEAR(mNoiseFloorDB);
+   data.compression = mRatio > 1 ? 1.0 - 1.0 / mRatio : 0.0;
+   data.attackInverseFactor =
+      exp(log(data.threshold) / (sampleRate * mAttackTime + 0.5));
+   data.decayFactor = exp(log(data.threshold) / (sampleRate * mDecayTime + 0.5));
+
+   data.attackPowers[0] = 1.0;
+   for (size_t i = 1; i <= data.lookahead; i++)
+      data.attackPowers[i] = data.attackPowers[i - 1] * data.attackInverseFactor;
+}
+
+size_t EffectCompressor::InstanceProcess(EffectCompressorState & data, float **inBlock, float **outBlock, size_t blockLen)
+{
+   const float *ibuf = inBlock[0];
+   float *obuf = outBlock[0];
+   const auto ringSize = data.lookahead + 1;
+
+   // The parameters may change during playback
+   if (mThresholdDB != data.thresholdDB ||
+       mNoiseFloorDB != data.noiseFloorDB ||
+       mRatio != data.ratio ||
+       mAttackTime != data.attackTime ||
+       mDecayTime != data.decayTime ||
+       mUsePeak != data.usePeak)
+      InstanceUpdate(data);
+
+   if (data.count == 0) {
+      // Start from the peak of the first block, as the two pass effect
+      // does, so that a loud beginning is not taken for an attack
+      for (size_t i = 0; i < blockLen; i++)
+         data.lastLevel = std::max<double>(data.lastLevel, fabs(ibuf[i]));
+   }
+
+   if (!data.usePeak) {
+      // Recompute the RMS sum to prevent accumulation of rounding errors
+      data.rmsSum = 0;
+      for (size_t i = 0; i < data.circleSize; i++)
+         data.rmsSum += data.circle[i];
+   }
+
+   for (size_t i = 0; i < blockLen; i++) {
+      const auto n = data.count++;
+      const float value = ibuf[i];
+
+      // Peak detect with the requested decay rate, as Follow() does
+      double level;
+      if (data.usePeak)
+         level = fabs(value);
+      else {
+         data.rmsSum -= data.circle[data.circlePos];
+         data.circle[data.circlePos] = value * value;
+         data.rmsSum += data.circle[data.circlePos];
+         level = sqrt(data.rmsSum / data.circleSize);
+         data.circlePos = (data.circlePos + 1) % data.circleSize;
+      }
+      if (level < data.noiseFloor)
+         data.noiseCounter++;
+      else
+         data.noiseCounter = 0;
+      auto last = data.lastLevel;
+      if (data.noiseCounter < 100) {
+         last *= data.decayFactor;
+         if (last < data.threshold)
+            last = data.threshold;
+         if (level > last)
+            last = level;
+      }
+      data.lastLevel = last;
+
+      // The envelope of the output sample lookahead samples back is the
+      // greatest of the levels since, each reduced by the attack for every
+      // sample that it lies ahead; Follow() gets the same in reverse
+      const auto target = n - std::min(n, data.lookahead);
+      while (!data.peaks.empty() && data.peaks.front() < target)
+         data.peaks.pop_front();
+      while (!data.peaks.empty() &&
+             data.levels[data.peaks.back() % ringSize] <=
+                last * data.attackPowers[n - data.peaks.back()])
+         data.peaks.pop_back();
+      data.peaks.push_back(n);
+      data.input[n % ringSize] = value;
+      data.levels[n % ringSize] = last;
+
+      if (n < data.lookahead) {
+         // This output is delayed, and the caller discards it
+         obuf[i] = 0;
+         continue;
+      }
+
+      const auto peak = data.peaks.front();
+      const auto env =
+         data.levels[peak % ringSize] * data.attackPowers[peak - target];
+      const auto input = data.input[target % ringSize];
+      if (data.usePeak)
+         obuf[i] = input * pow(1.0 / env, data.compression);
+      else
+         obuf[i] = input * pow(data.threshold / env, data.compression);
+   }
+
+   return blockLen;
+}
+
 void EffectCompressor::OnSlider(wxCommandEvent & WXUNUSED(evt))
 {
    TransferDataFromWindow();
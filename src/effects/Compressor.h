@@ -13,12 +13,56 @@
 
 #include "TwoPassSimpleMono.h"
 
+#include <deque>
+
 class wxCheckBox;
 class wxSlider;
 class wxStaticText;
 class EffectCompressorPanel;
 class ShuttleGui;
 
+// State of the compressor for one stream, processed in one pass with
+// bounded lookahead
+class EffectCompressorState
+{
+public:
+   // The parameters that the coefficients below were computed from
+   float sampleRate;
+   double thresholdDB;
+   double noiseFloorDB;
+   double ratio;
+   double attackTime;
+   double decayTime;
+
+   double threshold;
+   double noiseFloor;
+   double compression;
+   double attackInverseFactor;
+   double decayFactor;
+   bool usePeak;
+
+   // Output lags input by this many samples
+   size_t lookahead;
+   // attackInverseFactor raised to the powers 0 to lookahead
+   Doubles attackPowers;
+
+   double rmsSum;
+   size_t circleSize;
+   size_t circlePos;
+   Doubles circle;
+   int noiseCounter;
+   double lastLevel;
+
+   // The last lookahead + 1 input samples, and their levels with decay
+   // applied, indexed by sample count modulo lookahead + 1
+   Floats input;
+   Doubles levels;
+   size_t count;
+   // Counts of the samples whose levels may yet be the greatest, with
+   // attack applied, for some later output; oldest first
+   std::deque<size_t> peaks;
+};
+
 class EffectCompressor final : public EffectTwoPassSimpleMono
 {
 public:
@@ -36,9 +80,22 @@ public:
    // EffectDefinitionInterface implementation
 
    EffectType GetType() override;
+   bool SupportsRealtime() override;
 
    // EffectClientInterface implementation
 
+   unsigned GetAudioInCount() override;
+   unsigned GetAudioOutCount() override;
+   sampleCount GetLatency() override;
+   bool ProcessInitialize(sampleCount totalLen, ChannelNames chanMap = NULL) override;
+   size_t ProcessBlock(float **inBlock, float **outBlock, size_t blockLen) override;
+   bool RealtimeInitialize() override;
+   bool RealtimeAddProcessor(unsigned numChannels, float sampleRate) override;
+   bool RealtimeFinalize() override;
+   size_t RealtimeProcess(int group,
+                                       float **inbuf,
+                                       float **outbuf,
+                                       size_t numSamples) override;
    bool DefineParams( ShuttleParams & S ) override;
    bool GetAutomationParameters(CommandParameters & parms) override;
    bool SetAutomationParameters(CommandParameters & parms) override;
@@ -46,6 +103,8 @@ public:
    // Effect implementation
 
    bool Startup() override;
+   bool SupportsChaining() override;
+   bool Process() override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
@@ -53,6 +112,7 @@ public:
 protected:
    // EffectTwoPassSimpleMono implementation
 
+   bool ProcessPass() override;
    bool InitPass1() override;
    bool InitPass2() override;
    bool NewTrackPass1() override;
@@ -68,6 +128,10 @@ private:
    void Follow(float *buffer, float *env, size_t len, float *previous, size_t previous_len);
    float DoCompression(float x, double env);
 
+   void InstanceInit(EffectCompressorState & data, float sampleRate, size_t maxLookahead);
+   void InstanceUpdate(EffectCompressorState & data);
+   size_t InstanceProcess(EffectCompressorState & data, float **inBlock, float **outBlock, size_t blockLen);
+
    void OnSlider(wxCommandEvent & evt);
    void UpdateUI();
 
@@ -99,6 +163,10 @@ private:
 
    double    mMax;			//MJS
 
+   EffectCompressorState mMaster;
+   std::vector<EffectCompressorState> mSlaves;
+   sampleCount mLatency;
+
    EffectCompressorPanel *mPanel;
 
    wxStaticText *mThresholdLabel;
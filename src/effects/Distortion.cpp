@@ -90,9 +90,6 @@ Param( Param1,          double,  wxT("Parameter 1"),    50.0,    0.0,   100.0,
 Param( Param2,          double,  wxT("Parameter 2"),    50.0,    0.0,   100.0,                1    );
 Param( Repeats,         int,     wxT("Repeats"),        1,       0,       5,                  1    );
 
-// How many samples are processed before recomputing the lookup table again
-#define skipsamples 1000
-
 const double MIN_Threshold_Linear DB_TO_LINEAR(MIN_Threshold_dB);
 
 static const struct
@@ -235,6 +232,7 @@ unsigned EffectDistortion::GetAudioOutCount()
 
 bool EffectDistortion::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelNames WXUNUSED(chanMap))
 {
+   MakeTable();
    InstanceInit(mMaster, mSampleRate);
    return true;
 }
@@ -250,6 +248,10 @@ bool EffectDistortion::RealtimeInitialize()
 
    mSlaves.clear();
 
+   // All the processors share the table, made once here, and again only
+   // when the parameters change during playback
+   MakeTable();
+
    return true;
 }
 
@@ -359,6 +361,35 @@ bool EffectDistortion::LoadFactoryPreset(int id)
 
 // Effect implementation
 
+bool EffectDistortion::SupportsParallelProcessing()
+{
+   return true;
+}
+
+bool EffectDistortion::SupportsChaining()
+{
+   return true;
+}
+
+bool EffectDistortion::SupportsSegmentedProcessing(
+   double sampleRate, size_t &warmUp)
+{
+   // The wave shaper has no memory; the DC blocker averages over the
+   // queue length of DCFilter
+   warmUp = mParams.mDCBlock ? size_t(std::floor(sampleRate / 20.0)) : 0;
+   return true;
+}
+
+bool EffectDistortion::ResetParallelProcessor(int group,
+   unsigned WXUNUSED(numChannels), ChannelNames WXUNUSED(chanMap),
+   float sampleRate,
+   sampleCount WXUNUSED(start), sampleCount WXUNUSED(len))
+{
+   InstanceInit(mSlaves[group], sampleRate);
+
+   return true;
+}
+
 void EffectDistortion::PopulateOrExchange(ShuttleGui & S)
 {
    S.AddSpace(0, 5);
@@ -530,7 +561,6 @@ bool EffectDistortion::TransferDataFromWindow()
 void EffectDistortion::InstanceInit(EffectDistortionState & data, float sampleRate)
 {
    data.samplerate = sampleRate;
-   data.skipcount = 0;
    data.tablechoiceindx = mParams.mTableChoiceIndx;
    data.dcblock = mParams.mDCBlock;
    data.threshold = mParams.mThreshold_dB;
@@ -546,8 +576,6 @@ void EffectDistortion::InstanceInit(EffectDistortionState & data, float sampleRa
    while (!data.queuesamples.empty())
       data.queuesamples.pop();
 
-   MakeTable();
-
    return;
 }
 
@@ -570,57 +598,45 @@ size_t EffectDistortion::InstanceProcess(EffectDistortionState& data, float** in
    data.threshold = mParams.mThreshold_dB;
    data.noisefloor = mParams.mNoiseFloor;
    data.param1 = mParams.mParam1;
+   data.param2 = mParams.mParam2;
    data.repeats = mParams.mRepeats;
 
-   for (decltype(blockLen) i = 0; i < blockLen; i++) {
-      if (update && ((data.skipcount++) % skipsamples == 0)) {
-         MakeTable();
-      }
+   // The table depends only on the parameters, so remake it once for the
+   // block when they change
+   if (update) {
+      MakeTable();
+   }
 
-      switch (mParams.mTableChoiceIndx)
-      {
-      case kHardClip:
-         // Param2 = make-up gain.
-         obuf[i] = WaveShaper(ibuf[i]) * ((1 - p2) + (mMakeupGain * p2));
-         break;
-      case kSoftClip:
-         // Param2 = make-up gain.
-         obuf[i] = WaveShaper(ibuf[i]) * ((1 - p2) + (mMakeupGain * p2));
-         break;
-      case kHalfSinCurve:
-         obuf[i] = WaveShaper(ibuf[i]) * p2;
-         break;
-      case kExpCurve:
-         obuf[i] = WaveShaper(ibuf[i]) * p2;
-         break;
-      case kLogCurve:
-         obuf[i] = WaveShaper(ibuf[i]) * p2;
-         break;
-      case kCubic:
-         obuf[i] = WaveShaper(ibuf[i]) * p2;
-         break;
-      case kEvenHarmonics:
-         obuf[i] = WaveShaper(ibuf[i]);
-         break;
-      case kSinCurve:
-         obuf[i] = WaveShaper(ibuf[i]) * p2;
-         break;
-      case kLeveller:
-         obuf[i] = WaveShaper(ibuf[i]);
-         break;
-      case kRectifier:
-         obuf[i] = WaveShaper(ibuf[i]);
-         break;
-      case kHardLimiter:
-         // Mix equivalent to LADSPA effect's "Wet / Residual" mix
-         obuf[i] = (WaveShaper(ibuf[i]) * (p1 - p2)) + (ibuf[i] * p2);
-         break;
-      default:
-         obuf[i] = WaveShaper(ibuf[i]);
-      }
-      if (mParams.mDCBlock) {
+   double gain = 1.0;
+   double residual = 0.0;
+   switch (mParams.mTableChoiceIndx)
+   {
+   case kHardClip:
+   case kSoftClip:
+      // Param2 = make-up gain.
+      gain = (1 - p2) + (mMakeupGain * p2);
+      break;
+   case kHalfSinCurve:
+   case kExpCurve:
+   case kLogCurve:
+   case kCubic:
+   case kSinCurve:
+      gain = p2;
+      break;
+   case kHardLimiter:
+      // Mix equivalent to LADSPA effect's "Wet / Residual" mix
+      gain = p1 - p2;
+      residual = p2;
+      break;
+   default:
+      break;
+   }
+
+   WaveShaper(ibuf, obuf, blockLen, gain, residual);
+
+   if (mParams.mDCBlock) {
+      for (decltype(blockLen) i = 0; i < blockLen; i++)
          obuf[i] = DCFilter(data, obuf[i]);
-      }
    }
 
    return blockLen;
@@ -1287,33 +1303,40 @@ void EffectDistortion::CopyHalfTable()
 }
 
 
-float EffectDistortion::WaveShaper(float sample)
+void EffectDistortion::WaveShaper(const float *in, float *out, size_t len,
+                                  double gain, double residual)
 {
-   float out;
-   int index;
-   double xOffset;
-   double amount = 1;
+   double preGain = 1;
 
    switch (mParams.mTableChoiceIndx)
    {
       // Do any pre-processing here
       case kHardClip:
          // Pre-gain
-         amount = mParams.mParam1 / 100.0;
-         sample *= 1+amount;
+         preGain = 1 + mParams.mParam1 / 100.0;
          break;
       default: break;
    }
 
-   index = std::floor(sample * STEPS) + STEPS;
-   index = wxMax<int>(wxMin<int>(index, 2 * STEPS - 1), 0);
-   xOffset = ((1 + sample) * STEPS) - index;
-   xOffset = wxMin<double>(wxMax<double>(xOffset, 0.0), 1.0);   // Clip at 0dB
+   // No branches in the loop, so that the compiler may vectorise the
+   // lookups.  in and out may be the same.
+   const double *table = mTable;
+   for (size_t i = 0; i < len; i++) {
+      const float dry = in[i];
+      float sample = dry;
+      sample *= preGain;
+
+      int index = std::floor(sample * STEPS) + STEPS;
+      index = std::max(std::min(index, 2 * STEPS - 1), 0);
+      double xOffset = ((1 + sample) * STEPS) - index;
+      xOffset = std::min(std::max(xOffset, 0.0), 1.0);   // Clip at 0dB
 
-   // linear interpolation: y = y0 + (y1-y0)*(x-x0)
-   out = mTable[index] + (mTable[index + 1] - mTable[index]) * xOffset;
+      // linear interpolation: y = y0 + (y1-y0)*(x-x0)
+      const float shaped =
+         table[index] + (table[index + 1] - table[index]) * xOffset;
 
-   return out;
+      out[i] = shaped * gain + dry * residual;
+   }
 }
 
 
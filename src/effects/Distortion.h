@@ -28,7 +28,6 @@ class EffectDistortionState
 {
 public:
    float       samplerate;
-   sampleCount skipcount;
    int         tablechoiceindx;
    bool        dcblock;
    double      threshold;
@@ -93,6 +92,12 @@ public:
 
    // Effect implementation
 
+   bool SupportsParallelProcessing() override;
+   bool SupportsSegmentedProcessing(double sampleRate, size_t &warmUp) override;
+   bool ResetParallelProcessor(int group, unsigned numChannels,
+      ChannelNames chanMap, float sampleRate,
+      sampleCount start, sampleCount len) override;
+   bool SupportsChaining() override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
@@ -136,7 +141,9 @@ private:
    void UpdateControlText(wxTextCtrl *textCtrl, wxString &string, bool enabled);
 
    void MakeTable();
-   float WaveShaper(float sample);
+   // out = gain * shaped input + residual * input, for len samples
+   void WaveShaper(const float *in, float *out, size_t len,
+                   double gain, double residual);
    float DCFilter(EffectDistortionState & data, float sample);
 
    // Preset tables for gain lookup
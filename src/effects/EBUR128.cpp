@@ -10,15 +10,20 @@ Max Maisel
 
 #include "EBUR128.h"
 
+#include <algorithm>
+#include <vector>
+
 EBUR128::EBUR128(double rate, size_t channels)
    : mChannelCount(channels)
    , mRate(rate)
+   , mWeightedLen(0)
 {
    mBlockSize = ceil(0.4 * mRate); // 400 ms blocks
-   mBlockOverlap = ceil(0.1 * mRate); // 100 ms overlap
+   mBlockOverlap = HopSize(mRate); // 100 ms overlap
    mLoudnessHist.reinit(HIST_BIN_COUNT, false);
    mBlockRingBuffer.reinit(mBlockSize);
    mWeightingFilter.reinit(mChannelCount, false);
+   mWeighted.reinit(mChannelCount, false);
    for(size_t channel = 0; channel < mChannelCount; ++channel)
       mWeightingFilter[channel] = CalcWeightingFilter(mRate);
 }
@@ -28,6 +33,8 @@ void EBUR128::Initialize()
    mSampleCount = 0;
    mBlockRingPos = 0;
    mBlockRingSize = 0;
+   mHopRingPos = 0;
+   mHopRingSize = 0;
    memset(mLoudnessHist.get(), 0, HIST_BIN_COUNT*sizeof(long int));
    for(size_t channel = 0; channel < mChannelCount; ++channel)
    {
@@ -85,6 +92,16 @@ ArrayOf<Biquad> EBUR128::CalcWeightingFilter(double fs)
    return std::move(pBiquad);
 }
 
+LoudnessWeighting EBUR128::MakeWeighting(double rate)
+{
+   // A std::function must be copyable, so its copies share the filters
+   auto pFilters =
+      std::make_shared< ArrayOf<Biquad> >(CalcWeightingFilter(rate));
+   return [pFilters](float *buffer, size_t len) {
+      Biquad::ProcessCascade(pFilters->get(), 2, buffer, buffer, len);
+   };
+}
+
 void EBUR128::ProcessSampleFromChannel(float x_in, size_t channel)
 {
    double value;
@@ -117,6 +134,127 @@ void EBUR128::NextSample()
    ++mSampleCount;
 }
 
+/// Runs the two weighting filters over whole buffers into mWeighted,
+/// filtering the channels together
+void EBUR128::Weigh(const float *const *buffers, size_t len)
+{
+   if(mWeightedLen < len)
+   {
+      for(size_t channel = 0; channel < mChannelCount; ++channel)
+         mWeighted[channel].reinit(len);
+      mWeightedLen = len;
+   }
+
+   std::vector<Biquad*> cascades(mChannelCount);
+   std::vector<float*> weighted(mChannelCount);
+   for(size_t channel = 0; channel < mChannelCount; ++channel)
+   {
+      cascades[channel] = mWeightingFilter[channel].get();
+      weighted[channel] = mWeighted[channel].get();
+   }
+   Biquad::ProcessChannels(cascades.data(), 2, buffers, weighted.data(),
+      mChannelCount, len);
+}
+
+void EBUR128::ProcessBuffers(const float *const *buffers, size_t len)
+{
+   Weigh(buffers, len);
+
+   // Sum the power of the channels into the ring, stopping wherever
+   // NextSample() would check for a complete block.
+   size_t pos = 0;
+   while(pos < len)
+   {
+      const size_t nextOverlap =
+         (mBlockRingPos / mBlockOverlap + 1) * mBlockOverlap;
+      const size_t count = std::min(len - pos,
+         std::min(nextOverlap, mBlockSize) - mBlockRingPos);
+
+      double *ring = &mBlockRingBuffer[mBlockRingPos];
+      const float *weighted = &mWeighted[0][pos];
+      for(size_t i = 0; i < count; ++i)
+      {
+         const double value = weighted[i];
+         ring[i] = value * value;
+      }
+      for(size_t channel = 1; channel < mChannelCount; ++channel)
+      {
+         weighted = &mWeighted[channel][pos];
+         for(size_t i = 0; i < count; ++i)
+         {
+            const double value = weighted[i];
+            ring[i] += value * value;
+         }
+      }
+
+      pos += count;
+      mBlockRingPos += count;
+      mBlockRingSize += count;
+      mSampleCount += count;
+
+      if(mBlockRingPos % mBlockOverlap == 0)
+      {
+         // A new full block of samples was submitted.
+         if(mBlockRingSize >= mBlockSize)
+            AddBlockToHistogram(mBlockSize);
+      }
+      // Close the ring.
+      if(mBlockRingPos == mBlockSize)
+         mBlockRingPos = 0;
+   }
+}
+
+void EBUR128::ProcessHopPowers(const double *powers, size_t len)
+{
+   for(size_t i = 0; i < len; ++i)
+      AddHopPower(powers[i], mBlockOverlap);
+}
+
+void EBUR128::ProcessPartialHop(double power, size_t len)
+{
+   if(len > 0)
+      AddHopPower(power, len);
+}
+
+double EBUR128::WeightedPower(const float *const *buffers, size_t len)
+{
+   Weigh(buffers, len);
+
+   double power = 0;
+   for(size_t channel = 0; channel < mChannelCount; ++channel)
+      for(size_t i = 0; i < len; ++i)
+      {
+         const double value = mWeighted[channel][i];
+         power += value * value;
+      }
+   return power;
+}
+
+/// Each hop completes a block once there are enough of them.  The block's
+/// mean square is over the samples of its hops, which are fewer than a
+/// whole block where a hop is partial.
+void EBUR128::AddHopPower(double power, size_t len)
+{
+   mHopRing[mHopRingPos] = power;
+   mHopLenRing[mHopRingPos] = len;
+   mHopRingPos = (mHopRingPos + 1) % HOPS_PER_BLOCK;
+   if(mHopRingSize < HOPS_PER_BLOCK)
+      ++mHopRingSize;
+
+   if(mHopRingSize == HOPS_PER_BLOCK)
+   {
+      double blockVal = 0;
+      size_t blockLen = 0;
+      for(size_t j = 0; j < HOPS_PER_BLOCK; ++j)
+      {
+         blockVal += mHopRing[j];
+         blockLen += mHopLenRing[j];
+      }
+      AddPowerToHistogram(blockVal / double(blockLen));
+   }
+   mSampleCount += len;
+}
+
 double EBUR128::IntegrativeLoudness()
 {
    // EBU R128: z_i = mean square without root
@@ -127,11 +265,15 @@ double EBUR128::IntegrativeLoudness()
    HistogramSums(0, sum_v, sum_c);
 
    // Handle incomplete block if no non-zero block was found.
-   if(sum_c == 0)
+   // Hop powers leave no samples in the ring.
+   if(sum_c == 0 && mBlockRingSize > 0)
    {
       AddBlockToHistogram(mBlockRingSize);
       HistogramSums(0, sum_v, sum_c);
    }
+   if(sum_c == 0)
+      // Silence was processed.
+      return 0;
 
    // Histogram values are simplified log(x^2) immediate values
    // without -0.691 + 10*(...) to safe computing power. This is
@@ -175,16 +317,22 @@ void EBUR128::AddBlockToHistogram(size_t validLen)
    // since this is only used to detect if blocks are complete (>= mBlockSize).
    mBlockRingSize = mBlockSize;
 
-   size_t idx;
    double blockVal = 0;
    for(size_t i = 0; i < validLen; ++i)
       blockVal += mBlockRingBuffer[i];
+   AddPowerToHistogram(blockVal/double(validLen));
+}
+
+/// Counts the mean square of a block in the histogram.
+void EBUR128::AddPowerToHistogram(double power)
+{
+   size_t idx;
 
    // Histogram values are simplified log10() immediate values
    // without -0.691 + 10*(...) to safe computing power. This is
    // possible because these constant cancel out anyway during the
    // following processing steps.
-   blockVal = log10(blockVal/double(validLen));
+   const double blockVal = log10(power);
    // log(blockVal) is within ]-inf, 1]
    idx = round((blockVal - GAMMA_A) * double(HIST_BIN_COUNT) / -GAMMA_A - 1);
 
@@ -24,10 +24,30 @@ public:
    EBUR128(EBUR128&&) = delete;
    ~EBUR128() = default;
 
+   /// Hops in each block
+   static const size_t HOPS_PER_BLOCK = 4;
+
    static ArrayOf<Biquad> CalcWeightingFilter(double fs);
+   /// The K-weighting filter, for WaveTrack::AddLoudnessPowers()
+   static LoudnessWeighting MakeWeighting(double rate);
+   /// Samples of each step between the starts of overlapping blocks
+   static size_t HopSize(double rate) { return ceil(0.1 * rate); }
    void Initialize();
    void ProcessSampleFromChannel(float x_in, size_t channel);
    void NextSample();
+   /// Same as ProcessSampleFromChannel() for each channel, then
+   /// NextSample(), for len samples of every channel at once
+   void ProcessBuffers(const float *const *buffers, size_t len);
+   /// Takes the K-weighted power, summed over channels and samples, of each
+   /// of len successive hops of HopSize() samples, instead of the samples
+   void ProcessHopPowers(const double *powers, size_t len);
+   /// Same as ProcessHopPowers() for one hop of only len samples, at an
+   /// edge of the measured range
+   void ProcessPartialHop(double power, size_t len);
+   /// Runs the weighting filters over len samples of each channel,
+   /// continuing from those before, and returns their power summed over
+   /// channels and samples, for ProcessHopPowers() or ProcessPartialHop()
+   double WeightedPower(const float *const *buffers, size_t len);
    double IntegrativeLoudness();
    inline double IntegrativeLoudnessToLUFS(double loudness)
       { return 10 * log10(loudness); }
@@ -35,6 +55,9 @@ public:
 private:
    void HistogramSums(size_t start_idx, double& sum_v, long int& sum_c);
    void AddBlockToHistogram(size_t validLen);
+   void AddPowerToHistogram(double power);
+   void AddHopPower(double power, size_t len);
+   void Weigh(const float *const *buffers, size_t len);
 
    static const size_t HIST_BIN_COUNT = 65536;
    /// EBU R128 absolute threshold
@@ -49,11 +72,22 @@ private:
    size_t mChannelCount;
    double mRate;
 
+   /// Powers and lengths of the last hops given to ProcessHopPowers() or
+   /// ProcessPartialHop()
+   double mHopRing[HOPS_PER_BLOCK];
+   size_t mHopLenRing[HOPS_PER_BLOCK];
+   size_t mHopRingPos;
+   size_t mHopRingSize;
+
    /// This is be an array of arrays of the type
    /// mWeightingFilter[CHANNEL][FILTER] with
    /// CHANNEL = LEFT/RIGHT (0/1) and
    /// FILTER  = HSF/HPF    (0/1)
    ArrayOf<ArrayOf<Biquad>> mWeightingFilter;
+
+   /// Weighted samples of each channel, for ProcessBuffers()
+   ArrayOf<Floats> mWeighted;
+   size_t mWeightedLen;
 };
 
 #endif
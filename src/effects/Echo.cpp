@@ -167,6 +167,13 @@ bool EffectEcho::SetAutomationParameters(CommandParameters & parms)
    return true;
 }
 
+// Effect implementation
+
+bool EffectEcho::SupportsChaining()
+{
+   return true;
+}
+
 void EffectEcho::PopulateOrExchange(ShuttleGui & S)
 {
    S.AddSpace(0, 5);
@@ -46,6 +46,7 @@ public:
    bool SetAutomationParameters(CommandParameters & parms) override;
 
    // Effect implementation
+   bool SupportsChaining() override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
@@ -21,14 +21,19 @@
 #include "../Experimental.h"
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
 
 #include <wx/defs.h>
 #include <wx/sizer.h>
 #include <wx/tokenzr.h>
 
 #include "../AudioIO.h"
+#include "../InconsistencyException.h"
 #include "../LabelTrack.h"
 #include "../Mix.h"
+#include "../OrderedParallelJobs.h"
 #include "../PluginManager.h"
 #include "../ProjectAudioManager.h"
 #include "../ProjectSettings.h"
@@ -1240,6 +1245,7 @@ bool Effect::DoEffect(double projectRate,
 
       End();
       ReplaceProcessedTracks( false );
+      mPreviewMix.reset();
    } );
 
    // We don't yet know the effect type for code in the Nyquist Prompt, so
@@ -1330,6 +1336,42 @@ bool Effect::Delegate(
       region, &parent, factory );
 }
 
+bool Effect::DoEffectChain( const std::vector<Effect*> &effects,
+   double projectRate, TrackList *list, TrackFactory *factory,
+   NotifyingSelectedRegion &selectedRegion )
+{
+   const auto chainable = [&]( Effect *effect ){
+      return effect->GetType() == EffectTypeProcess &&
+         effect->SupportsChaining();
+   };
+   const auto multichannel = [&]( Effect *effect ){
+      return effect->GetAudioInCount() > 1;
+   };
+
+   for (size_t ii = 0; ii < effects.size();) {
+      // Find the longest run that can be streamed through one pass; all
+      // of it must visit the tracks by the same channel groups
+      auto jj = ii + 1;
+      if (chainable(effects[ii])) {
+         while (jj < effects.size() && chainable(effects[jj]) &&
+                multichannel(effects[jj]) == multichannel(effects[ii]))
+            ++jj;
+      }
+
+      const bool success = (jj - ii > 1)
+         ? DoChainedPass( { effects.begin() + ii, effects.begin() + jj },
+              projectRate, list, factory, selectedRegion )
+         : effects[ii]->DoEffect( projectRate, list, factory,
+              selectedRegion );
+      if (!success)
+         return false;
+
+      ii = jj;
+   }
+
+   return true;
+}
+
 // All legacy effects should have this overridden
 bool Effect::Init()
 {
@@ -1341,6 +1383,38 @@ int Effect::GetPass()
    return mPass;
 }
 
+bool Effect::SupportsParallelProcessing()
+{
+   return false;
+}
+
+bool Effect::SupportsSegmentedProcessing(
+   double WXUNUSED(sampleRate), size_t &warmUp)
+{
+   warmUp = 0;
+   return false;
+}
+
+bool Effect::AddParallelProcessor(unsigned numChannels,
+   ChannelNames WXUNUSED(chanMap), float sampleRate,
+   sampleCount WXUNUSED(start), sampleCount WXUNUSED(len))
+{
+   return RealtimeAddProcessor(numChannels, sampleRate);
+}
+
+bool Effect::ResetParallelProcessor(int WXUNUSED(group),
+   unsigned WXUNUSED(numChannels), ChannelNames WXUNUSED(chanMap),
+   float WXUNUSED(sampleRate),
+   sampleCount WXUNUSED(start), sampleCount WXUNUSED(len))
+{
+   return false;
+}
+
+bool Effect::SupportsChaining()
+{
+   return mClient != nullptr;
+}
+
 bool Effect::InitPass1()
 {
    return true;
@@ -1379,6 +1453,9 @@ bool Effect::Process()
 
 bool Effect::ProcessPass()
 {
+   if (GetType() == EffectTypeProcess && SupportsParallelProcessing())
+      return ProcessPassParallel();
+
    bool bGoodResult = true;
    bool isGenerator = GetType() == EffectTypeGenerate;
 
@@ -1525,6 +1602,250 @@ bool Effect::ProcessPass()
    return bGoodResult;
 }
 
+bool Effect::ProcessPassParallel()
+{
+   // A selected channel group, as ProcessPass would visit it
+   struct Group {
+      WaveTrack *left;
+      WaveTrack *right;
+      unsigned numChannels;
+      sampleCount start;
+      sampleCount len;
+
+      // Unchanging copies to read, sharing blocks with the tracks, so that
+      // segments may be read while other segments are written
+      std::shared_ptr<const WaveTrack> leftSource, rightSource;
+
+      // The channels' names, as ProcessPass gives them to ProcessInitialize
+      ChannelName map[3];
+   };
+   std::vector<Group> groups;
+
+   const auto channelName = [](const WaveTrack *channel) -> ChannelName {
+      if (channel->GetChannel() == Track::LeftChannel)
+         return ChannelNameFrontLeft;
+      else if (channel->GetChannel() == Track::RightChannel)
+         return ChannelNameFrontRight;
+      else
+         return ChannelNameMono;
+   };
+
+   const bool multichannel = mNumAudioIn > 1;
+   auto range = multichannel
+      ? mOutputTracks->Leaders()
+      : mOutputTracks->Any();
+   range.Visit(
+      [&](WaveTrack *left, const Track::Fallthrough &fallthrough) {
+         if (!left->GetSelected())
+            return fallthrough();
+
+         // TODO: more-than-two-channels
+         Group group{ left, nullptr, 1 };
+         group.map[0] = channelName(left);
+         group.map[1] = ChannelNameEOL;
+         if (multichannel) {
+            for (auto channel :
+                 TrackList::Channels(left).StartingWith(left)) {
+               if (channel != left) {
+                  group.right = channel;
+                  group.numChannels = 2;
+                  group.map[1] = channelName(channel);
+                  group.map[2] = ChannelNameEOL;
+                  break;
+               }
+            }
+         }
+
+         GetBounds(*left, group.right, &group.start, &group.len);
+         groups.push_back(group);
+      },
+      [&](Track *t) {
+         if (t->IsSyncLockSelected())
+            t->SyncLockAdjust(mT1, mT0 + mDuration);
+      }
+   );
+
+   if (groups.empty())
+      return true;
+
+   SetSampleRate(groups[0].left->GetRate());
+   if (!RealtimeInitialize())
+      return false;
+   auto cleanup = finally( [&] { RealtimeFinalize(); } );
+
+   size_t max = 0;
+   double totalLen = 0;
+   for (const auto &group : groups) {
+      max = std::max(max, group.left->GetMaxBlockSize() * 2);
+      totalLen += group.len.as_double();
+   }
+
+   // Processors may have chosen small blocks for playback; offline,
+   // as in ProcessPass, prefer large ones
+   mBlockSize = SetBlockSize(max);
+   mBufferSize = ((max + (mBlockSize - 1)) / mBlockSize) * mBlockSize;
+
+   // A run of samples of one group
+   struct Segment {
+      size_t group;
+      sampleCount start;
+      sampleCount len;
+      size_t warmUp;
+   };
+   std::vector<Segment> segments;
+   bool anySegmented = false;
+
+   // Split long selections, if the effect allows, into segments of about
+   // a million samples, a whole number of buffers each
+   const auto segmentLen = std::max<size_t>(1, (1 << 20) / mBufferSize)
+      * mBufferSize;
+   for (size_t ii = 0; ii < groups.size(); ++ii) {
+      auto &group = groups[ii];
+      size_t warmUp = 0;
+      const bool segmented = SupportsSegmentedProcessing(
+         group.left->GetRate(), warmUp) && group.len > segmentLen;
+      if (segmented) {
+         anySegmented = true;
+         group.leftSource = std::static_pointer_cast<const WaveTrack>(
+            group.left->Duplicate() );
+         if (group.right)
+            group.rightSource = std::static_pointer_cast<const WaveTrack>(
+               group.right->Duplicate() );
+      }
+
+      for (sampleCount offset = 0; offset < group.len; offset += segmentLen) {
+         const auto len = segmented
+            ? std::min(group.len - offset, sampleCount{ segmentLen })
+            : group.len;
+         // Warm up on preceding samples of the selection, if any
+         const auto segmentWarmUp =
+            std::min(sampleCount{ warmUp }, offset).as_size_t();
+         segments.push_back(
+            { ii, group.start + offset, len, segmentWarmUp });
+         if (!segmented)
+            break;
+      }
+   }
+
+   // Segments write their own ranges of the tracks, so none waits for
+   // another to be taken
+   OrderedParallelJobs parallelJobs{
+      OrderedParallelJobs::DefaultThreadCount(segments.size()),
+      OrderedParallelJobs::Unbounded };
+   const auto nThreads = parallelJobs.ThreadCount();
+
+   // Where a segment's processor starts, in its group's selection
+   const auto processorStart = [&](const Segment &segment) {
+      const auto &group = groups[segment.group];
+      return segment.start - group.start - segment.warmUp;
+   };
+
+   // Without segments, each group has its own processor.  With them, each
+   // worker has one, and resets it for each segment it takes, so that the
+   // number of processors does not grow with the length of the selection.
+   const auto nProcessors = anySegmented ? nThreads : segments.size();
+   for (size_t ii = 0; ii < nProcessors; ++ii) {
+      const auto &segment = segments[ii];
+      auto &group = groups[segment.group];
+      if (!AddParallelProcessor(group.numChannels, group.map,
+            group.left->GetRate(), processorStart(segment), group.len))
+         return false;
+   }
+
+   // Each worker has its own buffers.  Always give the client all the
+   // buffers it expects, the unused input buffers cleared.
+   struct Buffers {
+      FloatBuffers in, out;
+      ArrayOf<float *> inPos, outPos;
+   };
+   std::vector<Buffers> buffers;
+   for (size_t ii = 0; ii < nThreads; ++ii)
+      buffers.push_back( {
+         FloatBuffers{ mNumAudioIn, mBufferSize, true },
+         FloatBuffers{ mNumAudioOut, mBufferSize },
+         ArrayOf<float *>{ mNumAudioIn },
+         ArrayOf<float *>{ mNumAudioOut } } );
+
+   std::atomic<long long> samplesDone{ 0 };
+
+   // Guards the tracks' writes, because making block files is not
+   // thread-safe
+   std::mutex mutex;
+
+   const auto work = [&](size_t thread, size_t ii) {
+      auto &inBuffer = buffers[thread].in;
+      auto &outBuffer = buffers[thread].out;
+      auto &inBufPos = buffers[thread].inPos;
+      auto &outBufPos = buffers[thread].outPos;
+
+      const auto &segment = segments[ii];
+      auto &group = groups[segment.group];
+      const auto chans =
+         std::min<unsigned>(mNumAudioOut, group.numChannels);
+      const WaveTrack *const left = group.leftSource
+         ? group.leftSource.get() : group.left;
+      const WaveTrack *const right = group.rightSource
+         ? group.rightSource.get() : group.right;
+
+      if (!right && mNumAudioIn > 1)
+         std::fill(inBuffer[1].get(), inBuffer[1].get() + mBufferSize,
+            0.0f);
+
+      const int processor = anySegmented ? thread : ii;
+      if (anySegmented &&
+          !ResetParallelProcessor(processor, group.numChannels, group.map,
+             group.left->GetRate(), processorStart(segment), group.len))
+         // SupportsSegmentedProcessing promised this
+         THROW_INCONSISTENCY_EXCEPTION;
+
+      const auto end = segment.start + segment.len;
+      for (auto pos = segment.start - segment.warmUp;
+           pos < end && !parallelJobs.Cancelled();) {
+         // Keep warm-up and output in separate buffers
+         const auto count = (pos < segment.start)
+            ? limitSampleBufferSize(mBufferSize, segment.start - pos)
+            : limitSampleBufferSize(mBufferSize, end - pos);
+
+         left->Get(
+            (samplePtr) inBuffer[0].get(), floatSample, pos, count);
+         if (right)
+            right->Get(
+               (samplePtr) inBuffer[1].get(), floatSample, pos, count);
+
+         for (size_t offset = 0; offset < count; offset += mBlockSize) {
+            const auto blockLen = std::min(mBlockSize, count - offset);
+            for (size_t i = 0; i < mNumAudioIn; i++)
+               inBufPos[i] = inBuffer[i].get() + offset;
+            for (size_t i = 0; i < mNumAudioOut; i++)
+               outBufPos[i] = outBuffer[i].get() + offset;
+            RealtimeProcess(
+               processor, inBufPos.get(), outBufPos.get(), blockLen);
+         }
+
+         if (pos >= segment.start) {
+            std::lock_guard<std::mutex> locker{ mutex };
+            group.left->Set(
+               (samplePtr) outBuffer[0].get(), floatSample, pos, count);
+            if (group.right)
+               group.right->Set(
+                  (samplePtr) outBuffer[chans >= 2 ? 1 : 0].get(),
+                  floatSample, pos, count);
+            samplesDone += count;
+         }
+
+         pos += count;
+      }
+   };
+
+   // Only this thread may update the progress dialog
+   return parallelJobs.Run( segments.size(), work,
+      [](size_t) {},
+      [&](size_t) {
+         const double frac = totalLen > 0 ? samplesDone / totalLen : 1.0;
+         return !TotalProgress(frac);
+      } );
+}
+
 bool Effect::ProcessTrack(int count,
                           ChannelNames map,
                           WaveTrack *left,
@@ -1901,6 +2222,433 @@ bool Effect::ProcessTrack(int count,
    return rc;
 }
 
+bool Effect::InitChained(double projectRate,
+                         TrackList *list,
+                         TrackFactory *factory,
+                         NotifyingSelectedRegion &selectedRegion)
+{
+   // As in DoEffect, for a process effect that does not prompt
+   mOutputTracks.reset();
+
+   mpSelectedRegion = &selectedRegion;
+   mFactory = factory;
+   mProjectRate = projectRate;
+   mTracks = list;
+
+   mDuration = 0.0;
+   mT0 = selectedRegion.t0();
+   mT1 = selectedRegion.t1();
+   if (mT1 > mT0)
+   {
+      double quantMT0 = QUANTIZED_TIME(mT0, mProjectRate);
+      double quantMT1 = QUANTIZED_TIME(mT1, mProjectRate);
+      mDuration = quantMT1 - quantMT0;
+      mT1 = mT0 + mDuration;
+   }
+
+   CountWaveTracks();
+
+   // Note: Init may read parameters from preferences
+   return Init();
+}
+
+bool Effect::DoChainedPass(const std::vector<Effect*> &effects,
+                           double projectRate,
+                           TrackList *list,
+                           TrackFactory *factory,
+                           NotifyingSelectedRegion &selectedRegion)
+{
+   std::vector<Effect*> initialized;
+   auto cleanup = finally( [&] {
+      // Discard the track sets of the stages, last first, because each
+      // one's input is the output of the one before
+      for (auto iter = initialized.rbegin(); iter != initialized.rend();
+           ++iter) {
+         (*iter)->End();
+         (*iter)->ReplaceProcessedTracks( false );
+      }
+   } );
+
+   // Each stage is initialized with the output tracks of the stage before
+   // it as its input, and copies them to its own output tracks
+   std::vector<Effect*> stages;
+   TrackList *input = list;
+   for (auto effect : effects) {
+      initialized.push_back(effect);
+      if (!effect->InitChained(projectRate, input, factory, selectedRegion))
+         return false;
+      if (effect->CheckWhetherSkipEffect())
+         continue;
+
+      effect->CopyInputTracks(true);
+      effect->mNumAudioIn = effect->GetAudioInCount();
+      effect->mNumAudioOut = effect->GetAudioOutCount();
+      stages.push_back(effect);
+      input = effect->mOutputTracks.get();
+   }
+
+   if (stages.empty())
+      return true;
+
+   wxString names;
+   for (auto effect : stages) {
+      if (!names.empty())
+         names += wxT(", ");
+      names += effect->GetName().Translation();
+   }
+
+   // The last effect of the chain writes the output tracks and reports
+   // progress for all
+   auto &last = *stages.back();
+   ProgressDialog progress{
+      Verbatim( names ),
+      XO("Applying %s...").Format( names ),
+      pdlgHideStopButton
+   };
+   auto vr = valueRestorer( last.mProgress, &progress );
+
+   const bool bGoodResult = last.ProcessChain(stages);
+   if (!bGoodResult)
+      return false;
+
+   // Trace the last stage's tracks back through the stages before it to the
+   // given tracks, so that they are all replaced at once
+   for (auto ii = stages.size() - 1; ii--;) {
+      const auto &stage = *stages[ii];
+      for (auto &t : last.mIMap) {
+         if (!t)
+            continue;
+         const auto iter =
+            std::find(stage.mOMap.begin(), stage.mOMap.end(), t);
+         wxASSERT(iter != stage.mOMap.end());
+         t = (iter == stage.mOMap.end())
+            ? nullptr
+            : stage.mIMap[iter - stage.mOMap.begin()];
+      }
+   }
+   last.mTracks = list;
+   last.ReplaceProcessedTracks(true);
+
+   if (last.mT1 >= last.mT0)
+      selectedRegion.setTimes(last.mT0, last.mT1);
+
+   return true;
+}
+
+namespace {
+
+// Feeds one effect of a chain with blocks of samples as ProcessTrack
+// would, and passes its output on to the next, with the latency the effect
+// reports removed.  It gives out exactly as many samples as it is given.
+class ChainedProcessor
+{
+public:
+   using Sink = std::function< void(float *const *buffers, size_t len) >;
+
+   ChainedProcessor(Effect &effect,
+                    unsigned numAudioIn,
+                    unsigned numAudioOut,
+                    unsigned numChannels,
+                    size_t blockSize,
+                    sampleCount len,
+                    const Sink &sink)
+   : mEffect{ effect }
+   , mNumAudioOut{ std::max(1u, numAudioOut) }
+   , mNumChannels{ numChannels }
+   , mBlockSize{ blockSize }
+   , mInputRemaining{ len }
+   , mSink{ sink }
+   // Always give the effect all the buffers it expects, the unused input
+   // buffers cleared
+   , mInBuffer{ numAudioIn, blockSize, true }
+   , mOutBuffer{ mNumAudioOut, blockSize }
+   , mInBufPos{ numAudioIn }
+   , mOutBufPos{ mNumAudioOut }
+   , mSinkPos{ numChannels }
+   {
+      for (size_t i = 0; i < numAudioIn; i++)
+         mInBufPos[i] = mInBuffer[i].get();
+      for (size_t i = 0; i < mNumAudioOut; i++)
+         mOutBufPos[i] = mOutBuffer[i].get();
+   }
+
+   void Add(float *const *buffers, size_t len)
+   {
+      for (size_t offset = 0; offset < len;) {
+         const auto count = std::min(len - offset, mBlockSize - mFilled);
+         for (size_t i = 0; i < mNumChannels; i++)
+            std::copy(buffers[i] + offset, buffers[i] + offset + count,
+               mInBuffer[i].get() + mFilled);
+         mFilled += count;
+         mInputRemaining -= count;
+         offset += count;
+
+         if (mFilled == mBlockSize || mInputRemaining == 0)
+            ProcessInput();
+      }
+   }
+
+   // Call after all input is added, to get the delayed samples
+   void Flush()
+   {
+      // From this point on, only feed zeros to the effect
+      for (size_t i = 0; i < mNumChannels; i++)
+         std::fill(mInBuffer[i].get(), mInBuffer[i].get() + mBlockSize, 0.0f);
+
+      while (mDelayRemaining != 0) {
+         const auto blockLen =
+            limitSampleBufferSize(mBlockSize, mDelayRemaining);
+         mDelayRemaining -= blockLen;
+         Process(blockLen);
+      }
+   }
+
+private:
+   void ProcessInput()
+   {
+      auto blockLen = mFilled;
+      mFilled = 0;
+
+      if (mInputRemaining == 0 && blockLen < mBlockSize) {
+         // Clear the remainder of the last block, and use the room for some
+         // of the delayed samples
+         for (size_t i = 0; i < mNumChannels; i++)
+            std::fill(mInBuffer[i].get() + blockLen,
+               mInBuffer[i].get() + mBlockSize, 0.0f);
+         const auto cnt =
+            limitSampleBufferSize(mBlockSize - blockLen, mDelayRemaining);
+         mDelayRemaining -= cnt;
+         blockLen += cnt;
+      }
+
+      Process(blockLen);
+   }
+
+   void Process(size_t blockLen)
+   {
+      const auto processed =
+         mEffect.ProcessBlock(mInBufPos.get(), mOutBufPos.get(), blockLen);
+      wxASSERT(processed == blockLen);
+      wxUnusedVar(processed);
+
+      // Drop as many leading output samples as the effect has delayed
+      const auto delay = mEffect.GetLatency();
+      mCurDelay += delay;
+      mDelayRemaining += delay;
+      if (mCurDelay >= blockLen) {
+         mCurDelay -= blockLen;
+         return;
+      }
+      const auto skip = mCurDelay.as_size_t();
+      mCurDelay = 0;
+
+      // Channels beyond the effect's outputs repeat its first output
+      for (size_t i = 0; i < mNumChannels; i++)
+         mSinkPos[i] =
+            mOutBuffer[i < mNumAudioOut ? i : 0].get() + skip;
+      mSink(mSinkPos.get(), blockLen - skip);
+   }
+
+   Effect &mEffect;
+   const unsigned mNumAudioOut;
+   const unsigned mNumChannels;
+   const size_t mBlockSize;
+
+   sampleCount mInputRemaining;
+   sampleCount mCurDelay{ 0 };
+   sampleCount mDelayRemaining{ 0 };
+   size_t mFilled{ 0 };
+
+   Sink mSink;
+
+   FloatBuffers mInBuffer, mOutBuffer;
+   ArrayOf<float *> mInBufPos, mOutBufPos, mSinkPos;
+};
+
+}
+
+bool Effect::ProcessChain(const std::vector<Effect*> &stages)
+{
+   bool bGoodResult = true;
+   ChannelName map[3];
+   int count = 0;
+
+   // DoEffectChain makes all stages agree about channel groups
+   const bool multichannel = mNumAudioIn > 1;
+   auto range = multichannel
+      ? mOutputTracks->Leaders()
+      : mOutputTracks->Any();
+   range.VisitWhile( bGoodResult,
+      [&](WaveTrack *left, const Track::Fallthrough &fallthrough) {
+         if (!left->GetSelected())
+            return fallthrough();
+
+         // Find the channels as ProcessPass does
+         mNumChannels = 0;
+         WaveTrack *right{};
+         for (auto channel :
+              TrackList::Channels(left).StartingWith(left)) {
+            if (channel->GetChannel() == Track::LeftChannel)
+               map[mNumChannels] = ChannelNameFrontLeft;
+            else if (channel->GetChannel() == Track::RightChannel)
+               map[mNumChannels] = ChannelNameFrontRight;
+            else
+               map[mNumChannels] = ChannelNameMono;
+
+            ++ mNumChannels;
+            map[mNumChannels] = ChannelNameEOL;
+
+            if (! multichannel)
+               break;
+
+            if (mNumChannels == 2) {
+               // TODO: more-than-two-channels
+               right = channel;
+               break;
+            }
+         }
+
+         sampleCount start = 0, len = 0;
+         GetBounds(*left, right, &start, &len);
+
+         bGoodResult =
+            ProcessChainTrack(stages, count, map, left, right, start, len);
+         count++;
+      },
+      [&](Track *t) {
+         if (t->IsSyncLockSelected())
+            t->SyncLockAdjust(mT1, mT0 + mDuration);
+      }
+   );
+
+   return bGoodResult;
+}
+
+bool Effect::ProcessChainTrack(const std::vector<Effect*> &stages,
+                               int count,
+                               ChannelNames map,
+                               WaveTrack *left,
+                               WaveTrack *right,
+                               sampleCount start,
+                               sampleCount len)
+{
+   if (len == 0)
+      return true;
+
+   bool rc = true;
+
+   const auto max = left->GetMaxBlockSize() * 2;
+
+   // Give each effect a chance to initialize
+   std::vector<Effect*> initialized;
+   { // Start scope for cleanup
+   auto cleanup = finally( [&] {
+      // Allow the effects to cleanup
+      for (auto effect : initialized)
+         if (!effect->ProcessFinalize())
+            // In case of non-exceptional flow of control, set rc
+            rc = false;
+   } );
+   for (auto effect : stages) {
+      effect->SetSampleRate(left->GetRate());
+      effect->mBlockSize = effect->SetBlockSize(max);
+      effect->mSampleCnt = len;
+      effect->mNumChannels = mNumChannels;
+      if (!effect->ProcessInitialize(len, map))
+         return false;
+      initialized.push_back(effect);
+   }
+
+   // Collect the output of the last stage, and write it when there is
+   // a buffer full
+   FloatBuffers outBuffer{ mNumChannels, max };
+   size_t outputBufferCnt = 0;
+   auto outPos = start;
+   const auto write = [&] {
+      left->Set((samplePtr) outBuffer[0].get(),
+         floatSample, outPos, outputBufferCnt);
+      if (right)
+         right->Set((samplePtr) outBuffer[1].get(),
+            floatSample, outPos, outputBufferCnt);
+      outPos += outputBufferCnt;
+      outputBufferCnt = 0;
+   };
+   const auto collect = [&]( float *const *buffers, size_t blockLen ){
+      for (size_t offset = 0; offset < blockLen;) {
+         const auto cnt = std::min(blockLen - offset, max - outputBufferCnt);
+         for (size_t i = 0; i < mNumChannels; i++)
+            std::copy(buffers[i] + offset, buffers[i] + offset + cnt,
+               outBuffer[i].get() + outputBufferCnt);
+         outputBufferCnt += cnt;
+         offset += cnt;
+         if (outputBufferCnt == max)
+            write();
+      }
+   };
+
+   // Connect the stages, last first
+   std::vector< std::unique_ptr<ChainedProcessor> > processors(stages.size());
+   for (auto ii = stages.size(); ii--;) {
+      auto effect = stages[ii];
+      ChainedProcessor::Sink sink{ collect };
+      if (ii + 1 < stages.size()) {
+         const auto next = processors[ii + 1].get();
+         sink = [next]( float *const *buffers, size_t blockLen ){
+            next->Add(buffers, blockLen); };
+      }
+      processors[ii] = std::make_unique<ChainedProcessor>(
+         *effect, effect->mNumAudioIn, effect->mNumAudioOut, mNumChannels,
+         effect->mBlockSize, len, sink);
+   }
+
+   // Output is never ahead of input, so the same tracks may be read and
+   // written as in ProcessTrack
+   FloatBuffers inBuffer{ mNumChannels, max };
+   ArrayOf<float *> inBufPos{ mNumChannels };
+   for (size_t i = 0; i < mNumChannels; i++)
+      inBufPos[i] = inBuffer[i].get();
+   try
+   {
+      for (auto inPos = start, end = start + len; inPos < end;) {
+         const auto cnt = limitSampleBufferSize(max, end - inPos);
+         left->Get((samplePtr) inBuffer[0].get(), floatSample, inPos, cnt);
+         if (right)
+            right->Get((samplePtr) inBuffer[1].get(), floatSample, inPos, cnt);
+         processors[0]->Add(inBufPos.get(), cnt);
+         inPos += cnt;
+
+         const double frac = (inPos - start).as_double() / len.as_double();
+         if (mNumChannels > 1
+            ? TrackGroupProgress(count, frac)
+            : TrackProgress(count, frac))
+            return false;
+      }
+
+      // Let each stage give out its delayed samples, in order, so that
+      // later stages receive all of their input
+      for (auto &processor : processors)
+         processor->Flush();
+   }
+   catch( const AudacityException & WXUNUSED(e) )
+   {
+      // Pass this along to our application-level handler
+      throw;
+   }
+   catch(...)
+   {
+      // Exceptions for other reasons, maybe in third-party code, are treated
+      // as in ProcessTrack
+      return false;
+   }
+
+   // Put any remaining output
+   if (outputBufferCnt)
+      write();
+
+   } // End scope for cleanup
+   return rc;
+}
+
 void Effect::End()
 {
 }
@@ -2099,6 +2847,14 @@ Track *Effect::AddToOutputTracks(const std::shared_ptr<Track> &t)
    return mOutputTracks->Add(t);
 }
 
+const Track *Effect::GetInputTrack(const Track *pOutput) const
+{
+   const auto iter = std::find(mOMap.begin(), mOMap.end(), pOutput);
+   return (iter == mOMap.end())
+      ? nullptr
+      : mIMap[iter - mOMap.begin()];
+}
+
 Effect::AddedAnalysisTrack::AddedAnalysisTrack(Effect *pEffect, const wxString &name)
    : mpEffect(pEffect)
 {
@@ -2385,23 +3141,44 @@ void Effect::Preview(bool dryOnly)
    // Linear Effect preview optimised by pre-mixing to one track.
    // Generators need to generate per track.
    if (mIsLinearEffect && !isGenerator) {
-      WaveTrack::Holder mixLeft, mixRight;
-      MixAndRender(saveTracks, mFactory, rate, floatSample, mT0, t1, mixLeft, mixRight);
-      if (!mixLeft)
-         return;
+      // Mixing is the slow part, and gives the same result each time the
+      // user tries other settings in the dialog
+      const bool keepMix = mUIDialog && mUIDialog->IsModal();
+      if (!(mPreviewMix && keepMix &&
+            mPreviewMix->tracks == saveTracks &&
+            mPreviewMix->t0 == mT0 && mPreviewMix->t1 == t1 &&
+            mPreviewMix->rate == rate)) {
+         mPreviewMix.reset();
+         WaveTrack::Holder mixLeft, mixRight;
+         MixAndRender(saveTracks, mFactory, rate, floatSample, mT0, t1, mixLeft, mixRight);
+         if (!mixLeft)
+            return;
 
-      mixLeft->Offset(-mixLeft->GetStartTime());
+         mixLeft->Offset(-mixLeft->GetStartTime());
+         if (mixRight)
+            mixRight->Offset(-mixRight->GetStartTime());
+         mPreviewMix = std::make_unique<PreviewMix>( PreviewMix{
+            saveTracks, mT0, t1, rate, mixLeft, mixRight } );
+      }
+
+      // The effect gets copies, which share the sample blocks of the mix
+      auto mixLeft =
+         std::static_pointer_cast<WaveTrack>( mPreviewMix->left->Duplicate() );
       mixLeft->SetSelected(true);
       WaveTrackView::Get( *mixLeft )
          .SetDisplay(WaveTrackViewConstants::NoDisplay);
       auto pLeft = mTracks->Add( mixLeft );
       Track *pRight{};
-      if (mixRight) {
-         mixRight->Offset(-mixRight->GetStartTime());
+      if (mPreviewMix->right) {
+         auto mixRight = std::static_pointer_cast<WaveTrack>(
+            mPreviewMix->right->Duplicate() );
          mixRight->SetSelected(true);
          pRight = mTracks->Add( mixRight );
       }
       mTracks->GroupChannels(*pLeft, pRight ? 2 : 1);
+
+      if (!keepMix)
+         mPreviewMix.reset();
    }
    else {
       for (auto src : saveTracks->Any< const WaveTrack >()) {
@@ -18,6 +18,7 @@
 
 #include <functional>
 #include <set>
+#include <vector>
 
 #include <wx/defs.h>
 
@@ -265,6 +266,17 @@ class AUDACITY_DLL_API Effect /* not final */ : public wxEvtHandler,
    bool Delegate( Effect &delegate,
       wxWindow &parent, const EffectDialogFactory &factory );
 
+   // Apply already configured effects in turn, as DoEffect would without
+   // prompting.  Consecutive effects that SupportsChaining are fed block by
+   // block from each other's output, so that only the last one writes
+   // samples to the tracks; their latencies are removed at every stage.
+   // Each effect of such a run has its own output tracks, copied from those
+   // of the effect before, and the tracks are replaced once at the end.
+   // Returns false as soon as one effect fails or is cancelled.
+   static bool DoEffectChain( const std::vector<Effect*> &effects,
+      double projectRate, TrackList *list, TrackFactory *factory,
+      NotifyingSelectedRegion &selectedRegion );
+
    virtual bool IsHidden();
 
    // Nonvirtual
@@ -277,6 +289,42 @@ class AUDACITY_DLL_API Effect /* not final */ : public wxEvtHandler,
 
    static void IncEffectCounter(){ nEffectsDone++;};
 
+   // Parallel processing, which ProcessPass drives with the realtime
+   // methods of EffectClientInterface, and which is public as they are
+
+   // Return true only if RealtimeProcess gives the same results as
+   // ProcessBlock, without latency, and may be called for different groups
+   // on different threads at once.  Then ProcessPass gives each selected
+   // channel group its own realtime processor and processes several groups
+   // at a time.
+   virtual bool SupportsParallelProcessing();
+
+   // For effects that SupportsParallelProcessing.  Return true if each
+   // output sample depends on no more than the warmUp input samples before
+   // it, besides its own and its position, so that long selections may
+   // also be split into segments processed concurrently.  Each segment's
+   // processor is first given the warmUp samples before the segment.
+   // Effects returning true must also override ResetParallelProcessor.
+   virtual bool SupportsSegmentedProcessing(double sampleRate, size_t &warmUp);
+
+   // Make the processor for a channel group, or for a segment of one, in
+   // parallel processing.  chanMap names the group's channels, as for
+   // ProcessInitialize.  It will be given samples from offset start in the
+   // group's selection of length len.  The default ignores these and calls
+   // RealtimeAddProcessor.
+   virtual bool AddParallelProcessor(unsigned numChannels,
+      ChannelNames chanMap, float sampleRate,
+      sampleCount start, sampleCount len);
+
+   // Make the existing processor of index group ready for another segment,
+   // as AddParallelProcessor would make a new one.  Segments reuse as many
+   // processors as there are worker threads.  Called on the worker thread
+   // that uses the processor, so it must touch no other processor's state.
+   // The default returns false.
+   virtual bool ResetParallelProcessor(int group, unsigned numChannels,
+      ChannelNames chanMap, float sampleRate,
+      sampleCount start, sampleCount len);
+
 //
 // protected virtual methods
 //
@@ -304,6 +352,14 @@ protected:
    virtual bool InitPass2();
    virtual int GetPass();
 
+   // Return true if Process does no more than one ProcessPass of
+   // ProcessBlock calls, so that DoEffectChain may instead stream the output
+   // of another effect into ProcessBlock.  In a chain, Init is given the
+   // output tracks of the effect before, whose samples are not yet
+   // processed, so only their selection, rates and channels may affect it.
+   // The default is true for clients.
+   virtual bool SupportsChaining();
+
    // clean up any temporary memory, needed only per invocation of the
    // effect, after either successful or failed or exception-aborted processing.
    // Invoked inside a "finally" block so it must be no-throw.
@@ -445,6 +501,10 @@ protected:
    // Use this to append a NEW output track.
    Track *AddToOutputTracks(const std::shared_ptr<Track> &t);
 
+   // The track of inputTracks() that CopyInputTracks() copied to the given
+   // track of mOutputTracks, or null if it was appended
+   const Track *GetInputTrack(const Track *pOutput) const;
+
 //
 // protected data
 //
@@ -496,6 +556,24 @@ protected:
                      ArrayOf< float * > &inBufPos,
                      ArrayOf< float *> &outBufPos);
 
+   // Driver for effects that SupportsParallelProcessing
+   bool ProcessPassParallel();
+
+   // Drivers for DoEffectChain
+   bool InitChained(double projectRate, TrackList *list,
+      TrackFactory *factory, NotifyingSelectedRegion &selectedRegion);
+   static bool DoChainedPass(const std::vector<Effect*> &effects,
+      double projectRate, TrackList *list, TrackFactory *factory,
+      NotifyingSelectedRegion &selectedRegion);
+   bool ProcessChain(const std::vector<Effect*> &stages);
+   bool ProcessChainTrack(const std::vector<Effect*> &stages,
+                          int count,
+                          ChannelNames map,
+                          WaveTrack *left,
+                          WaveTrack *right,
+                          sampleCount start,
+                          sampleCount len);
+
  //
  // private data
  //
@@ -514,6 +592,16 @@ private:
 
    bool mIsPreview;
 
+   // The mix that Preview gives to a linear effect.  It is kept only while
+   // the effect's dialog is modal, when the tracks can't change, so that
+   // previewing other settings need not mix again.
+   struct PreviewMix {
+      const TrackList *tracks;
+      double t0, t1, rate;
+      std::shared_ptr<WaveTrack> left, right;
+   };
+   std::unique_ptr<PreviewMix> mPreviewMix;
+
    bool mUIDebug;
 
    std::vector<Track*> mIMap;
@@ -2004,6 +2004,53 @@ wxDialog *EffectUI::DialogFactory( wxWindow &parent, EffectHostInterface *pHost,
    return true;
 }
 
+/// DoEffectChain() takes the PluginIDs of effects whose parameters are
+/// already set, and applies them in turn to the selection, streaming
+/// consecutive ones into each other where Effect::DoEffectChain can.
+/// It is meant for macros, so it neither prompts nor pushes history nor
+/// changes 'Repeat Last Effect'.
+
+/* static */ bool EffectUI::DoEffectChain(
+   const std::vector<PluginID> &IDs, const CommandContext &context )
+{
+   AudacityProject &project = context.project;
+   const auto &settings = ProjectSettings::Get( project );
+   auto &tracks = TrackList::Get( project );
+   auto &trackFactory = TrackFactory::Get( project );
+   auto rate = settings.GetRate();
+   auto &selectedRegion = ViewInfo::Get( project ).selectedRegion;
+   auto &window = ProjectWindow::Get( project );
+
+   // Make sure there's no activity since the effects are about to be
+   // applied to the project's tracks
+   ProjectAudioManager::Get( project ).Stop();
+   SelectUtilities::SelectAllIfNone( project );
+
+   MissingAliasFilesDialog::SetShouldShow(true);
+
+   EffectManager & em = EffectManager::Get();
+   em.SetSkipStateFlag( false );
+
+   std::vector<Effect*> effects;
+   for (const auto &ID : IDs) {
+      auto effect = em.GetEffect(ID);
+      if (!effect)
+         return false;
+      effects.push_back(effect);
+   }
+
+   const bool success = Effect::DoEffectChain(
+      effects, rate, &tracks, &trackFactory, selectedRegion );
+
+   if (!success)
+      MenuManager::Get(project).UpdateMenus( false );
+
+   // PRL:  RedrawProject explicitly because history push is skipped
+   window.RedrawProject();
+
+   return success;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 BEGIN_EVENT_TABLE(EffectDialog, wxDialogWrapper)
    EVT_BUTTON(wxID_OK, EffectDialog::OnOk)
@@ -230,6 +230,11 @@ namespace  EffectUI {
    bool DoEffect(
       const PluginID & ID, const CommandContext &context, unsigned flags );
 
+   // Apply configured effects in turn, without prompting or pushing history,
+   // as for a macro
+   bool DoEffectChain(
+      const std::vector<PluginID> &IDs, const CommandContext &context );
+
 }
 
 class ShuttleGui;
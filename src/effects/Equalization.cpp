@@ -55,9 +55,11 @@
 #include "../Audacity.h"
 #include "Equalization.h"
 #include "LoadEffects.h"
+#include "PartitionedConvolver.h"
 
 #include "../Experimental.h"
 
+#include <algorithm>
 #include <math.h>
 #include <vector>
 
@@ -97,6 +99,7 @@
 #include "../EnvelopeEditor.h"
 #include "../widgets/ErrorDialog.h"
 #include "../FFT.h"
+#include "../OrderedParallelJobs.h"
 #include "../Prefs.h"
 #include "../Project.h"
 #include "../TrackArtist.h"
@@ -114,11 +117,6 @@
 
 #include "FileDialog.h"
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-#include "Equalization48x.h"
-#endif
-
-
 enum
 {
    ID_Length = 10000,
@@ -135,14 +133,6 @@ enum
    ID_Curve,
    ID_Manage,
    ID_Delete,
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   ID_DefaultMath,
-   ID_SSE,
-   ID_SSEThreaded,
-   ID_AVX,
-   ID_AVXThreaded,
-   ID_Bench,
-#endif
    ID_Slider,   // needs to come last
 };
 
@@ -231,19 +221,10 @@ BEGIN_EVENT_TABLE(EffectEqualization, wxEvtHandler)
    EVT_CHECKBOX(ID_Linear, EffectEqualization::OnLinFreq)
    EVT_CHECKBOX(ID_Grid, EffectEqualization::OnGridOnOff)
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   EVT_RADIOBUTTON(ID_DefaultMath, EffectEqualization::OnProcessingRadio)
-   EVT_RADIOBUTTON(ID_SSE, EffectEqualization::OnProcessingRadio)
-   EVT_RADIOBUTTON(ID_SSEThreaded, EffectEqualization::OnProcessingRadio)
-   EVT_RADIOBUTTON(ID_AVX, EffectEqualization::OnProcessingRadio)
-   EVT_RADIOBUTTON(ID_AVXThreaded, EffectEqualization::OnProcessingRadio)
-   EVT_BUTTON(ID_Bench, EffectEqualization::OnBench)
-#endif
 END_EVENT_TABLE()
 
 EffectEqualization::EffectEqualization(int Options)
-   : mFFTBuffer{ windowSize }
-   , mFilterFuncR{ windowSize }
+   : mFilterFuncR{ windowSize }
    , mFilterFuncI{ windowSize }
 {
    mOptions = Options;
@@ -253,8 +234,6 @@ EffectEqualization::EffectEqualization(int Options)
    mPanel = NULL;
    mMSlider = NULL;
 
-   hFFT = GetFFT(windowSize);
-
    SetLinearEffectFlag(true);
 
    mM = DEF_FilterLength;
@@ -300,16 +279,6 @@ EffectEqualization::EffectEqualization(int Options)
    mWhenSliders[NUMBER_OF_BANDS] = 1.;
    mEQVals[NUMBER_OF_BANDS] = 0.;
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   bool useSSE;
-   GetPrivateConfig(GetCurrentSettingsGroup(), wxT("/SSE/GUI"), useSSE, false);
-   if(useSSE && !mEffectEqualization48x)
-      mEffectEqualization48x = std::make_unique<EffectEqualization48x>();
-   else if(!useSSE)
-      mEffectEqualization48x.reset();
-   mBench=false;
-#endif
-
    // We expect these Hi and Lo frequences to be overridden by Init().
    // Don't use inputTracks().  See bug 2321.
 #if 0
@@ -707,16 +676,6 @@ bool EffectEqualization::Init()
 
 bool EffectEqualization::Process()
 {
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   if(mEffectEqualization48x) {
-      if(mBench) {
-         mBench=false;
-         return mEffectEqualization48x->Benchmark(this);
-      }
-      else
-         return mEffectEqualization48x->Process(this);
-   }
-#endif
    this->CopyInputTracks(); // Set up mOutputTracks.
    CalcFilter();
    bool bGoodResult = true;
@@ -1083,63 +1042,6 @@ void EffectEqualization::PopulateOrExchange(ShuttleGui & S)
    }
    S.EndMultiColumn();
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   if (mEffectEqualization48x)
-   {
-      // -------------------------------------------------------------------
-      // ROW 6: Processing routine selection
-      // -------------------------------------------------------------------
-
-      // Column 1 is blank
-      S.AddSpace(1, 1);
-
-      S.StartHorizontalLay();
-      {
-         S.AddUnits(XO("&Processing: "));
-
-         // update the control state
-         int mathPath = EffectEqualization48x::GetMathPath();
-         int value =
-            (mathPath & MATH_FUNCTION_SSE)
-            ? (mathPath & MATH_FUNCTION_THREADED)
-               ? 2
-               : 1
-            : false // (mathPath & MATH_FUNCTION_AVX) // not implemented
-               ? (mathPath & MATH_FUNCTION_THREADED)
-                  ? 4
-                  : 3
-               : 0;
-
-         mMathProcessingType[0] = S.Id(ID_DefaultMath)
-            .AddRadioButton(XO("D&efault"),
-                            0, value);
-         mMathProcessingType[1] = S.Id(ID_SSE)
-            .Disable(!EffectEqualization48x::GetMathCaps()->SSE)
-            .AddRadioButtonToGroup(XO("&SSE"),
-                                   1, value);
-         mMathProcessingType[2] = S.Id(ID_SSEThreaded)
-            .Disable(!EffectEqualization48x::GetMathCaps()->SSE)
-            .AddRadioButtonToGroup(XO("SSE &Threaded"),
-                                   2, value);
-         mMathProcessingType[3] = S.Id(ID_AVX)
-            // not implemented
-            .Disable(true /* !EffectEqualization48x::GetMathCaps()->AVX */)
-            .AddRadioButtonToGroup(XO("A&VX"),
-                                   3, value);
-         mMathProcessingType[4] = S.Id(ID_AVXThreaded)
-            // not implemented
-            .Disable(true /* !EffectEqualization48x::GetMathCaps()->AVX */)
-            .AddRadioButtonToGroup(XO("AV&X Threaded"),
-                                   4, value);
-         S.Id(ID_Bench).AddButton(XO("&Bench"));
-      }
-      S.EndHorizontalLay();
-
-      // Column 3 is blank
-      S.AddSpace(1, 1);
-   }
-#endif
-
    mUIParent->SetAutoLayout(false);
    if( mOptions != kEqOptionGraphic)
       mUIParent->Layout();
@@ -1292,84 +1194,101 @@ bool EffectEqualization::ProcessOne(int count, WaveTrack * t,
    t->ConvertToSampleFormat( floatSample );
 
    wxASSERT(mM - 1 < windowSize);
-   size_t L = windowSize - (mM - 1);   //Process L samples at a go
-   auto s = start;
-   auto idealBlockLen = t->GetMaxBlockSize() * 4;
-   if (idealBlockLen % L != 0)
-      idealBlockLen += (L - (idealBlockLen % L));
 
-   Floats buffer{ idealBlockLen };
-
-   Floats window1{ windowSize };
-   Floats window2{ windowSize };
-   float *thisWindow = window1.get();
-   float *lastWindow = window2.get();
-
-   auto originalLen = len;
+   // The filter's impulse response, mM samples long; convolving with it
+   // gives the same output as filtering windows in the frequency domain,
+   // but with transforms sized to suit the response, not the window
+   Floats impulse{ windowSize };
+   InverseRealFFT(windowSize,
+      mFilterFuncR.get(), mFilterFuncI.get(), impulse.get());
+   const auto blockSize = PartitionedConvolver::ThroughputBlockSize(mM);
+
+   const auto idealBlockLen = t->GetMaxBlockSize() * 4;
+   const auto originalLen = len;
+
+   // Divide the output, which includes mM-1 samples of 'tail', into
+   // segments of about a million samples, a whole number of blocks each.
+   // Each segment also convolves up to mM-1 samples of input before it, so
+   // that its output is just as if the whole selection were convolved at
+   // once
+   struct Segment {
+      sampleCount offset;
+      size_t len;
+      Floats output;
+   };
+   const auto segmentLen =
+      std::max<size_t>(1, (1 << 20) / idealBlockLen) * idealBlockLen;
+   const auto outputLen = originalLen + (mM - 1);
+   std::vector<Segment> segments;
+   for (sampleCount offset = 0; offset < outputLen; offset += segmentLen)
+      segments.push_back({ offset,
+         limitSampleBufferSize( segmentLen, outputLen - offset ), {} });
+
+   OrderedParallelJobs parallelJobs{
+      OrderedParallelJobs::DefaultThreadCount(segments.size()) };
+
+   const auto convolve = [&](PartitionedConvolver &convolver,
+      float *buffer, Segment &segment) {
+      convolver.Reset();
+      const auto warmUp = std::min(segment.offset, sampleCount{ mM - 1 });
+      auto pos = segment.offset - warmUp;
+      // Output lags input by the latency of the convolver
+      auto skip = warmUp + convolver.GetLatency();
+      segment.output.reinit(segment.len);
+      size_t filled = 0;
+      while (filled < segment.len && !parallelJobs.Cancelled()) {
+         const auto block =
+            limitSampleBufferSize( idealBlockLen, skip + (segment.len - filled) );
+         // Input beyond the selection is silence
+         const auto available =
+            limitSampleBufferSize( block, originalLen - pos );
+         if (available > 0)
+            t->Get((samplePtr)buffer, floatSample, start + pos, available);
+         std::fill(buffer + available, buffer + block, 0.0f);
+         pos += block;
+
+         convolver.Process(buffer, buffer, block);
+         const auto begin = limitSampleBufferSize( block, skip );
+         skip -= begin;
+         std::copy(buffer + begin, buffer + block, &segment.output[filled]);
+         filled += block - begin;
+      }
+   };
 
-   for(size_t i = 0; i < windowSize; i++)
-      lastWindow[i] = 0;
+   // Each thread has its own convolver and buffer
+   std::vector< std::unique_ptr<PartitionedConvolver> > convolvers;
+   std::vector< Floats > buffers;
+   for (size_t ii = 0; ii < parallelJobs.ThreadCount(); ++ii) {
+      convolvers.push_back( std::make_unique<PartitionedConvolver>(
+         impulse.get(), mM, blockSize ) );
+      buffers.emplace_back( idealBlockLen );
+   }
 
    TrackProgress(count, 0.);
-   bool bLoopSuccess = true;
-   size_t wcopy = 0;
    int offset = (mM - 1) / 2;
 
-   while (len != 0)
-   {
-      auto block = limitSampleBufferSize( idealBlockLen, len );
-
-      t->Get((samplePtr)buffer.get(), floatSample, s, block);
-
-      for(size_t i = 0; i < block; i += L)   //go through block in lumps of length L
-      {
-         wcopy = std::min <size_t> (L, block - i);
-         for(size_t j = 0; j < wcopy; j++)
-            thisWindow[j] = buffer[i+j];   //copy the L (or remaining) samples
-         for(auto j = wcopy; j < windowSize; j++)
-            thisWindow[j] = 0;   //this includes the padding
-
-         Filter(windowSize, thisWindow);
-
-         // Overlap - Add
-         for(size_t j = 0; (j < mM - 1) && (j < wcopy); j++)
-            buffer[i+j] = thisWindow[j] + lastWindow[L + j];
-         for(size_t j = mM - 1; j < wcopy; j++)
-            buffer[i+j] = thisWindow[j];
-
-         std::swap( thisWindow, lastWindow );
-      }  //next i, lump of this block
-
-      output->Append((samplePtr)buffer.get(), floatSample, block);
-      len -= block;
-      s += block;
-
-      if (TrackProgress(count, ( s - start ).as_double() /
-                        originalLen.as_double()))
-      {
-         bLoopSuccess = false;
-         break;
-      }
-   }
+   const bool bLoopSuccess = parallelJobs.Run( segments.size(),
+      [&](size_t thread, size_t ii) {
+         convolve(*convolvers[thread], buffers[thread].get(), segments[ii]);
+      },
+      // Only this thread appends to the output track, taking segments in
+      // order
+      [&](size_t ii) {
+         auto &segment = segments[ii];
+         output->Append((samplePtr)segment.output.get(), floatSample,
+            segment.len);
+         segment.output.reset();
+      },
+      [&](size_t nTaken) {
+         // Update the Progress meter, let user cancel
+         const auto done = nTaken < segments.size()
+            ? segments[nTaken].offset : outputLen;
+         return !TrackProgress(count,
+            done.as_double() / outputLen.as_double());
+      } );
 
    if(bLoopSuccess)
    {
-      // mM-1 samples of 'tail' left in lastWindow, get them now
-      if(wcopy < (mM - 1)) {
-         // Still have some overlap left to process
-         // (note that lastWindow and thisWindow have been exchanged at this point
-         //  so that 'thisWindow' is really the window prior to 'lastWindow')
-         size_t j = 0;
-         for(; j < mM - 1 - wcopy; j++)
-            buffer[j] = lastWindow[wcopy + j] + thisWindow[L + wcopy + j];
-         // And fill in the remainder after the overlap
-         for( ; j < mM - 1; j++)
-            buffer[j] = lastWindow[wcopy + j];
-      } else {
-         for(size_t j = 0; j < mM - 1; j++)
-            buffer[j] = lastWindow[wcopy + j];
-      }
-      output->Append((samplePtr)buffer.get(), floatSample, mM - 1);
       output->Flush();
 
       // now move the appropriate bit of the output back to the track
@@ -1546,31 +1465,6 @@ bool EffectEqualization::CalcFilter()
    return TRUE;
 }
 
-void EffectEqualization::Filter(size_t len, float *buffer)
-{
-   float re,im;
-   // Apply FFT
-   RealFFTf(buffer, hFFT.get());
-   //FFT(len, false, inr, NULL, outr, outi);
-
-   // Apply filter
-   // DC component is purely real
-   mFFTBuffer[0] = buffer[0] * mFilterFuncR[0];
-   for(size_t i = 1; i < (len / 2); i++)
-   {
-      re=buffer[hFFT->BitReversed[i]  ];
-      im=buffer[hFFT->BitReversed[i]+1];
-      mFFTBuffer[2*i  ] = re*mFilterFuncR[i] - im*mFilterFuncI[i];
-      mFFTBuffer[2*i+1] = re*mFilterFuncI[i] + im*mFilterFuncR[i];
-   }
-   // Fs/2 component is purely real
-   mFFTBuffer[1] = buffer[1] * mFilterFuncR[len/2];
-
-   // Inverse FFT and normalization
-   InverseRealFFTf(mFFTBuffer.get(), hFFT.get());
-   ReorderToTime(hFFT.get(), mFFTBuffer.get(), buffer);
-}
-
 //
 // Load external curves with fallback to default, then message
 //
@@ -3016,35 +2910,6 @@ void EffectEqualization::OnLinFreq(wxCommandEvent & WXUNUSED(event))
    ForceRecalc();
 }
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-
-void EffectEqualization::OnProcessingRadio(wxCommandEvent & event)
-{
-   int testEvent=event.GetId();
-   switch(testEvent)
-   {
-   case ID_DefaultMath: EffectEqualization48x::SetMathPath(MATH_FUNCTION_ORIGINAL);
-      break;
-   case ID_SSE: EffectEqualization48x::SetMathPath(MATH_FUNCTION_SSE);
-      break;
-   case ID_SSEThreaded: EffectEqualization48x::SetMathPath(MATH_FUNCTION_THREADED | MATH_FUNCTION_SSE);
-      break;
-   case ID_AVX: testEvent = 2;
-      break;
-   case ID_AVXThreaded: testEvent = 2;
-      break;
-   }
-
-};
-
-void EffectEqualization::OnBench( wxCommandEvent & event)
-{
-   mBench=true;
-   // OnOk(event);
-}
-
-#endif
-
 //----------------------------------------------------------------------------
 // EqualizationPanel
 //----------------------------------------------------------------------------
@@ -0,0 +1,138 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  EqualizationBenchmark.cpp
+
+*******************************************************************//**
+
+\file EqualizationBenchmark.cpp
+\brief Measures Equalization on synthetic noise.
+
+  For each of several filter lengths, the convolution engine alone runs
+on one thread with every partition size near the one the effect would
+choose, and then the effect processes a whole track as it would for the
+user, on all its threads.  The input is made with a fixed seed, so runs
+on different machines do the same work:
+
+   audacity --equalization-benchmark
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "EqualizationBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <wx/string.h>
+
+#include "Equalization.h"
+#include "PartitionedConvolver.h"
+#include "../DirManager.h"
+#include "../FFT.h"
+#include "../SampleFormat.h"
+#include "../ViewInfo.h"
+#include "../WaveTrack.h"
+
+namespace {
+
+const size_t FilterLengths[] = { 21, 511, 4001, 8191 };
+
+const double Rate = 44100.0;
+// Samples for the engine alone, and for the effect
+const size_t EngineLen = 1 << 20;
+const size_t TrackLen = 1 << 22;
+// Samples given to the engine at a time
+const size_t ChunkLen = 4096;
+
+void MakeNoise(float *buffer, size_t len, unsigned &seed)
+{
+   for (size_t ii = 0; ii < len; ++ii) {
+      seed = seed * 1664525u + 1013904223u;
+      buffer[ii] = 0.5f * ((seed >> 8) / float(1 << 24) - 0.5f);
+   }
+}
+
+wxString FormatRow( size_t length, const char *path, size_t blockSize,
+   bool chosen, size_t nThreads, double seconds, size_t len )
+{
+   return wxString::Format(
+      "%6lu %-7s %9lu%s %7lu %10.1f %12.1f\n",
+      (unsigned long)length, path, (unsigned long)blockSize,
+      chosen ? "*" : " ", (unsigned long)nThreads,
+      1000.0 * seconds, len / (1e6 * std::max(seconds, 1e-9)));
+}
+
+}
+
+wxString RunEqualizationBenchmark( const ProjectSettings &settings )
+{
+   using Clock = std::chrono::steady_clock;
+
+   wxString result;
+   result += wxString::Format(
+      "%6s %-7s %10s %7s %10s %12s\n",
+      "length", "path", "partition", "threads", "ms", "Msamples/s");
+
+   unsigned seed = 12345u;
+   Floats input{ EngineLen };
+   MakeNoise(input.get(), EngineLen, seed);
+   Floats buffer{ ChunkLen };
+
+   ZoomInfo zoomInfo(0.0, ZoomInfo::GetDefaultZoom());
+   auto dd = DirManager::Create();
+   TrackFactory factory{ settings, dd, &zoomInfo };
+   auto track = factory.NewWaveTrack(floatSample, Rate);
+   {
+      Floats samples{ EngineLen };
+      for (size_t done = 0; done < TrackLen; done += EngineLen) {
+         MakeNoise(samples.get(), EngineLen, seed);
+         track->Append((samplePtr)samples.get(), floatSample, EngineLen);
+      }
+      track->Flush();
+   }
+
+   EffectEqualization effect;
+   effect.mLoFreq = EffectEqualization::loFreqI;
+   effect.mHiFreq = Rate / 2.0;
+
+   for (const auto length : FilterLengths) {
+      effect.mM = length;
+      effect.CalcFilter();
+
+      const auto windowSize = EffectEqualization::windowSize;
+      Floats impulse{ windowSize };
+      InverseRealFFT(windowSize, effect.mFilterFuncR.get(),
+         effect.mFilterFuncI.get(), impulse.get());
+
+      // The engine alone, with partitions from an eighth to eight times
+      // the size that the effect chooses
+      const auto chosen = PartitionedConvolver::ThroughputBlockSize(length);
+      for (auto blockSize = PartitionedConvolver::BlockSizeFor(chosen / 8);
+           blockSize <= chosen * 8; blockSize *= 2) {
+         PartitionedConvolver convolver{ impulse.get(), length, blockSize };
+         const auto start = Clock::now();
+         for (size_t done = 0; done < EngineLen; done += ChunkLen) {
+            std::copy(&input[done], &input[done] + ChunkLen, buffer.get());
+            convolver.Process(buffer.get(), buffer.get(), ChunkLen);
+         }
+         const std::chrono::duration<double> elapsed = Clock::now() - start;
+         result += FormatRow(length, "engine", blockSize,
+            blockSize == chosen, 1, elapsed.count(), EngineLen);
+         if (blockSize == PartitionedConvolver::BlockSizeFor(blockSize * 2))
+            break;
+      }
+
+      // The whole effect, reading and writing the track
+      const auto start = Clock::now();
+      effect.ProcessOne(0, track.get(), 0, TrackLen);
+      const std::chrono::duration<double> elapsed = Clock::now() - start;
+      result += FormatRow(length, "effect", chosen, true,
+         std::max<size_t>(1, std::thread::hardware_concurrency()),
+         elapsed.count(), TrackLen);
+   }
+
+   return result;
+}
@@ -0,0 +1,20 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  EqualizationBenchmark.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_EQUALIZATION_BENCHMARK__
+#define __AUDACITY_EQUALIZATION_BENCHMARK__
+
+class ProjectSettings;
+class wxString;
+
+// Filters synthetic noise with Equalization at several filter lengths, and
+// returns a plain text report of the time taken by the convolution engine
+// with each partition size, and by the effect with the size it chooses
+wxString RunEqualizationBenchmark( const ProjectSettings &settings );
+
+#endif // define __AUDACITY_EQUALIZATION_BENCHMARK__
@@ -81,12 +81,82 @@ unsigned EffectFade::GetAudioOutCount()
 
 bool EffectFade::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelNames WXUNUSED(chanMap))
 {
-   mSample = 0;
+   mMaster.sample = 0;
+   mMaster.len = mSampleCnt;
 
    return true;
 }
 
 size_t EffectFade::ProcessBlock(float **inBlock, float **outBlock, size_t blockLen)
+{
+   return InstanceProcess(mMaster, inBlock, outBlock, blockLen);
+}
+
+bool EffectFade::RealtimeInitialize()
+{
+   mSlaves.clear();
+
+   return true;
+}
+
+bool EffectFade::RealtimeFinalize()
+{
+   mSlaves.clear();
+
+   return true;
+}
+
+size_t EffectFade::RealtimeProcess(int group,
+                                   float **inbuf,
+                                   float **outbuf,
+                                   size_t numSamples)
+{
+   return InstanceProcess(mSlaves[group], inbuf, outbuf, numSamples);
+}
+
+// Effect implementation
+
+bool EffectFade::SupportsParallelProcessing()
+{
+   return true;
+}
+
+bool EffectFade::SupportsChaining()
+{
+   return true;
+}
+
+bool EffectFade::SupportsSegmentedProcessing(
+   double WXUNUSED(sampleRate), size_t &warmUp)
+{
+   // The gain depends only on the position
+   warmUp = 0;
+   return true;
+}
+
+bool EffectFade::AddParallelProcessor(unsigned WXUNUSED(numChannels),
+   ChannelNames WXUNUSED(chanMap), float WXUNUSED(sampleRate),
+   sampleCount start, sampleCount len)
+{
+   mSlaves.push_back({ start, len });
+
+   return true;
+}
+
+bool EffectFade::ResetParallelProcessor(int group,
+   unsigned WXUNUSED(numChannels), ChannelNames WXUNUSED(chanMap),
+   float WXUNUSED(sampleRate),
+   sampleCount start, sampleCount len)
+{
+   mSlaves[group] = { start, len };
+
+   return true;
+}
+
+// EffectFade implementation
+
+size_t EffectFade::InstanceProcess(EffectFadeState &data,
+   float **inBlock, float **outBlock, size_t blockLen)
 {
    float *ibuf = inBlock[0];
    float *obuf = outBlock[0];
@@ -96,8 +166,8 @@ size_t EffectFade::ProcessBlock(float **inBlock, float **outBlock, size_t blockL
       for (decltype(blockLen) i = 0; i < blockLen; i++)
       {
          obuf[i] =
-            (ibuf[i] * ( mSample++ ).as_float()) /
-            mSampleCnt.as_float();
+            (ibuf[i] * ( data.sample++ ).as_float()) /
+            data.len.as_float();
       }
    }
    else
@@ -105,8 +175,8 @@ size_t EffectFade::ProcessBlock(float **inBlock, float **outBlock, size_t blockL
       for (decltype(blockLen) i = 0; i < blockLen; i++)
       {
          obuf[i] = (ibuf[i] *
-                    ( mSampleCnt - 1 - mSample++ ).as_float()) /
-            mSampleCnt.as_float();
+                    ( data.len - 1 - data.sample++ ).as_float()) /
+            data.len.as_float();
       }
    }
 
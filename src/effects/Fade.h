@@ -13,6 +13,17 @@
 
 #include "Effect.h"
 
+// Where a processor is in the selection it fades
+class EffectFadeState
+{
+public:
+   EffectFadeState(sampleCount sample_ = 0, sampleCount len_ = 0)
+      : sample{ sample_ }, len{ len_ } {}
+
+   sampleCount sample;
+   sampleCount len;
+};
+
 class EffectFade : public Effect
 {
 public:
@@ -35,12 +46,33 @@ public:
    unsigned GetAudioOutCount() override;
    bool ProcessInitialize(sampleCount totalLen, ChannelNames chanMap = NULL) override;
    size_t ProcessBlock(float **inBlock, float **outBlock, size_t blockLen) override;
+   bool RealtimeInitialize() override;
+   bool RealtimeFinalize() override;
+   size_t RealtimeProcess(int group,
+                               float **inbuf,
+                               float **outbuf,
+                               size_t numSamples) override;
+
+   // Effect implementation
+
+   bool SupportsParallelProcessing() override;
+   bool SupportsSegmentedProcessing(double sampleRate, size_t &warmUp) override;
+   bool AddParallelProcessor(unsigned numChannels, ChannelNames chanMap,
+      float sampleRate, sampleCount start, sampleCount len) override;
+   bool ResetParallelProcessor(int group, unsigned numChannels,
+      ChannelNames chanMap, float sampleRate,
+      sampleCount start, sampleCount len) override;
+   bool SupportsChaining() override;
 
 private:
    // EffectFade implementation
 
+   size_t InstanceProcess(EffectFadeState &data,
+      float **inBlock, float **outBlock, size_t blockLen);
+
    bool mFadeIn;
-   sampleCount mSample;
+   EffectFadeState mMaster;
+   std::vector<EffectFadeState> mSlaves;
 };
 
 class EffectFadeIn final : public EffectFade
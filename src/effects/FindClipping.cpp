@@ -161,80 +161,72 @@ bool EffectFindClipping::ProcessOne(LabelTrack * lt,
                                     sampleCount len)
 {
    bool bGoodResult = true;
-   size_t blockSize = (mStart * 1000);
 
    if (len < mStart) {
       return true;
    }
 
-   Floats buffer;
-   try {
-      // mStart should be positive.
-      // if we are throwing bad_alloc and mStart is negative, find out why.
-      if (mStart < 0 || (int)blockSize < mStart)
-         // overflow
-         throw std::bad_alloc{};
-      buffer.reinit(blockSize);
-   }
-   catch( const std::bad_alloc & ) {
-      Effect::MessageBox( XO("Requested value exceeds memory capacity.") );
-      return false;
-   }
-
-   float *ptr = buffer.get();
-
    decltype(len) s = 0, startrun = 0, stoprun = 0, samps = 0;
-   decltype(blockSize) block = 0;
    double startTime = -1.0;
 
-   while (s < len) {
-      if (block == 0) {
-         if (TrackProgress(count,
-                           s.as_double() /
-                           len.as_double() )) {
-            bGoodResult = false;
-            break;
-         }
-
-         block = limitSampleBufferSize( blockSize, len - s );
-
-         wt->Get((samplePtr)buffer.get(), floatSample, start + s, block);
-         ptr = buffer.get();
+   // Take the clipped samples from s up to next
+   const auto takeClipped = [&](sampleCount next) {
+      if (startrun == 0) {
+         startTime = wt->LongSamplesToTime(start + s);
+         samps = 0;
       }
-
-      float v = fabs(*ptr++);
-      if (v >= MAX_AUDIO) {
-         if (startrun == 0) {
-            startTime = wt->LongSamplesToTime(start + s);
+      stoprun = 0;
+      startrun += next - s;
+      samps += next - s;
+      s = next;
+   };
+
+   // Take the unclipped samples from s up to next
+   const auto takeUnclipped = [&](sampleCount next) {
+      if (startrun >= mStart) {
+         if (stoprun + (next - s) >= mStop) {
+            // The sample that makes stoprun reach mStop ends the run
+            const auto last = s + (mStop - stoprun) - 1;
+            samps += last + 1 - s;
+            lt->AddLabel(SelectedRegion(startTime,
+                                       wt->LongSamplesToTime(start + last - mStop)),
+                        wxString::Format(wxT("%lld of %lld"), startrun.as_long_long(), (samps - mStop).as_long_long()));
+            startrun = 0;
+            stoprun = 0;
             samps = 0;
          }
          else {
-            stoprun = 0;
+            stoprun += next - s;
+            samps += next - s;
          }
-         startrun++;
-         samps++;
       }
       else {
-         if (startrun >= mStart) {
-            stoprun++;
-            samps++;
-
-            if (stoprun >= mStop) {
-               lt->AddLabel(SelectedRegion(startTime,
-                                          wt->LongSamplesToTime(start + s - mStop)),
-                           wxString::Format(wxT("%lld of %lld"), startrun.as_long_long(), (samps - mStop).as_long_long()));
-               startrun = 0;
-               stoprun = 0;
-               samps = 0;
-            }
-         }
-         else {
-            startrun = 0;
-         }
+         startrun = 0;
       }
+      s = next;
+   };
 
-      s++;
-      block--;
+   // The runs below full scale come from the block summaries where they
+   // can; the samples between them are clipped
+   const auto blockSize = wt->GetMaxBlockSize();
+   while (s < len) {
+      if (TrackProgress(count,
+                        s.as_double() /
+                        len.as_double() )) {
+         bGoodResult = false;
+         break;
+      }
+
+      const auto end = s + limitSampleBufferSize( blockSize, len - s );
+      const auto runs =
+         wt->FindQuietRuns(start + s, start + end, MAX_AUDIO, 1);
+      for (const auto &run : runs) {
+         if (run.first - start > s)
+            takeClipped(run.first - start);
+         takeUnclipped(run.second - start);
+      }
+      if (s < end)
+         takeClipped(end);
    }
 
    return bGoodResult;
@@ -82,3 +82,50 @@ size_t EffectInvert::ProcessBlock(float **inBlock, float **outBlock, size_t bloc
 
    return blockLen;
 }
+
+bool EffectInvert::RealtimeInitialize()
+{
+   return true;
+}
+
+bool EffectInvert::RealtimeFinalize()
+{
+   return true;
+}
+
+size_t EffectInvert::RealtimeProcess(int WXUNUSED(group),
+                                     float **inbuf,
+                                     float **outbuf,
+                                     size_t numSamples)
+{
+   // No state to keep per processor
+   return ProcessBlock(inbuf, outbuf, numSamples);
+}
+
+// Effect implementation
+
+bool EffectInvert::SupportsParallelProcessing()
+{
+   return true;
+}
+
+bool EffectInvert::SupportsChaining()
+{
+   return true;
+}
+
+bool EffectInvert::SupportsSegmentedProcessing(
+   double WXUNUSED(sampleRate), size_t &warmUp)
+{
+   warmUp = 0;
+   return true;
+}
+
+bool EffectInvert::ResetParallelProcessor(int WXUNUSED(group),
+   unsigned WXUNUSED(numChannels), ChannelNames WXUNUSED(chanMap),
+   float WXUNUSED(sampleRate),
+   sampleCount WXUNUSED(start), sampleCount WXUNUSED(len))
+{
+   // No state to keep per processor
+   return true;
+}
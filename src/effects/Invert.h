@@ -38,6 +38,21 @@ public:
    unsigned GetAudioInCount() override;
    unsigned GetAudioOutCount() override;
    size_t ProcessBlock(float **inBlock, float **outBlock, size_t blockLen) override;
+   bool RealtimeInitialize() override;
+   bool RealtimeFinalize() override;
+   size_t RealtimeProcess(int group,
+                               float **inbuf,
+                               float **outbuf,
+                               size_t numSamples) override;
+
+   // Effect implementation
+
+   bool SupportsParallelProcessing() override;
+   bool SupportsSegmentedProcessing(double sampleRate, size_t &warmUp) override;
+   bool ResetParallelProcessor(int group, unsigned numChannels,
+      ChannelNames chanMap, float sampleRate,
+      sampleCount start, sampleCount len) override;
+   bool SupportsChaining() override;
 };
 
 #endif
@@ -442,6 +442,18 @@ bool EffectLoudness::ProcessOne(TrackIterRange<WaveTrack> range, bool analyse)
    if(mCurT1 <= mCurT0)
       return false;
 
+   if(analyse)
+   {
+      // Measure hops of the gating blocks, on a grid fixed to the start of
+      // the track, so that powers kept by the clips serve any later
+      // selection
+      const auto hopSize = EBUR128::HopSize(mCurRate);
+      const auto firstHop = (start + hopSize - 1) / hopSize;
+      const auto endHop = end / hopSize;
+      if(endHop >= firstHop + EBUR128::HOPS_PER_BLOCK)
+         return AnalyseHops(range, start, end);
+   }
+
    // Go through the track one buffer at a time. s counts which
    // sample the current buffer starts at.
    auto s = start;
@@ -478,6 +490,86 @@ bool EffectLoudness::ProcessOne(TrackIterRange<WaveTrack> range, bool analyse)
    return true;
 }
 
+/// Finds K-weighted powers of the whole hops of each channel, which the
+/// clips may already know, and gives their sums to the loudness processor,
+/// between the powers of the partial hops at the edges of the selection.
+bool EffectLoudness::AnalyseHops(TrackIterRange<WaveTrack> range,
+                                 sampleCount start, sampleCount end)
+{
+   const auto hopSize = EBUR128::HopSize(mCurRate);
+   const auto firstHop = (start + hopSize - 1) / hopSize;
+   const auto endHop = end / hopSize;
+   const auto nHops = (endHop - firstHop).as_size_t();
+   const auto headEnd = firstHop * hopSize;
+   const auto tailStart = endHop * hopSize;
+
+   // The partial hops are weighted from their samples.  The filters start
+   // at rest at the start of the selection, and settle again over the last
+   // whole hop before the tail.
+   double headPower = 0, tailPower = 0;
+   if(!WeighSamples(range, start, headEnd, &headPower) ||
+      !WeighSamples(range, tailStart - hopSize, tailStart, nullptr) ||
+      !WeighSamples(range, tailStart, end, &tailPower))
+      return false;
+
+   const double hopsLen = double(nHops) * hopSize;
+   Doubles powers{ nHops, true };
+   const double share =
+      1.0 / (double(GetNumWaveTracks()) * double(mSteps) * mTrackLen);
+   for(auto channel : range)
+   {
+      // Measure the input track, not its copy, so that the powers its clips
+      // keep outlast this effect, and serve the next measurement
+      auto source = static_cast<const WaveTrack*>(GetInputTrack(channel));
+      if(!source)
+         source = channel;
+      const auto base = mProgressVal;
+      if(!source->AddLoudnessPowers(hopSize, firstHop, nHops, powers.get(),
+         EBUR128::MakeWeighting,
+         [&](sampleCount done)
+         {
+            mProgressVal =
+               base + std::min(done.as_double(), hopsLen) * share;
+            return !TotalProgress(mProgressVal, mProgressMsg);
+         }))
+         return false;
+      mProgressVal = base + hopsLen * share;
+   }
+
+   mLoudnessProcessor->ProcessPartialHop(headPower,
+      (headEnd - start).as_size_t());
+   mLoudnessProcessor->ProcessHopPowers(powers.get(), nHops);
+   mLoudnessProcessor->ProcessPartialHop(tailPower,
+      (end - tailStart).as_size_t());
+   return true;
+}
+
+/// Runs the loudness processor's weighting filters over the samples from
+/// pos to end, and adds their power to *power, or only lets the filters
+/// settle if power is null.
+bool EffectLoudness::WeighSamples(TrackIterRange<WaveTrack> range,
+                                  sampleCount pos, sampleCount end,
+                                  double *power)
+{
+   while(pos < end)
+   {
+      const auto blockLen = limitSampleBufferSize(
+         mTrackBufferCapacity, end - pos);
+      LoadBufferBlock(range, pos, blockLen);
+      const float *buffers[] = { mTrackBuffer[0].get(), mTrackBuffer[1].get() };
+      const auto weighted =
+         mLoudnessProcessor->WeightedPower(buffers, mTrackBufferLen);
+      if(power)
+      {
+         *power += weighted;
+         if(!UpdateProgress())
+            return false;
+      }
+      pos += blockLen;
+   }
+   return true;
+}
+
 void EffectLoudness::LoadBufferBlock(TrackIterRange<WaveTrack> range,
                                      sampleCount pos, size_t len)
 {
@@ -495,13 +587,8 @@ void EffectLoudness::LoadBufferBlock(TrackIterRange<WaveTrack> range,
 /// (for loudness).
 bool EffectLoudness::AnalyseBufferBlock()
 {
-   for(size_t i = 0; i < mTrackBufferLen; i++)
-   {
-      mLoudnessProcessor->ProcessSampleFromChannel(mTrackBuffer[0][i], 0);
-      if(mProcStereo)
-         mLoudnessProcessor->ProcessSampleFromChannel(mTrackBuffer[1][i], 1);
-      mLoudnessProcessor->NextSample();
-   }
+   const float *buffers[] = { mTrackBuffer[0].get(), mTrackBuffer[1].get() };
+   mLoudnessProcessor->ProcessBuffers(buffers, mTrackBufferLen);
 
    if(!UpdateProgress())
       return false;
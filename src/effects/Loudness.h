@@ -64,6 +64,10 @@ private:
    void FreeBuffers();
    bool GetTrackRMS(WaveTrack* track, float& rms);
    bool ProcessOne(TrackIterRange<WaveTrack> range, bool analyse);
+   bool AnalyseHops(TrackIterRange<WaveTrack> range,
+                    sampleCount start, sampleCount end);
+   bool WeighSamples(TrackIterRange<WaveTrack> range,
+                     sampleCount pos, sampleCount end, double *power);
    void LoadBufferBlock(TrackIterRange<WaveTrack> range,
                         sampleCount pos, size_t len);
    bool AnalyseBufferBlock();
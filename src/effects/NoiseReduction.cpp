@@ -50,6 +50,7 @@
 #include "../Prefs.h"
 #include "../RealFFTf.h"
 
+#include "../OrderedParallelJobs.h"
 #include "../WaveTrack.h"
 #include "../widgets/AudacityMessageBox.h"
 #include "../widgets/valnum.h"
@@ -253,7 +254,10 @@ EffectNoiseReduction::Settings::Settings()
 // EffectNoiseReduction::Worker
 //----------------------------------------------------------------------------
 
-// This object holds information needed only during effect calculation
+// This object holds information needed only during effect calculation.
+// Process() divides the selected tracks into segments and gives them to
+// other Workers, one on each thread, so that each has its own FFT
+// buffers and history queue.
 class EffectNoiseReduction::Worker
 {
 public:
@@ -268,44 +272,58 @@ public:
    ~Worker();
 
    bool Process(EffectNoiseReduction &effect,
-                Statistics &statistics, TrackFactory &factory,
+                Statistics &statistics,
                 TrackList &tracks, double mT0, double mT1);
 
 private:
-   bool ProcessOne(EffectNoiseReduction &effect,
-                   Statistics &statistics,
-                   TrackFactory &factory,
-                   int count, WaveTrack *track,
-                   sampleCount start, sampleCount len);
+   struct Segment;
+   void ProcessSegment(Statistics &statistics, const WaveTrack &track,
+                       sampleCount end, Segment &segment,
+                       const OrderedParallelJobs &parallelJobs);
 
    void StartNewTrack();
-   void ProcessSamples(Statistics &statistics,
-      WaveTrack *outputTrack, size_t len, float *buffer);
-   void FillFirstHistoryWindow();
+   void ProcessSamples(Statistics &statistics, size_t len, float *buffer);
+   void ProcessBatch(Statistics &statistics);
+   void FillFirstHistoryWindow(const float *spectrum);
    void ApplyFreqSmoothing(FloatVector &gains);
    void GatherStatistics(Statistics &statistics);
    inline bool Classify(const Statistics &statistics, int band);
-   void ReduceNoise(const Statistics &statistics, WaveTrack *outputTrack);
+   void ReduceNoise(const Statistics &statistics);
+   void OverlapAddBatch();
+   void Output(const float *buffer, size_t len);
    void RotateHistoryWindows();
    void FinishTrackStatistics(Statistics &statistics);
-   void FinishTrack(Statistics &statistics, WaveTrack *outputTrack);
+   void FinishTrack(Statistics &statistics);
 
 private:
 
+   const Settings mSettings;
    const bool mDoProfile;
 
    const double mSampleRate;
+#ifdef EXPERIMENTAL_SPECTRAL_EDITING
+   const double mF0;
+   const double mF1;
+#endif
 
    const size_t mWindowSize;
    // These have that size:
    HFFT     hFFT;
-   FloatVector mFFTBuffer;
    FloatVector mInWaveBuffer;
    FloatVector mOutOverlapBuffer;
    // These have that size, or 0:
    FloatVector mInWindow;
    FloatVector mOutWindow;
 
+   // Windowed frames wait here to be transformed several at once, and then
+   // so do the modified spectra of frames leaving the history queue
+   const size_t mBatchSize;
+   FloatVector mForwardBatch;
+   size_t mForwardCount;
+   FloatVector mInverseBatch;
+   size_t mInverseCount;
+   sampleCount mInverseFirstStep;
+
    const size_t mSpectrumSize;
    FloatVector mFreqSmoothingScratch;
    const size_t mFreqSmoothingBins;
@@ -333,6 +351,15 @@ private:
    unsigned  mCenter;
    unsigned  mHistoryLen;
 
+   // How many steps of input before a segment can affect its output
+   size_t    mWarmUpSteps;
+
+   // Output of the current segment, after dropping what is outside it
+   FloatVector mOutput;
+   sampleCount mOutSkip;
+   sampleCount mOutRemaining;
+   FloatVector mReadBuffer;
+
    struct Record
    {
       Record(size_t spectrumSize)
@@ -653,7 +680,7 @@ bool EffectNoiseReduction::Process()
 #endif
       );
    bool bGoodResult = worker.Process
-      (*this, *mStatistics, *mFactory, *mOutputTracks, mT0, mT1);
+      (*this, *mStatistics, *mOutputTracks, mT0, mT1);
    if (mSettings->mDoProfile) {
       if (bGoodResult)
          mSettings->mDoProfile = false; // So that "repeat last effect" will reduce noise
@@ -668,11 +695,35 @@ EffectNoiseReduction::Worker::~Worker()
 {
 }
 
+// A run of samples of one selected track, given to one thread
+struct EffectNoiseReduction::Worker::Segment
+{
+   size_t job;
+   // When profiling, the samples to examine; otherwise the samples to
+   // output, made from input that begins warmUp samples earlier and may
+   // continue to the end of the selection
+   sampleCount start;
+   sampleCount len;
+   sampleCount warmUp;
+
+   // Results
+   std::unique_ptr<Statistics> statistics;
+   FloatVector output;
+};
+
 bool EffectNoiseReduction::Worker::Process
-(EffectNoiseReduction &effect, Statistics &statistics, TrackFactory &factory,
+(EffectNoiseReduction &effect, Statistics &statistics,
  TrackList &tracks, double inT0, double inT1)
 {
-   int count = 0;
+   // The selected part of a selected track
+   struct Job {
+      WaveTrack *track;
+      sampleCount start;
+      sampleCount len;
+      WaveTrack::Holder outputTrack;
+   };
+   std::vector<Job> jobs;
+
    for ( auto track : tracks.Selected< WaveTrack >() ) {
       if (track->GetRate() != mSampleRate) {
          if (mDoProfile)
@@ -693,14 +744,107 @@ bool EffectNoiseReduction::Worker::Process
       if (t1 > t0) {
          auto start = track->TimeToLongSamples(t0);
          auto end = track->TimeToLongSamples(t1);
-         auto len = end - start;
+         jobs.push_back({ track, start, end - start,
+            mDoProfile ? nullptr : track->EmptyCopy() });
+      }
+   }
 
-         if (!ProcessOne(effect, statistics, factory,
-                         count, track, start, len))
-            return false;
+   // Divide the tracks into segments of about a million samples, a whole
+   // number of steps each
+   const auto segmentLen =
+      std::max<size_t>(1, (1 << 20) / mStepSize) * mStepSize;
+   std::vector<Segment> segments;
+   double totalLen = 0;
+   for (size_t ii = 0; ii < jobs.size(); ++ii) {
+      const auto &job = jobs[ii];
+      if (mDoProfile) {
+#ifdef OLD_METHOD_AVAILABLE
+         // Old statistics compare consecutive windows of the whole track
+         segments.push_back({ ii, job.start, job.len, 0 });
+#else
+         // Each window is examined alone, so segments just share out the
+         // whole windows, overlapping by less than one window
+         for (sampleCount offset = 0;
+              offset + mWindowSize <= job.len; offset += segmentLen) {
+            const auto len = std::min(job.len - offset,
+               sampleCount{ segmentLen - mStepSize + mWindowSize });
+            segments.push_back({ ii, job.start + offset, len, 0 });
+         }
+#endif
+      }
+      else {
+         // Begin each segment early enough that its output is just as if
+         // the whole track were processed at once
+         for (sampleCount offset = 0; offset < job.len; offset += segmentLen) {
+            const auto len =
+               std::min(job.len - offset, sampleCount{ segmentLen });
+            const auto warmUp =
+               std::min(offset, sampleCount{ mWarmUpSteps * mStepSize });
+            segments.push_back({ ii, job.start + offset, len, warmUp });
+         }
       }
-      ++count;
    }
+   for (const auto &segment : segments)
+      totalLen += segment.len.as_double();
+
+   OrderedParallelJobs parallelJobs{
+      OrderedParallelJobs::DefaultThreadCount(segments.size()) };
+
+   // Each thread has its own Worker, so that buffers are never shared
+   std::vector< std::unique_ptr<Worker> > workers;
+   for (size_t ii = 0; ii < parallelJobs.ThreadCount(); ++ii)
+      workers.push_back(std::make_unique<Worker>(mSettings, mSampleRate
+#ifdef EXPERIMENTAL_SPECTRAL_EDITING
+         , mF0, mF1
+#endif
+      ));
+
+   double doneLen = 0;
+   const bool bLoopSuccess = parallelJobs.Run( segments.size(),
+      [&](size_t thread, size_t ii) {
+         auto &segment = segments[ii];
+         const auto &job = jobs[segment.job];
+         workers[thread]->ProcessSegment(statistics, *job.track,
+            job.start + job.len, segment, parallelJobs);
+      },
+      // Only this thread writes the output tracks and the statistics, taking
+      // segments in order
+      [&](size_t ii) {
+         auto &segment = segments[ii];
+         auto &job = jobs[segment.job];
+         if (mDoProfile) {
+            const auto &partial = *segment.statistics;
+            for (size_t jj = 0; jj < mSpectrumSize; ++jj)
+               statistics.mSums[jj] += partial.mSums[jj];
+            statistics.mTrackWindows += partial.mTrackWindows;
+#ifdef OLD_METHOD_AVAILABLE
+            for (size_t jj = 0; jj < mSpectrumSize; ++jj)
+               statistics.mNoiseThreshold[jj] = std::max(
+                  statistics.mNoiseThreshold[jj],
+                  partial.mNoiseThreshold[jj]);
+#endif
+            segment.statistics.reset();
+
+            // Combine averages at the end of each track
+            if (ii + 1 == segments.size() ||
+                segments[ii + 1].job != segment.job)
+               FinishTrackStatistics(statistics);
+         }
+         else {
+            wxASSERT(segment.len == segment.output.size());
+            job.outputTrack->Append((samplePtr)segment.output.data(),
+               floatSample, segment.output.size());
+            FloatVector{}.swap(segment.output);
+         }
+         doneLen += segment.len.as_double();
+      },
+      [&](size_t) {
+         // Update the Progress meter, let user cancel
+         return !effect.TotalProgress(
+            totalLen > 0 ? doneLen / totalLen : 1.0);
+      } );
+   if (!bLoopSuccess)
+      return false;
 
    if (mDoProfile) {
       if (statistics.mTotalWindows == 0) {
@@ -709,6 +853,19 @@ bool EffectNoiseReduction::Worker::Process
          return false;
       }
    }
+   else {
+      for (auto &job : jobs) {
+         // Flush the output WaveTrack (since it's buffered)
+         job.outputTrack->Flush();
+
+         // Take the output track and insert it in place of the original
+         // sample data (as operated on -- this may not match mT0/mT1)
+         double t0 = job.outputTrack->LongSamplesToTime(job.start);
+         double tLen = job.outputTrack->LongSamplesToTime(job.len);
+         job.track->ClearAndPaste(
+            t0, t0 + tLen, &*job.outputTrack, true, false);
+      }
+   }
 
    return true;
 }
@@ -750,18 +907,29 @@ EffectNoiseReduction::Worker::Worker
 , double f0, double f1
 #endif
 )
-: mDoProfile(settings.mDoProfile)
+: mSettings(settings)
+, mDoProfile(settings.mDoProfile)
 
 , mSampleRate(sampleRate)
+#ifdef EXPERIMENTAL_SPECTRAL_EDITING
+, mF0(f0)
+, mF1(f1)
+#endif
 
 , mWindowSize(settings.WindowSize())
 , hFFT(GetFFT(mWindowSize))
-, mFFTBuffer(mWindowSize)
 , mInWaveBuffer(mWindowSize)
 , mOutOverlapBuffer(mWindowSize)
 , mInWindow()
 , mOutWindow()
 
+, mBatchSize(16)
+, mForwardBatch(mBatchSize * mWindowSize)
+, mForwardCount(0)
+, mInverseBatch(mBatchSize * mWindowSize)
+, mInverseCount(0)
+, mInverseFirstStep(0)
+
 , mSpectrumSize(1 + mWindowSize / 2)
 , mFreqSmoothingScratch(mSpectrumSize)
 , mFreqSmoothingBins((int)(settings.mFreqSmoothingBands))
@@ -779,6 +947,9 @@ EffectNoiseReduction::Worker::Worker
 , mInSampleCount(0)
 , mOutStepCount(0)
 , mInWavePos(0)
+
+, mOutSkip(0)
+, mOutRemaining(0)
 {
 #ifdef EXPERIMENTAL_SPECTRAL_EDITING
    {
@@ -821,6 +992,14 @@ EffectNoiseReduction::Worker::Worker
       mHistoryLen = std::max(mNWindowsToExamine, mCenter + nAttackBlocks);
    }
 
+   // Gains are at most 1, so release carries a window's gain no further
+   // than nReleaseBlocks windows before it falls to mNoiseAttenFactor.
+   // Classification looks at neighboring windows, and the start of a track
+   // is felt through the history queue and the zero-padded first windows.
+   // Input further back than all of that has no effect on the output.
+   mWarmUpSteps = mHistoryLen + mNWindowsToExamine + mStepsPerWindow
+      + nReleaseBlocks + 1;
+
    mQueue.resize(mHistoryLen);
    for (unsigned ii = 0; ii < mHistoryLen; ++ii)
       mQueue[ii] = std::make_unique<Record>(mSpectrumSize);
@@ -935,13 +1114,62 @@ void EffectNoiseReduction::Worker::StartNewTrack()
    }
 
    mInSampleCount = 0;
+   mForwardCount = 0;
+   mInverseCount = 0;
+}
+
+void EffectNoiseReduction::Worker::ProcessSegment
+(Statistics &statistics, const WaveTrack &track, sampleCount end,
+ Segment &segment, const OrderedParallelJobs &parallelJobs)
+{
+   StartNewTrack();
+
+   // Profiles are summed separately for each segment
+   if (mDoProfile) {
+      segment.statistics = std::make_unique<Statistics>
+         (mSpectrumSize, mSampleRate, mSettings.mWindowTypes);
+      end = segment.start + segment.len;
+   }
+   Statistics &target = mDoProfile ? *segment.statistics : statistics;
+
+   // Discard the output of the warm-up, and any beyond the segment
+   mOutput.clear();
+   mOutSkip = segment.warmUp;
+   mOutRemaining = mDoProfile ? 0 : segment.len;
+   if (!mDoProfile)
+      mOutput.reserve(segment.len.as_size_t());
+
+   mReadBuffer.resize(track.GetMaxBlockSize());
+   auto samplePos = segment.start - segment.warmUp;
+   while (!parallelJobs.Cancelled() && samplePos < end &&
+          (mDoProfile || mOutRemaining > 0)) {
+      //Get a blockSize of samples (smaller than the size of the buffer)
+      const auto blockSize = limitSampleBufferSize(
+         track.GetBestBlockSize(samplePos),
+         end - samplePos
+      );
+
+      //Get the samples from the track and put them in the buffer
+      track.Get((samplePtr)&mReadBuffer[0], floatSample, samplePos, blockSize);
+      samplePos += blockSize;
+
+      mInSampleCount += blockSize;
+      ProcessSamples(target, blockSize, &mReadBuffer[0]);
+   }
+
+   // A segment that reaches the end of the selection flushes the history
+   if (!parallelJobs.Cancelled() && mOutRemaining > 0)
+      FinishTrack(target);
+
+   segment.output.swap(mOutput);
 }
 
 void EffectNoiseReduction::Worker::ProcessSamples
-(Statistics &statistics, WaveTrack *outputTrack,
- size_t len, float *buffer)
+(Statistics &statistics, size_t len, float *buffer)
 {
-   while (len && mOutStepCount * mStepSize < mInSampleCount) {
+   // Count the windows waiting to be transformed as if already processed
+   while (len &&
+          (mOutStepCount + mForwardCount) * mStepSize < mInSampleCount) {
       auto avail = std::min(len, mWindowSize - mInWavePos);
       memmove(&mInWaveBuffer[mInWavePos], buffer, avail * sizeof(float));
       buffer += avail;
@@ -949,13 +1177,15 @@ void EffectNoiseReduction::Worker::ProcessSamples
       mInWavePos += avail;
 
       if (mInWavePos == (int)mWindowSize) {
-         FillFirstHistoryWindow();
-         if (mDoProfile)
-            GatherStatistics(statistics);
+         // Window the samples as needed, for a later batch transform
+         float *pFrame = &mForwardBatch[mForwardCount++ * mWindowSize];
+         if (mInWindow.size() > 0)
+            for (size_t ii = 0; ii < mWindowSize; ++ii)
+               pFrame[ii] = mInWaveBuffer[ii] * mInWindow[ii];
          else
-            ReduceNoise(statistics, outputTrack);
-         ++mOutStepCount;
-         RotateHistoryWindows();
+            memmove(pFrame, &mInWaveBuffer[0], mWindowSize * sizeof(float));
+         if (mForwardCount == mBatchSize)
+            ProcessBatch(statistics);
 
          // Rotate for overlap-add
          memmove(&mInWaveBuffer[0], &mInWaveBuffer[mStepSize],
@@ -963,18 +1193,33 @@ void EffectNoiseReduction::Worker::ProcessSamples
          mInWavePos -= mStepSize;
       }
    }
+
+   if (mForwardCount > 0)
+      ProcessBatch(statistics);
 }
 
-void EffectNoiseReduction::Worker::FillFirstHistoryWindow()
+void EffectNoiseReduction::Worker::ProcessBatch(Statistics &statistics)
 {
-   // Transform samples to frequency domain, windowed as needed
-   if (mInWindow.size() > 0)
-      for (size_t ii = 0; ii < mWindowSize; ++ii)
-         mFFTBuffer[ii] = mInWaveBuffer[ii] * mInWindow[ii];
-   else
-      memmove(&mFFTBuffer[0], &mInWaveBuffer[0], mWindowSize * sizeof(float));
-   RealFFTf(&mFFTBuffer[0], hFFT.get());
+   for (size_t ii = 0; ii < mForwardCount; ++ii) {
+      // Transform samples to frequency domain
+      float *const pFrame = &mForwardBatch[ii * mWindowSize];
+      RealFFTf(pFrame, hFFT.get());
+      FillFirstHistoryWindow(pFrame);
+      if (mDoProfile)
+         GatherStatistics(statistics);
+      else
+         ReduceNoise(statistics);
+      ++mOutStepCount;
+      RotateHistoryWindows();
+   }
+   mForwardCount = 0;
+
+   if (mInverseCount > 0)
+      OverlapAddBatch();
+}
 
+void EffectNoiseReduction::Worker::FillFirstHistoryWindow(const float *spectrum)
+{
    Record &record = *mQueue[0];
 
    // Store real and imaginary parts for later inverse FFT, and compute
@@ -987,16 +1232,16 @@ void EffectNoiseReduction::Worker::FillFirstHistoryWindow()
       const auto last = mSpectrumSize - 1;
       for (unsigned int ii = 1; ii < last; ++ii) {
          const int kk = *pBitReversed++;
-         const float realPart = *pReal++ = mFFTBuffer[kk];
-         const float imagPart = *pImag++ = mFFTBuffer[kk + 1];
+         const float realPart = *pReal++ = spectrum[kk];
+         const float imagPart = *pImag++ = spectrum[kk + 1];
          *pPower++ = realPart * realPart + imagPart * imagPart;
       }
       // DC and Fs/2 bins need to be handled specially
-      const float dc = mFFTBuffer[0];
+      const float dc = spectrum[0];
       record.mRealFFTs[0] = dc;
       record.mSpectrums[0] = dc*dc;
 
-      const float nyquist = mFFTBuffer[1];
+      const float nyquist = spectrum[1];
       record.mImagFFTs[0] = nyquist; // For Fs/2, not really imaginary
       record.mSpectrums[last] = nyquist * nyquist;
    }
@@ -1036,20 +1281,18 @@ void EffectNoiseReduction::Worker::FinishTrackStatistics(Statistics &statistics)
    statistics.mTotalWindows = denom;
 }
 
-void EffectNoiseReduction::Worker::FinishTrack
-(Statistics &statistics, WaveTrack *outputTrack)
+void EffectNoiseReduction::Worker::FinishTrack(Statistics &statistics)
 {
    // Keep flushing empty input buffers through the history
    // windows until we've output exactly as many samples as
    // were input.
    // Well, not exactly, but not more than one step-size of extra samples
-   // at the end.
-   // We'll DELETE them later in ProcessOne.
+   // at the end, which Output() drops.
 
    FloatVector empty(mStepSize);
 
-   while (mOutStepCount * mStepSize < mInSampleCount) {
-      ProcessSamples(statistics, outputTrack, mStepSize, &empty[0]);
+   while (mOutRemaining > 0 && mOutStepCount * mStepSize < mInSampleCount) {
+      ProcessSamples(statistics, mStepSize, &empty[0]);
    }
 }
 
@@ -1159,8 +1402,7 @@ bool EffectNoiseReduction::Worker::Classify(const Statistics &statistics, int ba
    }
 }
 
-void EffectNoiseReduction::Worker::ReduceNoise
-(const Statistics &statistics, WaveTrack *outputTrack)
+void EffectNoiseReduction::Worker::ReduceNoise(const Statistics &statistics)
 {
    // Raise the gain for elements in the center of the sliding history
    // or, if isolating noise, zero out the non-noise
@@ -1239,12 +1481,15 @@ void EffectNoiseReduction::Worker::ReduceNoise
          // Gains are not less than mNoiseAttenFactor
          ApplyFreqSmoothing(record.mGains);
 
-      // Apply gain to FFT
+      // Apply gain to FFT, into the next frame of the inverse batch
+      if (mInverseCount == 0)
+         mInverseFirstStep = mOutStepCount;
+      float *const pFrame = &mInverseBatch[mInverseCount++ * mWindowSize];
       {
          const float *pGain = &record.mGains[1];
          const float *pReal = &record.mRealFFTs[1];
          const float *pImag = &record.mImagFFTs[1];
-         float *pBuffer = &mFFTBuffer[2];
+         float *pBuffer = &pFrame[2];
          auto nn = mSpectrumSize - 2;
          if (mNoiseReductionChoice == NRC_LEAVE_RESIDUE) {
             for (; nn--;) {
@@ -1254,9 +1499,9 @@ void EffectNoiseReduction::Worker::ReduceNoise
                *pBuffer++ = *pReal++ * gain;
                *pBuffer++ = *pImag++ * gain;
             }
-            mFFTBuffer[0] = record.mRealFFTs[0] * (record.mGains[0] - 1.0);
+            pFrame[0] = record.mRealFFTs[0] * (record.mGains[0] - 1.0);
             // The Fs/2 component is stored as the imaginary part of the DC component
-            mFFTBuffer[1] = record.mImagFFTs[0] * (record.mGains[last] - 1.0);
+            pFrame[1] = record.mImagFFTs[0] * (record.mGains[last] - 1.0);
          }
          else {
             for (; nn--;) {
@@ -1264,14 +1509,21 @@ void EffectNoiseReduction::Worker::ReduceNoise
                *pBuffer++ = *pReal++ * gain;
                *pBuffer++ = *pImag++ * gain;
             }
-            mFFTBuffer[0] = record.mRealFFTs[0] * record.mGains[0];
+            pFrame[0] = record.mRealFFTs[0] * record.mGains[0];
             // The Fs/2 component is stored as the imaginary part of the DC component
-            mFFTBuffer[1] = record.mImagFFTs[0] * record.mGains[last];
+            pFrame[1] = record.mImagFFTs[0] * record.mGains[last];
          }
       }
+   }
+}
 
-      // Invert the FFT into the output buffer
-      InverseRealFFTf(&mFFTBuffer[0], hFFT.get());
+void EffectNoiseReduction::Worker::OverlapAddBatch()
+{
+   const auto last = mSpectrumSize - 1;
+   for (size_t ii = 0; ii < mInverseCount; ++ii) {
+      // Invert the FFT
+      float *const pFrame = &mInverseBatch[ii * mWindowSize];
+      InverseRealFFTf(pFrame, hFFT.get());
 
       // Overlap-add
       if (mOutWindow.size() > 0) {
@@ -1280,8 +1532,8 @@ void EffectNoiseReduction::Worker::ReduceNoise
          int *pBitReversed = &hFFT->BitReversed[0];
          for (unsigned int jj = 0; jj < last; ++jj) {
             int kk = *pBitReversed++;
-            *pOut++ += mFFTBuffer[kk] * (*pWindow++);
-            *pOut++ += mFFTBuffer[kk + 1] * (*pWindow++);
+            *pOut++ += pFrame[kk] * (*pWindow++);
+            *pOut++ += pFrame[kk + 1] * (*pWindow++);
          }
       }
       else {
@@ -1289,83 +1541,32 @@ void EffectNoiseReduction::Worker::ReduceNoise
          int *pBitReversed = &hFFT->BitReversed[0];
          for (unsigned int jj = 0; jj < last; ++jj) {
             int kk = *pBitReversed++;
-            *pOut++ += mFFTBuffer[kk];
-            *pOut++ += mFFTBuffer[kk + 1];
+            *pOut++ += pFrame[kk];
+            *pOut++ += pFrame[kk + 1];
          }
       }
 
       float *buffer = &mOutOverlapBuffer[0];
-      if (mOutStepCount >= 0) {
+      if (mInverseFirstStep + ii >= 0) {
          // Output the first portion of the overlap buffer, they're done
-         outputTrack->Append((samplePtr)buffer, floatSample, mStepSize);
+         Output(buffer, mStepSize);
       }
 
       // Shift the remainder over.
       memmove(buffer, buffer + mStepSize, sizeof(float) * (mWindowSize - mStepSize));
       std::fill(buffer + mWindowSize - mStepSize, buffer + mWindowSize, 0.0f);
    }
+
+   mInverseCount = 0;
 }
 
-bool EffectNoiseReduction::Worker::ProcessOne
-(EffectNoiseReduction &effect,  Statistics &statistics, TrackFactory &factory,
- int count, WaveTrack * track, sampleCount start, sampleCount len)
+void EffectNoiseReduction::Worker::Output(const float *buffer, size_t len)
 {
-   if (track == NULL)
-      return false;
-
-   StartNewTrack();
-
-   WaveTrack::Holder outputTrack;
-   if(!mDoProfile)
-      outputTrack = track->EmptyCopy();
-
-   auto bufferSize = track->GetMaxBlockSize();
-   FloatVector buffer(bufferSize);
-
-   bool bLoopSuccess = true;
-   auto samplePos = start;
-   while (bLoopSuccess && samplePos < start + len) {
-      //Get a blockSize of samples (smaller than the size of the buffer)
-      const auto blockSize = limitSampleBufferSize(
-         track->GetBestBlockSize(samplePos),
-         start + len - samplePos
-      );
-
-      //Get the samples from the track and put them in the buffer
-      track->Get((samplePtr)&buffer[0], floatSample, samplePos, blockSize);
-      samplePos += blockSize;
-
-      mInSampleCount += blockSize;
-      ProcessSamples(statistics, outputTrack.get(), blockSize, &buffer[0]);
-
-      // Update the Progress meter, let user cancel
-      bLoopSuccess = 
-         !effect.TrackProgress(count,
-                               ( samplePos - start ).as_double() /
-                               len.as_double() );
-   }
-
-   if (bLoopSuccess) {
-      if (mDoProfile)
-         FinishTrackStatistics(statistics);
-      else
-         FinishTrack(statistics, &*outputTrack);
-   }
-
-   if (bLoopSuccess && !mDoProfile) {
-      // Flush the output WaveTrack (since it's buffered)
-      outputTrack->Flush();
-
-      // Take the output track and insert it in place of the original
-      // sample data (as operated on -- this may not match mT0/mT1)
-      double t0 = outputTrack->LongSamplesToTime(start);
-      double tLen = outputTrack->LongSamplesToTime(len);
-      // Filtering effects always end up with more data than they started with.  Delete this 'tail'.
-      outputTrack->HandleClear(tLen, outputTrack->GetEndTime(), false, false);
-      track->ClearAndPaste(t0, t0 + tLen, &*outputTrack, true, false);
-   }
-
-   return bLoopSuccess;
+   const auto skip = limitSampleBufferSize(len, mOutSkip);
+   mOutSkip -= skip;
+   const auto keep = limitSampleBufferSize(len - skip, mOutRemaining);
+   mOutRemaining -= keep;
+   mOutput.insert(mOutput.end(), buffer + skip, buffer + skip + keep);
 }
 
 //----------------------------------------------------------------------------
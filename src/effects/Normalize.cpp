@@ -411,8 +411,8 @@ bool EffectNormalize::AnalyseTrack(const WaveTrack * track, const TranslatableSt
    return result;
 }
 
-//AnalyseTrackData() takes a track, transforms it to bunch of buffer-blocks,
-//and executes selected AnalyseOperation on it...
+//AnalyseTrackData() takes a track, and sums its samples one block at a time,
+//using the sums that whole blocks remember when it can...
 bool EffectNormalize::AnalyseTrackData(const WaveTrack * track, const TranslatableString &msg,
                                 double &progress, float &offset)
 {
@@ -427,10 +427,6 @@ bool EffectNormalize::AnalyseTrackData(const WaveTrack * track, const Translatab
    //to make it a double now than it is to do it later
    auto len = (end - start).as_double();
 
-   //Initiate a processing buffer.  This buffer will (most likely)
-   //be shorter than the length of the track being processed.
-   Floats buffer{ track->GetMaxBlockSize() };
-
    mSum   = 0.0; // dc offset inits
 
    sampleCount blockSamples;
@@ -447,20 +443,17 @@ bool EffectNormalize::AnalyseTrackData(const WaveTrack * track, const Translatab
          end - s
       );
 
-      //Get the samples from the track and put them in the buffer
-      track->Get((samplePtr) buffer.get(), floatSample, s, block, fillZero, true, &blockSamples);
+      //Sum the samples, reading them only for partial or new blocks
+      mSum += track->GetSum(s, block, true, &blockSamples);
       totalSamples += blockSamples;
 
-      //Process the buffer.
-      AnalyseDataDC(buffer.get(), block);
-
       //Increment s one blockfull of samples
       s += block;
 
       //Update the Progress meter
       if (TotalProgress(progress +
                         ((s - start).as_double() / len)/double(2*GetNumWaveTracks()), msg)) {
-         rc = false; //lda .. break, not return, so that buffer is deleted
+         rc = false;
          break;
       }
    }
@@ -522,7 +515,7 @@ bool EffectNormalize::ProcessOne(
       //Update the Progress meter
       if (TotalProgress(progress +
                         ((s - start).as_double() / len)/double(2*GetNumWaveTracks()), msg)) {
-         rc = false; //lda .. break, not return, so that buffer is deleted
+         rc = false;
          break;
       }
    }
@@ -532,13 +525,6 @@ bool EffectNormalize::ProcessOne(
    return rc;
 }
 
-/// @see AnalyseDataLoudnessDC
-void EffectNormalize::AnalyseDataDC(float *buffer, size_t len)
-{
-   for(decltype(len) i = 0; i < len; i++)
-      mSum += (double)buffer[i];
-}
-
 void EffectNormalize::ProcessData(float *buffer, size_t len, float offset)
 {
    for(decltype(len) i = 0; i < len; i++) {
@@ -0,0 +1,157 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+ParallelTrackJobs.cpp
+
+*******************************************************************//**
+
+\class ParallelTrackJobs
+\brief Processes several tracks, or groups of channels, at once.
+
+  Effects such as SBSMS and SoundTouch keep state from the start of a
+track to its end, so one track can't be cut into pieces for threads, but
+independent tracks can each have their own thread.  Workers take jobs in
+order, as the pieces of an OrderedParallelJobs.  The thread that runs them
+appends output as it comes, and reports the mean progress of all the jobs.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "ParallelTrackJobs.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "../MemoryX.h"
+#include "../OrderedParallelJobs.h"
+#include "../WaveTrack.h"
+
+namespace {
+
+// Samples of each channel that a job may give before it waits for them to
+// be appended
+const size_t MaxPending = 1 << 20;
+
+}
+
+struct ParallelTrackJobs::Entry
+{
+   std::vector<WaveTrack*> outputs;
+   Job job;
+   std::unique_ptr<Sink> sink;
+   // Samples taken from the sink to append; used only by Run()'s thread
+   std::vector< std::vector<float> > buffers;
+};
+
+ParallelTrackJobs::Sink::Sink(ParallelTrackJobs &owner, size_t nChannels)
+   : mOwner{ owner }
+   , mPending( nChannels )
+   , mDone{ false }
+   , mProgress{ 0.0 }
+{
+}
+
+void ParallelTrackJobs::Sink::Put(const float *const *channels, size_t len)
+{
+   std::unique_lock<std::mutex> lock{ mOwner.mMutex };
+   // Cancellation of the jobs does not notify the condition, so look for
+   // it at intervals
+   const auto ready = [&]{
+      return Cancelled() || mPending.empty() ||
+         mPending[0].size() < MaxPending; };
+   while (!mOwner.mCondition.wait_for(
+      lock, std::chrono::milliseconds(50), ready))
+      ;
+   if (Cancelled())
+      return;
+   for (size_t cc = 0; cc < mPending.size(); ++cc)
+      mPending[cc].insert(mPending[cc].end(), channels[cc], channels[cc] + len);
+}
+
+void ParallelTrackJobs::Sink::Progress(double frac)
+{
+   mProgress = std::min(1.0, std::max(0.0, frac));
+}
+
+bool ParallelTrackJobs::Sink::Cancelled() const
+{
+   return mOwner.mpJobs && mOwner.mpJobs->Cancelled();
+}
+
+ParallelTrackJobs::ParallelTrackJobs()
+{
+}
+
+ParallelTrackJobs::~ParallelTrackJobs()
+{
+}
+
+void ParallelTrackJobs::Add(std::vector<WaveTrack*> outputs, Job job)
+{
+   auto pEntry = std::make_unique<Entry>();
+   pEntry->sink.reset(new Sink{ *this, outputs.size() });
+   pEntry->buffers.resize(outputs.size());
+   pEntry->outputs = std::move(outputs);
+   pEntry->job = std::move(job);
+   mEntries.push_back(std::move(pEntry));
+}
+
+bool ParallelTrackJobs::Append(Entry &entry)
+{
+   auto &sink = *entry.sink;
+   bool done;
+   {
+      std::lock_guard<std::mutex> locker{ mMutex };
+      for (size_t cc = 0; cc < entry.outputs.size(); ++cc) {
+         entry.buffers[cc].clear();
+         entry.buffers[cc].swap(sink.mPending[cc]);
+      }
+      done = sink.mDone;
+   }
+   mCondition.notify_all();
+
+   for (size_t cc = 0; cc < entry.outputs.size(); ++cc)
+      if (!entry.buffers[cc].empty())
+         entry.outputs[cc]->Append((samplePtr)entry.buffers[cc].data(),
+            floatSample, entry.buffers[cc].size());
+
+   return done;
+}
+
+bool ParallelTrackJobs::Run(const ProgressFunction &progress)
+{
+   // Jobs keep their own output, so all may run at once
+   mpJobs = std::make_unique<OrderedParallelJobs>(
+      OrderedParallelJobs::DefaultThreadCount(mEntries.size()),
+      OrderedParallelJobs::Unbounded );
+
+   const auto work = [&](size_t, size_t piece) {
+      auto &entry = *mEntries[piece];
+      entry.job(*entry.sink);
+
+      std::lock_guard<std::mutex> locker{ mMutex };
+      entry.sink->mDone = true;
+   };
+
+   // Only this thread appends to the tracks.  Jobs are taken in order, but
+   // the output of any is appended as it comes.
+   std::vector<bool> finished( mEntries.size(), false );
+   const auto take = [&](size_t piece) {
+      // The job is done, so this appends the last of its output
+      Append(*mEntries[piece]);
+      finished[piece] = true;
+   };
+   const auto report = [&](size_t) {
+      double sum = 0;
+      for (size_t ii = 0; ii < mEntries.size(); ++ii) {
+         // Seen done at the same time as the last of the output
+         if (!finished[ii] && Append(*mEntries[ii]))
+            finished[ii] = true;
+         sum += finished[ii] ? 1.0 : double(mEntries[ii]->sink->mProgress);
+      }
+      return progress(sum / mEntries.size());
+   };
+
+   return mpJobs->Run(mEntries.size(), work, take, report);
+}
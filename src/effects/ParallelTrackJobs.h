@@ -0,0 +1,85 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+ParallelTrackJobs.h
+
+***********************************************************************/
+
+#ifndef __AUDACITY_PARALLEL_TRACK_JOBS__
+#define __AUDACITY_PARALLEL_TRACK_JOBS__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class OrderedParallelJobs;
+class WaveTrack;
+
+/// \brief Processes several tracks, or groups of channels, at once, one job
+/// to a worker thread.
+///
+/// A job computes the samples of its output tracks and gives them to its
+/// Sink.  Block files may be made only on the thread that calls Run(), so
+/// that thread appends them.  The output tracks are not flushed.  The jobs
+/// are the pieces of an OrderedParallelJobs.
+class ParallelTrackJobs
+{
+public:
+   class Sink
+   {
+   public:
+      /// Gives len samples for each output track; waits while much of what
+      /// was given before is not yet appended
+      void Put(const float *const *channels, size_t len);
+      /// Sets the fraction of the job that is done
+      void Progress(double frac);
+      /// Whether the job should stop early, because the user cancelled or
+      /// another job failed
+      bool Cancelled() const;
+
+   private:
+      friend ParallelTrackJobs;
+      Sink(ParallelTrackJobs &owner, size_t nChannels);
+
+      ParallelTrackJobs &mOwner;
+      // Guarded by the owner's mutex
+      std::vector< std::vector<float> > mPending;
+      bool mDone;
+      std::atomic<double> mProgress;
+   };
+
+   using Job = std::function< void(Sink &sink) >;
+   using ProgressFunction = std::function< bool(double frac) >;
+
+   ParallelTrackJobs();
+   ~ParallelTrackJobs();
+
+   /// Output of the job goes to the given tracks, in order
+   void Add(std::vector<WaveTrack*> outputs, Job job);
+
+   /// Runs all the jobs, and returns false if progress returned false.
+   /// Rethrows the first exception from any job.
+   bool Run(const ProgressFunction &progress);
+
+private:
+   struct Entry;
+
+   /// Appends what the job of the entry gave, and returns whether it was
+   /// all that it will give
+   bool Append(Entry &entry);
+
+   std::vector< std::unique_ptr<Entry> > mEntries;
+
+   // Made by Run()
+   std::unique_ptr<OrderedParallelJobs> mpJobs;
+
+   // Guards the sinks' pending samples; notified when they are appended
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+};
+
+#endif
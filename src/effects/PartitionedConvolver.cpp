@@ -0,0 +1,288 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+PartitionedConvolver.cpp
+
+*******************************************************************//**
+
+\class PartitionedConvolver
+\brief Convolves a stream with a long impulse response, in partitions.
+
+  A level of partitions of size N keeps the spectra of the last input
+blocks of N samples, each transformed with the block before it, in 2N
+points.  When a block is complete, the level multiplies the spectra by
+those of its partitions and sums them, and one inverse transform gives
+N samples of output (overlap-save).
+
+  Output is given one block of the smallest size after input.  The first
+level covers the start of the response without any further delay.  Each
+later level begins where its partitions' output is needed no sooner than
+a whole block of its own size later, so that it can be computed as soon
+as its input is complete.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "PartitionedConvolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Sizes of the FFT, in points
+const size_t MinFFTSize = 16;
+const size_t MaxFFTSize = 1 << 20;
+
+// Puts the transform of 2N points from the order RealFFTf leaves it in, to
+// the order that InverseRealFFTf takes
+void ReorderToPacked(const FFTParam *hFFT, const float *buffer, float *packed)
+{
+   // DC and Fs/2 components are purely real
+   packed[0] = buffer[0];
+   packed[1] = buffer[1];
+   for (size_t i = 1; i < hFFT->Points; i++) {
+      packed[2 * i] = buffer[hFFT->BitReversed[i]];
+      packed[2 * i + 1] = buffer[hFFT->BitReversed[i] + 1];
+   }
+}
+
+// sum += a * b, for transforms as ReorderToPacked leaves them
+void MultiplyAdd(const float *a, const float *b, float *sum, size_t points)
+{
+   sum[0] += a[0] * b[0];
+   sum[1] += a[1] * b[1];
+   for (size_t i = 2; i < 2 * points; i += 2) {
+      const float re = a[i] * b[i] - a[i + 1] * b[i + 1];
+      const float im = a[i] * b[i + 1] + a[i + 1] * b[i];
+      sum[i] += re;
+      sum[i + 1] += im;
+   }
+}
+
+}
+
+struct PartitionedConvolver::Level
+{
+   Level(const float *impulse, size_t impulseLen,
+      size_t offset_, size_t blockSize, size_t nPartitions_);
+
+   void Reset();
+   // Take the next samples, which must not complete more than one block
+   void Add(const float *samples, size_t len);
+   bool Ready() const { return fill == N; }
+   // Add output for the samples beginning target, which is
+   // the count of input samples minus N plus offset
+   void Transform(float *accumulator, size_t mask, size_t target);
+
+   const size_t N;
+   const size_t offset;
+   const size_t nPartitions;
+   const HFFT hFFT;
+
+   // The last 2N samples, once fill reaches N
+   Floats input;
+   size_t fill;
+
+   // Transforms of the partitions of the impulse response, and of the last
+   // nPartitions blocks of input, newest at index newest
+   Floats partitions;
+   Floats history;
+   size_t newest;
+
+   Floats buffer;
+   Floats sum;
+};
+
+PartitionedConvolver::Level::Level(const float *impulse, size_t impulseLen,
+   size_t offset_, size_t blockSize, size_t nPartitions_)
+   : N{ blockSize }
+   , offset{ offset_ }
+   , nPartitions{ nPartitions_ }
+   , hFFT{ GetFFT(2 * blockSize) }
+   , input{ 2 * blockSize }
+   , partitions{ 2 * blockSize * nPartitions_ }
+   , history{ 2 * blockSize * nPartitions_ }
+   , buffer{ 2 * blockSize }
+   , sum{ 2 * blockSize }
+{
+   for (size_t ii = 0; ii < nPartitions; ++ii) {
+      const size_t start = std::min(impulseLen, offset + ii * N);
+      const size_t len = std::min(impulseLen - start, N);
+      std::fill(buffer.get(), buffer.get() + 2 * N, 0.0f);
+      for (size_t jj = 0; jj < len; ++jj)
+         buffer[jj] = impulse[start + jj];
+      RealFFTf(buffer.get(), hFFT.get());
+      ReorderToPacked(hFFT.get(), buffer.get(), &partitions[2 * N * ii]);
+   }
+   Reset();
+}
+
+void PartitionedConvolver::Level::Reset()
+{
+   std::fill(input.get(), input.get() + 2 * N, 0.0f);
+   fill = 0;
+   std::fill(history.get(), history.get() + 2 * N * nPartitions, 0.0f);
+   newest = 0;
+}
+
+void PartitionedConvolver::Level::Add(const float *samples, size_t len)
+{
+   wxASSERT(fill + len <= N);
+   std::copy(samples, samples + len, &input[N + fill]);
+   fill += len;
+}
+
+void PartitionedConvolver::Level::Transform(
+   float *accumulator, size_t mask, size_t target)
+{
+   // Transform the last 2N samples, and make room for the next block
+   std::copy(input.get(), input.get() + 2 * N, buffer.get());
+   std::copy(&input[N], &input[2 * N], input.get());
+   fill = 0;
+   RealFFTf(buffer.get(), hFFT.get());
+   newest = (newest + nPartitions - 1) % nPartitions;
+   ReorderToPacked(hFFT.get(), buffer.get(), &history[2 * N * newest]);
+
+   // The newest input goes with the first partition, the one before it
+   // with the second, and so on
+   std::fill(sum.get(), sum.get() + 2 * N, 0.0f);
+   for (size_t ii = 0; ii < nPartitions; ++ii) {
+      const auto slot = (newest + ii) % nPartitions;
+      MultiplyAdd(&history[2 * N * slot], &partitions[2 * N * ii],
+         sum.get(), N);
+   }
+
+   // Of the circular convolution, only the second half is all valid
+   InverseRealFFTf(sum.get(), hFFT.get());
+   ReorderToTime(hFFT.get(), sum.get(), buffer.get());
+   for (size_t ii = 0; ii < N; ++ii)
+      accumulator[(target + ii) & mask] += buffer[N + ii];
+}
+
+PartitionedConvolver::PartitionedConvolver(const float *impulse,
+   size_t impulseLen, size_t blockSize, size_t maxBlockSize)
+   : mBlockSize{ blockSize }
+   , mInBlock{ blockSize, true }
+   , mOutBlock{ blockSize, true }
+   , mBlockPos{ 0 }
+   , mInCount{ 0 }
+{
+   maxBlockSize = std::max(blockSize, maxBlockSize);
+   wxASSERT(BlockSizeFor(blockSize) == blockSize);
+   wxASSERT(BlockSizeFor(maxBlockSize) == maxBlockSize);
+
+   // The first level begins at once, so its output for a block is due as
+   // soon as the block is complete.  Each later level may begin no sooner
+   // than one of its own blocks into the response, at a multiple of its
+   // block size; let each level but the last have just enough partitions
+   // to reach where the next may begin.
+   size_t offset = 0;
+   size_t farthest = blockSize;
+   for (size_t N = blockSize; offset < std::max<size_t>(1, impulseLen);
+        N *= 2) {
+      size_t nPartitions;
+      if (N < maxBlockSize) {
+         const auto next = std::max(2 * N, offset + 2 * N - 1) / (2 * N) * (2 * N);
+         nPartitions = std::max<size_t>(1, (next - offset) / N);
+      }
+      else
+         nPartitions = std::max<size_t>(1, (impulseLen - offset + N - 1) / N);
+      mLevels.push_back(std::make_unique<Level>(
+         impulse, impulseLen, offset, N, nPartitions));
+      farthest = std::max(farthest, offset + N);
+      offset += nPartitions * N;
+      if (N == maxBlockSize)
+         break;
+   }
+
+   // Room for the block now being given, and all that the levels may add
+   // beyond it
+   size_t size = 1;
+   while (size < blockSize + farthest)
+      size *= 2;
+   mAccumulator.reinit(size, true);
+   mAccumulatorMask = size - 1;
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+}
+
+size_t PartitionedConvolver::BlockSizeFor(size_t len)
+{
+   size_t size = MinFFTSize / 2;
+   while (size < len && size < MaxFFTSize / 2)
+      size *= 2;
+   return size;
+}
+
+size_t PartitionedConvolver::ThroughputBlockSize(size_t impulseLen)
+{
+   // Estimate the work per sample of output, for uniform partitions of
+   // each size: two transforms of 2N points, and a product of spectra for
+   // each partition, per N samples
+   size_t best = BlockSizeFor(1);
+   double bestCost = 0;
+   for (size_t N = best; N <= MaxFFTSize / 2; N *= 2) {
+      const auto nPartitions = std::max<size_t>(1, (impulseLen + N - 1) / N);
+      const double log2N = log2(2.0 * N);
+      const double cost =
+         (2 * 2.0 * N * log2N + 4.0 * 2 * N * nPartitions) / N;
+      if (N == best || cost < bestCost)
+         best = N, bestCost = cost;
+      if (N >= impulseLen)
+         break;
+   }
+   return best;
+}
+
+void PartitionedConvolver::Reset()
+{
+   for (auto &pLevel : mLevels)
+      pLevel->Reset();
+   std::fill(mInBlock.get(), mInBlock.get() + mBlockSize, 0.0f);
+   std::fill(mOutBlock.get(), mOutBlock.get() + mBlockSize, 0.0f);
+   std::fill(mAccumulator.get(), mAccumulator.get() + mAccumulatorMask + 1,
+      0.0f);
+   mBlockPos = 0;
+   mInCount = 0;
+}
+
+void PartitionedConvolver::Process(const float *in, float *out, size_t len)
+{
+   while (len > 0) {
+      const auto count = std::min(len, mBlockSize - mBlockPos);
+      // Take input before giving output, in case they are the same
+      std::copy(in, in + count, &mInBlock[mBlockPos]);
+      std::copy(&mOutBlock[mBlockPos], &mOutBlock[mBlockPos + count], out);
+      in += count;
+      out += count;
+      len -= count;
+      mBlockPos += count;
+      if (mBlockPos == mBlockSize) {
+         ProcessBlock();
+         mBlockPos = 0;
+      }
+   }
+}
+
+void PartitionedConvolver::ProcessBlock()
+{
+   mInCount += mBlockSize;
+   for (auto &pLevel : mLevels) {
+      pLevel->Add(mInBlock.get(), mBlockSize);
+      if (pLevel->Ready())
+         pLevel->Transform(mAccumulator.get(), mAccumulatorMask,
+            mInCount - pLevel->N + pLevel->offset);
+   }
+
+   // The levels have now added all there is for the block just completed
+   const auto start = mInCount - mBlockSize;
+   for (size_t ii = 0; ii < mBlockSize; ++ii) {
+      auto &sample = mAccumulator[(start + ii) & mAccumulatorMask];
+      mOutBlock[ii] = sample;
+      sample = 0;
+   }
+}
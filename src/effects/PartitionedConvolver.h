@@ -0,0 +1,71 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+PartitionedConvolver.h
+
+***********************************************************************/
+
+#ifndef __AUDACITY_PARTITIONED_CONVOLVER__
+#define __AUDACITY_PARTITIONED_CONVOLVER__
+
+#include "../SampleFormat.h"
+#include "../RealFFTf.h"
+
+#include <vector>
+
+/// \brief Convolves a stream with a long impulse response, by overlap-save
+/// in the frequency domain, with the response cut into partitions.
+///
+/// The first partitions have blockSize samples, which is also the latency.
+/// Later ones double in size up to maxBlockSize, so that a long response
+/// costs little more than with uniform partitions of the larger size.
+/// Both sizes must be powers of two.  With maxBlockSize equal to
+/// blockSize, all partitions are the same.
+class PartitionedConvolver
+{
+public:
+   PartitionedConvolver(const float *impulse, size_t impulseLen,
+      size_t blockSize, size_t maxBlockSize = 0);
+   PartitionedConvolver(const PartitionedConvolver&) = delete;
+   PartitionedConvolver &operator= (const PartitionedConvolver&) = delete;
+   ~PartitionedConvolver();
+
+   /// The uniform partition size that does the least work per sample, for
+   /// offline processing where latency does not matter
+   static size_t ThroughputBlockSize(size_t impulseLen);
+   /// The smallest power of two not less than len, within the sizes
+   /// that the FFT supports
+   static size_t BlockSizeFor(size_t len);
+
+   /// Output lags input by this many samples
+   size_t GetLatency() const { return mBlockSize; }
+
+   /// Forget all input, as if just constructed
+   void Reset();
+
+   /// Takes len samples of input, and gives the next len samples of output;
+   /// in may equal out
+   void Process(const float *in, float *out, size_t len);
+
+private:
+   struct Level;
+   void ProcessBlock();
+
+   const size_t mBlockSize;
+   std::vector<std::unique_ptr<Level>> mLevels;
+
+   // The block of input being gathered, and of output being given
+   Floats mInBlock;
+   Floats mOutBlock;
+   size_t mBlockPos;
+
+   // Sums of the levels' contributions to future output, indexed by
+   // sample count modulo its size, a power of two
+   Floats mAccumulator;
+   size_t mAccumulatorMask;
+   // Counts input samples; it may wrap, as only its residues are needed
+   size_t mInCount;
+};
+
+#endif
@@ -19,6 +19,8 @@
 #include "LoadEffects.h"
 
 #include <algorithm>
+#include <random>
+#include <vector>
 
 #include <math.h>
 #include <float.h>
@@ -29,6 +31,7 @@
 #include "../Shuttle.h"
 #include "../ShuttleGui.h"
 #include "../FFT.h"
+#include "../OrderedParallelJobs.h"
 #include "../widgets/valnum.h"
 #include "../widgets/AudacityMessageBox.h"
 #include "../Prefs.h"
@@ -50,7 +53,12 @@ public:
    //in_bufsize is also a half of a FFT buffer (in samples)
    virtual ~PaulStretch();
 
-   void process(float *smps, size_t nsmps);
+   //make in window (poolsize samples) the stretched window of the input pool (also
+   //poolsize samples), with random phases made from seed; several objects may
+   //make windows at once, for the same stretch
+   void make_window(const float *pool, float *window, unsigned int seed, unsigned int channel);
+   //make out_buf by overlapping a window, made as above, with the one before it
+   void add_window(const float *window);
 
    size_t get_nsamples();//how many samples are required to be added in the pool next time
    size_t get_nsamples_for_fill();//how many samples are required to be added for a complete buffer refill (at start of the song or after seek)
@@ -73,8 +81,6 @@ public:
    const size_t poolsize;//how many samples are inside the input_pool size (need to know how many samples to fill when seeking)
 
 private:
-   const Floats in_pool;//de marimea in_bufsize
-
    double remained_samples;//how many fraction of samples has remained (0..1)
 
    const Floats fft_smps, fft_c, fft_s, fft_freq, fft_tmp;
@@ -344,40 +350,90 @@ bool EffectPaulstretch::ProcessOne(WaveTrack *track,double t0,double t1,int coun
 
       PaulStretch stretch(amount, stretch_buf_size, track->GetRate());
 
-      auto nget = stretch.get_nsamples_for_fill();
-
       auto bufsize = stretch.poolsize;
-      Floats buffer0{ bufsize };
-      float *bufferptr0 = buffer0.get();
-      bool first_time = true;
-
       const auto fade_len = std::min<size_t>(100, bufsize / 2 - 1);
-      bool cancelled = false;
 
-      {
-         Floats fade_track_smps{ fade_len };
-         decltype(len) s=0;
-
-         while (s < len) {
-            track->Get((samplePtr)bufferptr0, floatSample, start + s, nget);
-            stretch.process(buffer0.get(), nget);
-
-            if (first_time) {
-               stretch.process(buffer0.get(), 0);
-            };
+      // Each window of output depends only on the input pool that ends at
+      // a certain sample, and on its own random phases, so worker threads
+      // make the windows; this thread overlaps them in order.  The first
+      // two windows have the same pool, and the first is only overlapped
+      // with the second.  Windows wait for this thread in a ring of slots,
+      // so that memory does not grow with the stretch.
+      struct Window {
+         Floats samples;
+         sampleCount end;
+      };
+
+      // Each thread needs a PaulStretch, which holds six and a half pools
+      // of floats, and a pool of input; and two slots are kept for it.  Use
+      // fewer threads when a long time resolution would make these exceed
+      // the budget, but always at least one.
+      const size_t memoryBudget = 256 * 1024 * 1024;
+      const auto bytesPerThread = (19 * bufsize / 2) * sizeof(float);
+      const auto nThreads = std::max<size_t>(1, std::min(
+         OrderedParallelJobs::DefaultThreadCount(),
+         memoryBudget / bytesPerThread));
+      OrderedParallelJobs parallelJobs{ nThreads };
+      const auto maxAhead = parallelJobs.MaxAhead();
+      std::vector<Window> slots(maxAhead);
+      for (auto &slot : slots)
+         slot.samples.reinit(bufsize);
+
+      // Each thread has its own PaulStretch for the FFTs, and its own pool
+      std::vector< std::unique_ptr<PaulStretch> > workers;
+      std::vector< Floats > pools;
+      for (size_t ii = 0; ii < parallelJobs.ThreadCount(); ++ii) {
+         workers.push_back( std::make_unique<PaulStretch>(
+            amount, stretch_buf_size, track->GetRate() ) );
+         pools.emplace_back( bufsize );
+      }
 
-            s += nget;
+      // The pool of each window ends where the one before it ended, plus
+      // as many samples as the stretch asks for next.  The last window is
+      // the first whose pool reaches the end of the selection.
+      sampleCount nextEnd = stretch.get_nsamples_for_fill();
+      bool more = true;
+      const auto claim = [&](size_t ii) {
+         if (!more)
+            return false;
+         slots[ii % maxAhead].end = nextEnd;
+         if (ii > 0) {
+            if (nextEnd >= len)
+               more = false;
+            nextEnd += stretch.get_nsamples();
+         }
+         return true;
+      };
+
+      Floats fade_track_smps{ fade_len };
+      decltype(len) s = 0;
+
+      const bool cancelled = !parallelJobs.Run( claim,
+         [&](size_t thread, size_t ii) {
+            auto &slot = slots[ii % maxAhead];
+            auto pool = pools[thread].get();
+            track->Get((samplePtr)pool, floatSample,
+               start + slot.end - bufsize, bufsize);
+            workers[thread]->make_window(pool, slot.samples.get(), ii, count);
+         },
+         // Only this thread appends to the output track
+         [&](size_t ii) {
+            auto &slot = slots[ii % maxAhead];
+            stretch.add_window(slot.samples.get());
+            const bool first_time = (ii == 1);
+            const bool output = (ii > 0);
+            if (output)
+               s = slot.end;
 
             if (first_time){//blend the start of the selection
                track->Get((samplePtr)fade_track_smps.get(), floatSample, start, fade_len);
-               first_time = false;
                for (size_t i = 0; i < fade_len; i++){
                   float fi = (float)i / (float)fade_len;
                   stretch.out_buf[i] =
                      stretch.out_buf[i] * fi + (1.0 - fi) * fade_track_smps[i];
                }
             }
-            if (s >= len){//blend the end of the selection
+            if (output && s >= len){//blend the end of the selection
                track->Get((samplePtr)fade_track_smps.get(), floatSample, end - fade_len, fade_len);
                for (size_t i = 0; i < fade_len; i++){
                   float fi = (float)i / (float)fade_len;
@@ -388,17 +444,12 @@ bool EffectPaulstretch::ProcessOne(WaveTrack *track,double t0,double t1,int coun
                }
             }
 
-            outputTrack->Append((samplePtr)stretch.out_buf.get(), floatSample, stretch.out_bufsize);
-
-            nget = stretch.get_nsamples();
-            if (TrackProgress(count,
-               s.as_double() / len.as_double()
-            )) {
-               cancelled = true;
-               break;
-            }
-         }
-      }
+            if (output)
+               outputTrack->Append((samplePtr)stretch.out_buf.get(), floatSample, stretch.out_bufsize);
+         },
+         [&](size_t) {
+            return !TrackProgress(count, s.as_double() / len.as_double());
+         } );
 
       if (!cancelled){
          outputTrack->Flush();
@@ -427,7 +478,6 @@ PaulStretch::PaulStretch(float rap_, size_t in_bufsize_, float samplerate_ )
    , out_buf { out_bufsize }
    , old_out_smp_buf { out_bufsize * 2, true }
    , poolsize { in_bufsize_ * 2 }
-   , in_pool { poolsize, true }
    , remained_samples { 0.0 }
    , fft_smps { poolsize, true }
    , fft_c { poolsize, true }
@@ -441,27 +491,11 @@ PaulStretch::~PaulStretch()
 {
 }
 
-void PaulStretch::process(float *smps, size_t nsmps)
+void PaulStretch::make_window(const float *pool, float *window, unsigned int seed, unsigned int channel)
 {
-   //add NEW samples to the pool
-   if ((smps != NULL) && (nsmps != 0)) {
-      if (nsmps > poolsize) {
-         nsmps = poolsize;
-      }
-      int nleft = poolsize - nsmps;
-
-      //move left the samples from the pool to make room for NEW samples
-      for (int i = 0; i < nleft; i++)
-         in_pool[i] = in_pool[i + nsmps];
-
-      //add NEW samples to the pool
-      for (size_t i = 0; i < nsmps; i++)
-         in_pool[i + nleft] = smps[i];
-   }
-
    //get the samples from the pool
    for (size_t i = 0; i < poolsize; i++)
-      fft_smps[i] = in_pool[i];
+      fft_smps[i] = pool[i];
    WindowFunc(eWinFuncHanning, poolsize, fft_smps.get());
 
    RealFFT(poolsize, fft_smps.get(), fft_c.get(), fft_s.get());
@@ -472,9 +506,13 @@ void PaulStretch::process(float *smps, size_t nsmps)
 
 
    //put randomize phases to frequencies and do a IFFT
+   //each window has its own generator, so that the result does not depend
+   //on the order the windows are made in
+   std::seed_seq seeds{ seed, channel };
+   std::mt19937 generator{ seeds };
    float inv_2p15_2pi = 1.0 / 16384.0 * (float)M_PI;
    for (size_t i = 1; i < poolsize / 2; i++) {
-      unsigned int random = (rand()) & 0x7fff;
+      unsigned int random = generator() & 0x7fff;
       float phase = random * inv_2p15_2pi;
       float s = fft_freq[i] * sin(phase);
       float c = fft_freq[i] * cos(phase);
@@ -486,15 +524,11 @@ void PaulStretch::process(float *smps, size_t nsmps)
    fft_c[0] = fft_s[0] = 0.0;
    fft_c[poolsize / 2] = fft_s[poolsize / 2] = 0.0;
 
-   FFT(poolsize, true, fft_c.get(), fft_s.get(), fft_smps.get(), fft_tmp.get());
-
-   float max = 0.0, max2 = 0.0;
-   for (size_t i = 0; i < poolsize; i++) {
-      max = std::max(max, fabsf(fft_tmp[i]));
-      max2 = std::max(max2, fabsf(fft_smps[i]));
-   }
-
+   FFT(poolsize, true, fft_c.get(), fft_s.get(), window, fft_tmp.get());
+}
 
+void PaulStretch::add_window(const float *window)
+{
    //make the output buffer
    float tmp = 1.0 / (float) out_bufsize * M_PI;
    float hinv_sqrt2 = 0.853553390593f;//(1.0+1.0/sqrt(2))*0.5;
@@ -507,15 +541,15 @@ void PaulStretch::process(float *smps, size_t nsmps)
 
    for (size_t i = 0; i < out_bufsize; i++) {
       float a = (0.5 + 0.5 * cos(i * tmp));
-      float out = fft_smps[i + out_bufsize] * (1.0 - a) + old_out_smp_buf[i] * a;
+      float out = window[i + out_bufsize] * (1.0 - a) + old_out_smp_buf[i] * a;
       out_buf[i] =
          out * (hinv_sqrt2 - (1.0 - hinv_sqrt2) * cos(i * 2.0 * tmp)) *
          ampfactor;
    }
 
-   //copy the current output buffer to old buffer
+   //copy the current window to old buffer
    for (size_t i = 0; i < out_bufsize * 2; i++)
-      old_out_smp_buf[i] = fft_smps[i];
+      old_out_smp_buf[i] = window[i];
 }
 
 size_t PaulStretch::get_nsamples()
@@ -26,6 +26,7 @@
 #include "../Experimental.h"
 
 #include <math.h>
+#include <algorithm>
 
 #include <wx/intl.h>
 #include <wx/slider.h>
@@ -155,7 +156,7 @@ bool EffectPhaser::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelName
    InstanceInit(mMaster, mSampleRate);
    if (chanMap[0] == ChannelNameFrontRight)
    {
-      mMaster.phase += M_PI;
+      mMaster.phaseOffset = M_PI;
    }
 
    return true;
@@ -253,6 +254,34 @@ bool EffectPhaser::SetAutomationParameters(CommandParameters & parms)
 
 // Effect implementation
 
+bool EffectPhaser::SupportsParallelProcessing()
+{
+   return true;
+}
+
+bool EffectPhaser::AddParallelProcessor(unsigned WXUNUSED(numChannels),
+   ChannelNames chanMap, float sampleRate,
+   sampleCount WXUNUSED(start), sampleCount WXUNUSED(len))
+{
+   // Offset the right channel's phase, as ProcessInitialize does
+   EffectPhaserState slave;
+
+   InstanceInit(slave, sampleRate);
+   if (chanMap[0] == ChannelNameFrontRight)
+   {
+      slave.phaseOffset = M_PI;
+   }
+
+   mSlaves.push_back(slave);
+
+   return true;
+}
+
+bool EffectPhaser::SupportsChaining()
+{
+   return true;
+}
+
 void EffectPhaser::PopulateOrExchange(ShuttleGui & S)
 {
    S.SetBorder(5);
@@ -395,6 +424,7 @@ void EffectPhaser::InstanceInit(EffectPhaserState & data, float sampleRate)
    data.fbout = 0;
    data.laststages = 0;
    data.outgain = 0;
+   data.phaseOffset = 0;
 
    return;
 }
@@ -411,21 +441,27 @@ size_t EffectPhaser::InstanceProcess(EffectPhaserState & data, float **inBlock,
    data.laststages = mStages;
 
    data.lfoskip = mFreq * 2 * M_PI / data.samplerate;
-   data.phase = mPhase * M_PI / 180;
+   data.phase = mPhase * M_PI / 180 + data.phaseOffset;
    data.outgain = DB_TO_LINEAR(mOutGain);
 
-   for (decltype(blockLen) i = 0; i < blockLen; i++)
-   {
-      double in = ibuf[i];
-
-      double m = in + data.fbout * mFeedback / 101;  // Feedback must be less than 100% to avoid infinite gain.
+   // Feedback must be less than 100% to avoid infinite gain.
+   const double feedback = mFeedback / 101.0;
+   const double wet = data.outgain * mDryWet / 255.0;
+   const double dry = data.outgain * (255 - mDryWet) / 255.0;
+   const int stages = mStages;
+   double *old = data.old;
+   double fbout = data.fbout;
 
-      if (((data.skipcount++) % lfoskipsamples) == 0)
+   for (decltype(blockLen) i = 0; i < blockLen;)
+   {
+      // The LFO moves the gain once every lfoskipsamples samples
+      const auto offset = (data.skipcount % lfoskipsamples).as_size_t();
+      if (offset == 0)
       {
          //compute sine between 0 and 1
          data.gain =
             (1.0 +
-             cos(data.skipcount.as_double() * data.lfoskip
+             cos((data.skipcount + 1).as_double() * data.lfoskip
                  + data.phase)) / 2.0;
 
          // change lfo shape
@@ -434,19 +470,32 @@ size_t EffectPhaser::InstanceProcess(EffectPhaserState & data, float **inBlock,
          // attenuate the lfo
          data.gain = 1.0 - data.gain / 255.0 * mDepth;
       }
+      const auto count = std::min<size_t>(blockLen - i, lfoskipsamples - offset);
 
-      // phasing routine
-      for (int j = 0; j < mStages; j++)
+      const double gain = data.gain;
+      for (auto k = i; k < i + count; k++)
       {
-         double tmp = data.old[j];
-         data.old[j] = data.gain * tmp + m;
-         m = tmp - data.gain * data.old[j];
+         const double in = ibuf[k];
+         double m = in + fbout * feedback;
+
+         // phasing routine
+         for (int j = 0; j < stages; j++)
+         {
+            double tmp = old[j];
+            old[j] = gain * tmp + m;
+            m = tmp - gain * old[j];
+         }
+         fbout = m;
+
+         obuf[k] = (float) (m * wet + in * dry);
       }
-      data.fbout = m;
 
-      obuf[i] = (float) (data.outgain * (m * mDryWet + in * (255 - mDryWet)) / 255);
+      data.skipcount += count;
+      i += count;
    }
 
+   data.fbout = fbout;
+
    return blockLen;
 }
 
@@ -36,6 +36,7 @@ public:
    double outgain;
    double lfoskip;
    double phase;
+   double phaseOffset; // added to the LFO phase: pi for a right channel
    int laststages;
 };
 
@@ -77,6 +78,10 @@ public:
 
    // Effect implementation
 
+   bool SupportsParallelProcessing() override;
+   bool AddParallelProcessor(unsigned numChannels, ChannelNames chanMap,
+      float sampleRate, sampleCount start, sampleCount len) override;
+   bool SupportsChaining() override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
@@ -31,6 +31,8 @@
 
 #include "Reverb_libSoX.h"
 
+#include <atomic>
+
 enum 
 {
    ID_RoomSize = 10000,
@@ -115,6 +117,20 @@ BEGIN_EVENT_TABLE(EffectReverb, wxEvtHandler)
 
 END_EVENT_TABLE()
 
+// A realtime reverb made again on the main thread for new parameters.  The
+// audio thread swaps it for the slave's, if the main thread has freed the
+// one swapped out before, so that nothing is allocated or freed there.
+struct EffectReverb::Rebuild
+{
+   // Used only on the main thread
+   float sampleRate;
+   bool isStereo;
+   Params params; // what the latest reverb was made for
+
+   std::atomic<EffectReverbState*> pending{ nullptr };
+   std::atomic<EffectReverbState*> retired{ nullptr };
+};
+
 EffectReverb::EffectReverb()
 {
    mParams.mRoomSize = DEF_RoomSize;
@@ -161,6 +177,15 @@ EffectType EffectReverb::GetType()
    return EffectTypeProcess;
 }
 
+bool EffectReverb::SupportsRealtime()
+{
+#if defined(EXPERIMENTAL_REALTIME_AUDACITY_EFFECTS)
+   return true;
+#else
+   return false;
+#endif
+}
+
 // EffectClientInterface implementation
 
 unsigned EffectReverb::GetAudioInCount()
@@ -178,106 +203,92 @@ static size_t BLOCK = 16384;
 bool EffectReverb::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelNames chanMap)
 {
    bool isStereo = false;
-   mNumChans = 1;
    if (chanMap && chanMap[0] != ChannelNameEOL && chanMap[1] == ChannelNameFrontRight)
    {
       isStereo = true;
-      mNumChans = 2;
    }
 
-   mP = (Reverb_priv_t *) calloc(sizeof(*mP), mNumChans);
-
-   for (unsigned int i = 0; i < mNumChans; i++)
-   {
-      reverb_create(&mP[i].reverb,
-                    mSampleRate,
-                    mParams.mWetGain,
-                    mParams.mRoomSize,
-                    mParams.mReverberance,
-                    mParams.mHfDamping,
-                    mParams.mPreDelay,
-                    mParams.mStereoWidth * (isStereo ? 1 : 0),
-                    mParams.mToneLow,
-                    mParams.mToneHigh,
-                    BLOCK,
-                    mP[i].wet);
-   }
+   InstanceInit(mMaster, mSampleRate, isStereo);
 
    return true;
 }
 
 bool EffectReverb::ProcessFinalize()
 {
-   for (unsigned int i = 0; i < mNumChans; i++)
-   {
-      reverb_delete(&mP[i].reverb);
-   }
-
-   free(mP);
+   InstanceFinalize(mMaster);
 
    return true;
 }
 
 size_t EffectReverb::ProcessBlock(float **inBlock, float **outBlock, size_t blockLen)
 {
-   float *ichans[2] = {NULL, NULL};
-   float *ochans[2] = {NULL, NULL};
+   return InstanceProcess(mMaster, inBlock, outBlock, blockLen);
+}
 
-   for (unsigned int c = 0; c < mNumChans; c++)
-   {
-      ichans[c] = inBlock[c];
-      ochans[c] = outBlock[c];
-   }
-   
-   float const dryMult = mParams.mWetOnly ? 0 : dB_to_linear(mParams.mDryGain);
+bool EffectReverb::RealtimeInitialize()
+{
+   SetBlockSize(512);
 
-   auto remaining = blockLen;
+   mSlaves.clear();
+   mRebuilds.clear();
 
-   while (remaining)
+   return true;
+}
+
+bool EffectReverb::RealtimeAddProcessor(unsigned numChannels, float sampleRate)
+{
+   EffectReverbState slave;
+
+   InstanceInit(slave, sampleRate, numChannels == 2);
+
+   mSlaves.push_back(slave);
+
+   auto pRebuild = std::make_unique<Rebuild>();
+   pRebuild->sampleRate = sampleRate;
+   pRebuild->isStereo = numChannels == 2;
+   pRebuild->params = mParams;
+   mRebuilds.push_back(std::move(pRebuild));
+
+   return true;
+}
+
+bool EffectReverb::RealtimeFinalize()
+{
+   for (auto &pRebuild : mRebuilds)
    {
-      auto len = std::min(remaining, decltype(remaining)(BLOCK));
-      for (unsigned int c = 0; c < mNumChans; c++)
-      {
-         // Write the input samples to the reverb fifo.  Returned value is the address of the
-         // fifo buffer which contains a copy of the input samples.
-         mP[c].dry = (float *) fifo_write(&mP[c].reverb.input_fifo, len, ichans[c]);
-         reverb_process(&mP[c].reverb, len);
-      }
+      FreeState(pRebuild->pending.exchange(nullptr));
+      FreeState(pRebuild->retired.exchange(nullptr));
+   }
+   mRebuilds.clear();
 
-      if (mNumChans == 2)
-      {
-         for (decltype(len) i = 0; i < len; i++)
-         {
-            for (int w = 0; w < 2; w++)
-            {
-               ochans[w][i] = dryMult *
-                              mP[w].dry[i] +
-                              0.5 *
-                              (mP[0].wet[w][i] + mP[1].wet[w][i]);
-            }
-         }
-      }
-      else
-      {
-         for (decltype(len) i = 0; i < len; i++)
-         {
-            ochans[0][i] = dryMult * 
-                           mP[0].dry[i] +
-                           mP[0].wet[0][i];
-         }
-      }
+   for (auto &slave : mSlaves)
+      InstanceFinalize(slave);
 
-      remaining -= len;
+   mSlaves.clear();
 
-      for (unsigned int c = 0; c < mNumChans; c++)
+   return true;
+}
+
+size_t EffectReverb::RealtimeProcess(int group,
+                                      float **inbuf,
+                                      float **outbuf,
+                                      size_t numSamples)
+{
+   // Swap in a reverb made for new parameters, once the main thread has
+   // freed the one swapped out before
+   auto &rebuild = *mRebuilds[group];
+   if (!rebuild.retired.load())
+   {
+      if (auto pState = rebuild.pending.exchange(nullptr))
       {
-         ichans[c] += len;
-         ochans[c] += len;
+         std::swap(mSlaves[group], *pState);
+         rebuild.retired.store(pState);
       }
    }
 
-   return blockLen;
+   return InstanceProcess(mSlaves[group], inbuf, outbuf, numSamples);
 }
+
 bool EffectReverb::DefineParams( ShuttleParams & S ){
    S.SHUTTLE_PARAM( mParams.mRoomSize,       RoomSize );
    S.SHUTTLE_PARAM( mParams.mPreDelay,       PreDelay );
@@ -331,6 +342,7 @@ bool EffectReverb::SetAutomationParameters(CommandParameters & parms)
    mParams.mDryGain = DryGain;
    mParams.mStereoWidth = StereoWidth;
    mParams.mWetOnly = WetOnly;
+   RebuildSlaves();
 
    return true;
 }
@@ -355,6 +367,7 @@ bool EffectReverb::LoadFactoryPreset(int id)
    }
 
    mParams = FactoryPresets[id].params;
+   RebuildSlaves();
 
    if (mUIDialog)
    {
@@ -366,6 +379,11 @@ bool EffectReverb::LoadFactoryPreset(int id)
 
 // Effect implementation
 
+bool EffectReverb::SupportsChaining()
+{
+   return true;
+}
+
 bool EffectReverb::Startup()
 {
    wxString base = wxT("/Effects/Reverb/");
@@ -515,6 +533,7 @@ bool EffectReverb::TransferDataFromWindow()
    mParams.mDryGain = mDryGainS->GetValue();
    mParams.mStereoWidth = mStereoWidthS->GetValue();
    mParams.mWetOnly = mWetOnlyC->GetValue();
+   RebuildSlaves();
 
    return true;
 }
@@ -547,6 +566,154 @@ SpinSliderHandlers(StereoWidth)
 
 #undef SpinSliderHandlers
 
+void EffectReverb::InstanceInit(EffectReverbState & data, float sampleRate, bool isStereo)
+{
+   data.mNumChans = isStereo ? 2 : 1;
+
+   data.mReverberance = mParams.mReverberance;
+   data.mHfDamping = mParams.mHfDamping;
+   data.mWetGain = mParams.mWetGain;
+
+   data.mP = (Reverb_priv_t *) calloc(sizeof(*data.mP), data.mNumChans);
+
+   for (unsigned int i = 0; i < data.mNumChans; i++)
+   {
+      reverb_create(&data.mP[i].reverb,
+                    sampleRate,
+                    mParams.mWetGain,
+                    mParams.mRoomSize,
+                    mParams.mReverberance,
+                    mParams.mHfDamping,
+                    mParams.mPreDelay,
+                    mParams.mStereoWidth * (isStereo ? 1 : 0),
+                    mParams.mToneLow,
+                    mParams.mToneHigh,
+                    BLOCK,
+                    data.mP[i].wet);
+   }
+}
+
+size_t EffectReverb::InstanceProcess(EffectReverbState & data, float **inBlock, float **outBlock, size_t blockLen)
+{
+   // The sizes of the delay lines and the tone filters are made with the
+   // reverb, which RebuildSlaves() makes again; the rest is set in place
+   if (mParams.mReverberance != data.mReverberance ||
+       mParams.mHfDamping != data.mHfDamping ||
+       mParams.mWetGain != data.mWetGain)
+   {
+      data.mReverberance = mParams.mReverberance;
+      data.mHfDamping = mParams.mHfDamping;
+      data.mWetGain = mParams.mWetGain;
+      for (unsigned int c = 0; c < data.mNumChans; c++)
+         reverb_set(&data.mP[c].reverb, mParams.mWetGain,
+            mParams.mReverberance, mParams.mHfDamping);
+   }
+
+   float *ichans[2] = {NULL, NULL};
+   float *ochans[2] = {NULL, NULL};
+
+   for (unsigned int c = 0; c < data.mNumChans; c++)
+   {
+      ichans[c] = inBlock[c];
+      ochans[c] = outBlock[c];
+   }
+   
+   float const dryMult = mParams.mWetOnly ? 0 : dB_to_linear(mParams.mDryGain);
+
+   auto remaining = blockLen;
+
+   while (remaining)
+   {
+      auto len = std::min(remaining, decltype(remaining)(BLOCK));
+      for (unsigned int c = 0; c < data.mNumChans; c++)
+      {
+         // Write the input samples to the reverb fifo.  Returned value is the address of the
+         // fifo buffer which contains a copy of the input samples.
+         data.mP[c].dry = (float *) fifo_write(&data.mP[c].reverb.input_fifo, len, ichans[c]);
+         reverb_process(&data.mP[c].reverb, len);
+      }
+
+      if (data.mNumChans == 2)
+      {
+         for (decltype(len) i = 0; i < len; i++)
+         {
+            for (int w = 0; w < 2; w++)
+            {
+               ochans[w][i] = dryMult *
+                              data.mP[w].dry[i] +
+                              0.5 *
+                              (data.mP[0].wet[w][i] + data.mP[1].wet[w][i]);
+            }
+         }
+      }
+      else
+      {
+         for (decltype(len) i = 0; i < len; i++)
+         {
+            ochans[0][i] = dryMult * 
+                           data.mP[0].dry[i] +
+                           data.mP[0].wet[0][i];
+         }
+      }
+
+      remaining -= len;
+
+      for (unsigned int c = 0; c < data.mNumChans; c++)
+      {
+         ichans[c] += len;
+         ochans[c] += len;
+      }
+   }
+
+   return blockLen;
+}
+
+void EffectReverb::InstanceFinalize(EffectReverbState & data)
+{
+   for (unsigned int i = 0; i < data.mNumChans; i++)
+   {
+      reverb_delete(&data.mP[i].reverb);
+   }
+
+   free(data.mP);
+   data.mP = nullptr;
+   data.mNumChans = 0;
+}
+
+void EffectReverb::FreeState(EffectReverbState *pState)
+{
+   if (pState)
+   {
+      InstanceFinalize(*pState);
+      delete pState;
+   }
+}
+
+void EffectReverb::RebuildSlaves()
+{
+   for (auto &pRebuild : mRebuilds)
+   {
+      auto &rebuild = *pRebuild;
+      const auto &params = rebuild.params;
+      if (mParams.mRoomSize == params.mRoomSize &&
+          mParams.mPreDelay == params.mPreDelay &&
+          mParams.mToneLow == params.mToneLow &&
+          mParams.mToneHigh == params.mToneHigh &&
+          mParams.mStereoWidth == params.mStereoWidth)
+         continue;
+
+      // Free what the audio thread swapped out, so it may swap again
+      FreeState(rebuild.retired.exchange(nullptr));
+
+      auto pState = std::make_unique<EffectReverbState>();
+      InstanceInit(*pState, rebuild.sampleRate, rebuild.isStereo);
+      rebuild.params = mParams;
+
+      // Replace any reverb made before that was not yet swapped in
+      FreeState(rebuild.pending.exchange(pState.release()));
+   }
+}
+
 void EffectReverb::SetTitle(const wxString & name)
 {
    mUIDialog->SetTitle(
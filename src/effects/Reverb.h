@@ -21,6 +21,19 @@ class ShuttleGui;
 
 struct Reverb_priv_t;
 
+// The reverb of one mono or stereo stream
+class EffectReverbState
+{
+public:
+   unsigned mNumChans {};
+   Reverb_priv_t *mP {};
+
+   // The parameters that the reverb may change in place, as last set
+   double mReverberance {};
+   double mHfDamping {};
+   double mWetGain {};
+};
+
 class EffectReverb final : public Effect
 {
 public:
@@ -52,6 +65,7 @@ public:
    // EffectDefinitionInterface implementation
 
    EffectType GetType() override;
+   bool SupportsRealtime() override;
 
    // EffectClientInterface implementation
 
@@ -60,6 +74,13 @@ public:
    bool ProcessInitialize(sampleCount totalLen, ChannelNames chanMap = NULL) override;
    bool ProcessFinalize() override;
    size_t ProcessBlock(float **inBlock, float **outBlock, size_t blockLen) override;
+   bool RealtimeInitialize() override;
+   bool RealtimeAddProcessor(unsigned numChannels, float sampleRate) override;
+   bool RealtimeFinalize() override;
+   size_t RealtimeProcess(int group,
+                                       float **inbuf,
+                                       float **outbuf,
+                                       size_t numSamples) override;
    bool DefineParams( ShuttleParams & S ) override;
    bool GetAutomationParameters(CommandParameters & parms) override;
    bool SetAutomationParameters(CommandParameters & parms) override;
@@ -68,6 +89,7 @@ public:
 
    // Effect implementation
 
+   bool SupportsChaining() override;
    bool Startup() override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataToWindow() override;
@@ -78,6 +100,15 @@ private:
 
    void SetTitle(const wxString & name = {});
 
+   void InstanceInit(EffectReverbState & data, float sampleRate, bool isStereo);
+   size_t InstanceProcess(EffectReverbState & data, float **inBlock, float **outBlock, size_t blockLen);
+   void InstanceFinalize(EffectReverbState & data);
+   void FreeState(EffectReverbState *pState);
+
+   // Makes again, off the audio thread, the realtime reverbs whose delay
+   // lines or filters no longer fit the parameters
+   void RebuildSlaves();
+
 #define SpinSliderHandlers(n) \
    void On ## n ## Slider(wxCommandEvent & evt); \
    void On ## n ## Text(wxCommandEvent & evt);
@@ -95,8 +126,11 @@ private:
 #undef SpinSliderHandlers
 
 private:
-   unsigned mNumChans {};
-   Reverb_priv_t *mP;
+   EffectReverbState mMaster;
+   std::vector<EffectReverbState> mSlaves;
+   // One for each slave
+   struct Rebuild;
+   std::vector< std::unique_ptr<Rebuild> > mRebuilds;
 
    Params mParams;
 
@@ -218,6 +218,20 @@ typedef struct {
    float * out[2];
 } reverb_t;
 
+/* Sets what may change while the reverb runs */
+static void reverb_set(reverb_t * p,
+      double wet_gain_dB,
+      double reverberance,   /* % */
+      double hf_damping)     /* % */
+{
+   double a =  -1 /  log(1 - /**/.3 /**/);           /* Set minimum feedback */
+   double b = 100 / (log(1 - /**/.98/**/) * a + 1);  /* Set maximum feedback */
+
+   p->feedback = 1 - exp((reverberance - b) / (a * b));
+   p->hf_damping = hf_damping / 100 * .3 + .2;
+   p->gain = dB_to_linear(wet_gain_dB) * .015;
+}
+
 static void reverb_create(reverb_t * p, double sample_rate_Hz,
       double wet_gain_dB,
       double room_scale,     /* % */
@@ -233,15 +247,11 @@ static void reverb_create(reverb_t * p, double sample_rate_Hz,
    size_t i, delay = pre_delay_ms / 1000 * sample_rate_Hz + .5;
    double scale = room_scale / 100 * .9 + .1;
    double depth = stereo_depth / 100;
-   double a =  -1 /  log(1 - /**/.3 /**/);           /* Set minimum feedback */
-   double b = 100 / (log(1 - /**/.98/**/) * a + 1);  /* Set maximum feedback */
    double fc_highpass = midi_to_freq(72 - tone_low / 100 * 48);
    double fc_lowpass  = midi_to_freq(72 + tone_high/ 100 * 48);
 
    memset(p, 0, sizeof(*p));
-   p->feedback = 1 - exp((reverberance - b) / (a * b));
-   p->hf_damping = hf_damping / 100 * .3 + .2;
-   p->gain = dB_to_linear(wet_gain_dB) * .015;
+   reverb_set(p, wet_gain_dB, reverberance, hf_damping);
    fifo_create(&p->input_fifo, sizeof(float));
    memset(fifo_write(&p->input_fifo, delay, 0), 0, delay * sizeof(float));
    for (i = 0; i <= ceil(depth); ++i) {
@@ -20,6 +20,7 @@ effect that uses SBSMS to do its processing (TimeScale)
 
 #include "../LabelTrack.h"
 #include "../WaveTrack.h"
+#include "ParallelTrackJobs.h"
 #include "TimeWarper.h"
 
 enum {
@@ -63,6 +64,22 @@ public:
    std::exception_ptr mpException {};
 };
 
+// All that one track or stereo pair needs, while a worker thread processes it
+struct SBSMSJob
+{
+   // Slides have state, so each job has its own
+   std::unique_ptr<Slide> rateSlide;
+   std::unique_ptr<Slide> pitchSlide;
+   ResampleBuf rb;
+   std::unique_ptr<Resampler> resampler;
+   std::unique_ptr<TimeWarper> warper;
+   WaveTrack *leftTrack;
+   WaveTrack *rightTrack;
+   double t0;
+   double t1;
+   sampleCount samplesOut;
+};
+
 class SBSMSEffectInterface final : public SBSMSInterfaceSliding {
 public:
    SBSMSEffectInterface(Resampler *resampler,
@@ -186,6 +203,46 @@ std::unique_ptr<TimeWarper> createTimeWarper(double t0, double t1, double durati
    return warper;
 }
 
+static void ProcessJob(SBSMSJob &job, ParallelTrackJobs::Sink &sink)
+{
+   auto &rb = job.rb;
+   const auto samplesOut = job.samplesOut;
+
+   audio outBuf[SBSMSOutBlockSize];
+   float outBufLeft[2*SBSMSOutBlockSize];
+   float outBufRight[2*SBSMSOutBlockSize];
+   const float *channels[] = { outBufLeft, outBufRight };
+
+   long pos = 0;
+   long outputCount = -1;
+
+   // process
+   while(pos<samplesOut && outputCount) {
+      const auto frames =
+         limitSampleBufferSize( SBSMSOutBlockSize, samplesOut - pos );
+
+      outputCount = job.resampler->read(outBuf,frames);
+      for(int i = 0; i < outputCount; i++) {
+         outBufLeft[i] = outBuf[i][0];
+         if(job.rightTrack)
+            outBufRight[i] = outBuf[i][1];
+      }
+      pos += outputCount;
+      sink.Put(channels, outputCount);
+
+      sink.Progress((double)pos / samplesOut.as_double());
+      if (sink.Cancelled())
+         return;
+   }
+
+   {
+      auto pException = rb.mpException;
+      rb.mpException = {};
+      if (pException)
+         std::rethrow_exception(pException);
+   }
+}
+
 // Labels inside the affected region are moved to match the audio; labels after
 // it are shifted along appropriately.
 bool EffectSBSMS::ProcessLabelTrack(LabelTrack *lt)
@@ -215,16 +272,19 @@ bool EffectSBSMS::Process()
    //Iterate over each track
    //all needed because this effect needs to introduce silence in the group tracks to keep sync
    this->CopyInputTracks(true); // Set up mOutputTracks.
-   mCurTrackNum = 0;
 
    double maxDuration = 0.0;
 
    // Must sync if selection length will change
    bool mustSync = (rateStart != rateEnd);
    Slide rateSlide(rateSlideType,rateStart,rateEnd);
-   Slide pitchSlide(pitchSlideType,pitchStart,pitchEnd);
    mTotalStretch = rateSlide.getTotalStretch();
 
+   // Wave tracks are processed after the visit, all at once, and their
+   // output pasted in afterward
+   std::vector< std::unique_ptr<SBSMSJob> > jobs;
+   ParallelTrackJobs parallelJobs;
+
    mOutputTracks->Leaders().VisitWhile( bGoodResult,
       [&](LabelTrack *lt, const Track::Fallthrough &fallthrough) {
          if (!(lt->GetSelected() || (mustSync && lt->IsSyncLockSelected())))
@@ -269,8 +329,6 @@ bool EffectSBSMS::Process()
                //Transform the marker timepoints to samples
                start = leftTrack->TimeToLongSamples(mCurT0);
                end = leftTrack->TimeToLongSamples(mCurT1);
-
-               mCurTrackNum++; // Increment for rightTrack, too.
             }
             const auto trackStart =
                leftTrack->TimeToLongSamples(leftTrack->GetStartTime());
@@ -281,8 +339,21 @@ bool EffectSBSMS::Process()
             float srTrack = leftTrack->GetRate();
             float srProcess = bLinkRatePitch ? srTrack : 44100.0;
 
+            // Each track or stereo pair is processed later, on a worker
+            // thread, with its own engine
+            jobs.push_back(std::make_unique<SBSMSJob>());
+            auto &job = *jobs.back();
+            job.rateSlide =
+               std::make_unique<Slide>(rateSlideType, rateStart, rateEnd);
+            job.pitchSlide =
+               std::make_unique<Slide>(pitchSlideType, pitchStart, pitchEnd);
+            job.leftTrack = leftTrack;
+            job.rightTrack = rightTrack;
+            job.t0 = mCurT0;
+            job.t1 = mCurT1;
+
             // the resampler needs a callback to supply its samples
-            ResampleBuf rb;
+            ResampleBuf &rb = job.rb;
             auto maxBlockSize = leftTrack->GetMaxBlockSize();
             rb.blockSize = maxBlockSize;
             rb.buf.reinit(rb.blockSize, true);
@@ -311,7 +382,7 @@ bool EffectSBSMS::Process()
                              sizeof(_sbsms_::SampleCountType),
                              "Type _sbsms_::SampleCountType is too narrow to hold a sampleCount");
               rb.iface = std::make_unique<SBSMSInterfaceSliding>
-                  (&rateSlide, &pitchSlide, bPitchReferenceInput,
+                  (job.rateSlide.get(), job.pitchSlide.get(), bPitchReferenceInput,
                    static_cast<_sbsms_::SampleCountType>
                       ( samplesToProcess.as_long_long() ),
                    0, nullptr);
@@ -344,7 +415,7 @@ bool EffectSBSMS::Process()
               rb.offset = start - trackPresamples;
               rb.end = trackEnd;
               rb.iface = std::make_unique<SBSMSEffectInterface>
-                  (rb.resampler.get(), &rateSlide, &pitchSlide,
+                  (rb.resampler.get(), job.rateSlide.get(), job.pitchSlide.get(),
                    bPitchReferenceInput,
                    // UNSAFE_SAMPLE_COUNT_TRUNCATION
                    // The argument type is only long!
@@ -354,17 +425,14 @@ bool EffectSBSMS::Process()
                    rb.quality.get());
             }
             
-            Resampler resampler(outResampleCB,&rb,outSlideType);
-
-            audio outBuf[SBSMSOutBlockSize];
-            float outBufLeft[2*SBSMSOutBlockSize];
-            float outBufRight[2*SBSMSOutBlockSize];
+            job.resampler =
+               std::make_unique<Resampler>(outResampleCB,&rb,outSlideType);
 
             // Samples in output after SBSMS
             sampleCount samplesToOutput = rb.iface->getSamplesToOutput();
 
             // Samples in output after resampling back
-            auto samplesOut = (sampleCount) (samplesToOutput.as_float() * (srTrack/srProcess));
+            job.samplesOut = (sampleCount) (samplesToOutput.as_float() * (srTrack/srProcess));
 
             // Duration in track time
             double duration =  (mCurT1-mCurT0) * mTotalStretch;
@@ -372,68 +440,20 @@ bool EffectSBSMS::Process()
             if(duration > maxDuration)
                maxDuration = duration;
 
-            auto warper = createTimeWarper(mCurT0,mCurT1,maxDuration,rateStart,rateEnd,rateSlideType);
+            job.warper = createTimeWarper(mCurT0,mCurT1,maxDuration,rateStart,rateEnd,rateSlideType);
 
             rb.outputLeftTrack = leftTrack->EmptyCopy();
-            if(rightTrack)
+            std::vector<WaveTrack*> outputs{ rb.outputLeftTrack.get() };
+            if(rightTrack) {
                rb.outputRightTrack = rightTrack->EmptyCopy();
-   
-            long pos = 0;
-            long outputCount = -1;
-
-            // process
-            while(pos<samplesOut && outputCount) {
-               const auto frames =
-                  limitSampleBufferSize( SBSMSOutBlockSize, samplesOut - pos );
-
-               outputCount = resampler.read(outBuf,frames);
-               for(int i = 0; i < outputCount; i++) {
-                  outBufLeft[i] = outBuf[i][0];
-                  if(rightTrack)
-                     outBufRight[i] = outBuf[i][1];
-               }
-               pos += outputCount;
-               rb.outputLeftTrack->Append((samplePtr)outBufLeft, floatSample, outputCount);
-               if(rightTrack)
-                  rb.outputRightTrack->Append((samplePtr)outBufRight, floatSample, outputCount);
-
-               double frac = (double)pos / samplesOut.as_double();
-               int nWhichTrack = mCurTrackNum;
-               if(rightTrack) {
-                  nWhichTrack = 2*(mCurTrackNum/2);
-                  if (frac < 0.5)
-                     frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-                  else {
-                     nWhichTrack++;
-                     frac -= 0.5;
-                     frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-                  }
-               }
-               if (TrackProgress(nWhichTrack, frac)) {
-                  bGoodResult = false;
-                  return;
-               }
+               outputs.push_back(rb.outputRightTrack.get());
             }
 
-            {
-               auto pException = rb.mpException;
-               rb.mpException = {};
-               if (pException)
-                  std::rethrow_exception(pException);
-            }
-
-            rb.outputLeftTrack->Flush();
-            if(rightTrack)
-               rb.outputRightTrack->Flush();
-
-            leftTrack->ClearAndPaste(mCurT0, mCurT1, rb.outputLeftTrack.get(),
-                                     true, false, warper.get());
-
-            if(rightTrack)
-               rightTrack->ClearAndPaste(mCurT0, mCurT1, rb.outputRightTrack.get(),
-                                         true, false, warper.get());
+            parallelJobs.Add(std::move(outputs),
+               [&job](ParallelTrackJobs::Sink &sink) {
+                  ProcessJob(job, sink);
+               });
          }
-         mCurTrackNum++;
       },
       [&](Track *t) {
          if (mustSync && t->IsSyncLockSelected())
@@ -443,7 +463,25 @@ bool EffectSBSMS::Process()
       }
    );
 
+   if (bGoodResult)
+      bGoodResult = parallelJobs.Run( [this](double frac) {
+         return !TotalProgress(frac); } );
+
    if (bGoodResult) {
+      for (auto &pJob : jobs) {
+         auto &rb = pJob->rb;
+         rb.outputLeftTrack->Flush();
+         if(pJob->rightTrack)
+            rb.outputRightTrack->Flush();
+
+         pJob->leftTrack->ClearAndPaste(pJob->t0, pJob->t1,
+            rb.outputLeftTrack.get(), true, false, pJob->warper.get());
+
+         if(pJob->rightTrack)
+            pJob->rightTrack->ClearAndPaste(pJob->t0, pJob->t1,
+               rb.outputRightTrack.get(), true, false, pJob->warper.get());
+      }
+
       ReplaceProcessedTracks(bGoodResult);
 
       // Update selection
@@ -49,7 +49,6 @@ private:
    bool bLinkRatePitch, bRateReferenceInput, bPitchReferenceInput;
    SlideType rateSlideType;
    SlideType pitchSlideType;
-   int mCurTrackNum;
    double mCurT0;
    double mCurT1;
    float mTotalStretch;
@@ -226,12 +226,8 @@ bool EffectScienFilter::ProcessInitialize(sampleCount WXUNUSED(totalLen), Channe
 
 size_t EffectScienFilter::ProcessBlock(float **inBlock, float **outBlock, size_t blockLen)
 {
-   float *ibuf = inBlock[0];
-   for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++)
-   {
-      mpBiquad[iPair].Process(ibuf, outBlock[0], blockLen);
-      ibuf = outBlock[0];
-   }
+   Biquad::ProcessCascade(mpBiquad.get(), (mOrder + 1) / 2,
+      inBlock[0], outBlock[0], blockLen);
 
    return blockLen;
 }
@@ -282,6 +278,11 @@ bool EffectScienFilter::SetAutomationParameters(CommandParameters & parms)
 
 // Effect implementation
 
+bool EffectScienFilter::SupportsChaining()
+{
+   return true;
+}
+
 bool EffectScienFilter::Startup()
 {
    wxString base = wxT("/SciFilter/");
@@ -66,11 +66,10 @@ bool EffectSoundTouch::ProcessNoteTrack(NoteTrack *nt, const TimeWarper &warper)
 }
 #endif
 
-bool EffectSoundTouch::ProcessWithTimeWarper(const TimeWarper &warper)
+bool EffectSoundTouch::ProcessWithTimeWarper(InitFunction initer,
+                                             const TimeWarper &warper)
 {
-   // Assumes that mSoundTouch has already been initialized
-   // by the subclass for subclass-specific parameters. The
-   // time warper should also be set.
+   // The time warper should already be set.
 
    // Check if this effect will alter the selection length; if so, we need
    // to operate on sync-lock selected tracks.
@@ -84,9 +83,18 @@ bool EffectSoundTouch::ProcessWithTimeWarper(const TimeWarper &warper)
    this->CopyInputTracks(true);
    bool bGoodResult = true;
 
-   mCurTrackNum = 0;
    m_maxNewLength = 0.0;
 
+   // Wave tracks are processed after the visit, all at once, and their
+   // output pasted in afterward
+   struct Pasting {
+      WaveTrack *track;
+      WaveTrack::Holder output;
+      double t0, t1;
+   };
+   std::vector<Pasting> pastings;
+   ParallelTrackJobs jobs;
+
    mOutputTracks->Leaders().VisitWhile( bGoodResult,
       [&]( LabelTrack *lt, const Track::Fallthrough &fallthrough ) {
          if ( !(lt->GetSelected() || (mustSync && lt->IsSyncLockSelected())) )
@@ -118,6 +126,11 @@ bool EffectSoundTouch::ProcessWithTimeWarper(const TimeWarper &warper)
          // Process only if the right marker is to the right of the left marker
          if (mCurT1 > mCurT0) {
 
+            // Engines are made on this thread, one for each job
+            auto soundTouch = std::make_shared<soundtouch::SoundTouch>();
+            initer(soundTouch.get());
+            soundTouch->setSampleRate((unsigned int)(leftTrack->GetRate()+0.5));
+
             // TODO: more-than-two-channels
             auto channels = TrackList::Channels(leftTrack);
             auto rightTrack = (channels.size() > 1)
@@ -139,26 +152,37 @@ bool EffectSoundTouch::ProcessWithTimeWarper(const TimeWarper &warper)
                auto end = leftTrack->TimeToLongSamples(mCurT1);
 
                //Inform soundtouch there's 2 channels
-               mSoundTouch->setChannels(2);
+               soundTouch->setChannels(2);
+
+               auto outputLeftTrack = leftTrack->EmptyCopy();
+               auto outputRightTrack = rightTrack->EmptyCopy();
+               pastings.push_back({ leftTrack, outputLeftTrack, mCurT0, mCurT1 });
+               pastings.push_back({ rightTrack, outputRightTrack, mCurT0, mCurT1 });
 
                //ProcessStereo() (implemented below) processes a stereo track
-               if (!ProcessStereo(leftTrack, rightTrack, start, end, warper))
-                  bGoodResult = false;
-               mCurTrackNum++; // Increment for rightTrack, too.
+               jobs.Add( { outputLeftTrack.get(), outputRightTrack.get() },
+                  [=](ParallelTrackJobs::Sink &sink) {
+                     ProcessStereo(*soundTouch, leftTrack, rightTrack,
+                        start, end, sink);
+                  } );
             } else {
                //Transform the marker timepoints to samples
                auto start = leftTrack->TimeToLongSamples(mCurT0);
                auto end = leftTrack->TimeToLongSamples(mCurT1);
 
                //Inform soundtouch there's a single channel
-               mSoundTouch->setChannels(1);
+               soundTouch->setChannels(1);
+
+               auto outputTrack = leftTrack->EmptyCopy();
+               pastings.push_back({ leftTrack, outputTrack, mCurT0, mCurT1 });
 
                //ProcessOne() (implemented below) processes a single track
-               if (!ProcessOne(leftTrack, start, end, warper))
-                  bGoodResult = false;
+               jobs.Add( { outputTrack.get() },
+                  [=](ParallelTrackJobs::Sink &sink) {
+                     ProcessOne(*soundTouch, leftTrack, start, end, sink);
+                  } );
             }
          }
-         mCurTrackNum++;
       },
       [&]( Track *t ) {
          if (mustSync && t->IsSyncLockSelected()) {
@@ -168,7 +192,25 @@ bool EffectSoundTouch::ProcessWithTimeWarper(const TimeWarper &warper)
    );
 
    if (bGoodResult)
+      bGoodResult = jobs.Run( [this](double frac) {
+         return !TotalProgress(frac); } );
+
+   if (bGoodResult) {
+      for (auto &pasting : pastings) {
+         // Flush the output WaveTrack (since it's buffered, too)
+         pasting.output->Flush();
+
+         // Take the output track and insert it in place of the original
+         // sample data
+         pasting.track->ClearAndPaste(pasting.t0, pasting.t1,
+            pasting.output.get(), false, true, &warper);
+
+         double newLength = pasting.output->GetEndTime();
+         m_maxNewLength = wxMax(m_maxNewLength, newLength);
+      }
+
       ReplaceProcessedTracks(bGoodResult);
+   }
 
 //   mT0 = mCurT0;
 //   mT1 = mCurT0 + m_maxNewLength; // Update selection.
@@ -176,95 +218,68 @@ bool EffectSoundTouch::ProcessWithTimeWarper(const TimeWarper &warper)
    return bGoodResult;
 }
 
-void EffectSoundTouch::End()
-{
-   mSoundTouch.reset();
-}
-
 //ProcessOne() takes a track, transforms it to bunch of buffer-blocks,
 //and executes ProcessSoundTouch on these blocks
-bool EffectSoundTouch::ProcessOne(WaveTrack *track,
+void EffectSoundTouch::ProcessOne(soundtouch::SoundTouch &soundTouch,
+                                  WaveTrack *track,
                                   sampleCount start, sampleCount end,
-                                  const TimeWarper &warper)
+                                  ParallelTrackJobs::Sink &sink)
 {
-   mSoundTouch->setSampleRate((unsigned int)(track->GetRate()+0.5));
-
-   auto outputTrack = track->EmptyCopy();
-
    //Get the length of the buffer (as double). len is
    //used simple to calculate a progress meter, so it is easier
    //to make it a double now than it is to do it later
    auto len = (end - start).as_double();
 
-   {
-      //Initiate a processing buffer.  This buffer will (most likely)
-      //be shorter than the length of the track being processed.
-      Floats buffer{ track->GetMaxBlockSize() };
-
-      //Go through the track one buffer at a time. s counts which
-      //sample the current buffer starts at.
-      auto s = start;
-      while (s < end) {
-         //Get a block of samples (smaller than the size of the buffer)
-         const auto block =
-            limitSampleBufferSize( track->GetBestBlockSize(s), end - s );
-
-         //Get the samples from the track and put them in the buffer
-         track->Get((samplePtr)buffer.get(), floatSample, s, block);
-
-         //Add samples to SoundTouch
-         mSoundTouch->putSamples(buffer.get(), block);
-
-         //Get back samples from SoundTouch
-         unsigned int outputCount = mSoundTouch->numSamples();
-         if (outputCount > 0) {
-            Floats buffer2{ outputCount };
-            mSoundTouch->receiveSamples(buffer2.get(), outputCount);
-            outputTrack->Append((samplePtr)buffer2.get(), floatSample, outputCount);
-         }
-
-         //Increment s one blockfull of samples
-         s += block;
-
-         //Update the Progress meter
-         if (TrackProgress(mCurTrackNum, (s - start).as_double() / len))
-            return false;
-      }
-
-      // Tell SoundTouch to finish processing any remaining samples
-      mSoundTouch->flush();   // this should only be used for changeTempo - it dumps data otherwise with pRateTransposer->clear();
-
-      unsigned int outputCount = mSoundTouch->numSamples();
+   //Initiate a processing buffer.  This buffer will (most likely)
+   //be shorter than the length of the track being processed.
+   Floats buffer{ track->GetMaxBlockSize() };
+   Floats buffer2;
+   size_t buffer2Size = 0;
+   const auto receive = [&] {
+      //Get back samples from SoundTouch
+      unsigned int outputCount = soundTouch.numSamples();
       if (outputCount > 0) {
-         Floats buffer2{ outputCount };
-         mSoundTouch->receiveSamples(buffer2.get(), outputCount);
-         outputTrack->Append((samplePtr)buffer2.get(), floatSample, outputCount);
+         if (outputCount > buffer2Size)
+            buffer2.reinit(buffer2Size = outputCount);
+         soundTouch.receiveSamples(buffer2.get(), outputCount);
+         const float *channels[] = { buffer2.get() };
+         sink.Put(channels, outputCount);
       }
-
-      // Flush the output WaveTrack (since it's buffered, too)
-      outputTrack->Flush();
+   };
+
+   //Go through the track one buffer at a time. s counts which
+   //sample the current buffer starts at.
+   auto s = start;
+   while (s < end) {
+      //Get a block of samples (smaller than the size of the buffer)
+      const auto block =
+         limitSampleBufferSize( track->GetBestBlockSize(s), end - s );
+
+      //Get the samples from the track and put them in the buffer
+      track->Get((samplePtr)buffer.get(), floatSample, s, block);
+
+      //Add samples to SoundTouch
+      soundTouch.putSamples(buffer.get(), block);
+      receive();
+
+      //Increment s one blockfull of samples
+      s += block;
+
+      //Update the Progress meter
+      sink.Progress((s - start).as_double() / len);
+      if (sink.Cancelled())
+         return;
    }
 
-   // Take the output track and insert it in place of the original
-   // sample data
-   track->ClearAndPaste(mCurT0, mCurT1, outputTrack.get(), false, true, &warper);
-
-   double newLength = outputTrack->GetEndTime();
-   m_maxNewLength = wxMax(m_maxNewLength, newLength);
-
-   //Return true because the effect processing succeeded.
-   return true;
+   // Tell SoundTouch to finish processing any remaining samples
+   soundTouch.flush();   // this should only be used for changeTempo - it dumps data otherwise with pRateTransposer->clear();
+   receive();
 }
 
-bool EffectSoundTouch::ProcessStereo(
+void EffectSoundTouch::ProcessStereo(soundtouch::SoundTouch &soundTouch,
    WaveTrack* leftTrack, WaveTrack* rightTrack,
-   sampleCount start, sampleCount end, const TimeWarper &warper)
+   sampleCount start, sampleCount end, ParallelTrackJobs::Sink &sink)
 {
-   mSoundTouch->setSampleRate((unsigned int)(leftTrack->GetRate() + 0.5));
-
-   auto outputLeftTrack = leftTrack->EmptyCopy();
-   auto outputRightTrack = rightTrack->EmptyCopy();
-
    //Get the length of the buffer (as double). len is
    //used simple to calculate a progress meter, so it is easier
    //to make it a double now than it is to do it later
@@ -276,93 +291,61 @@ bool EffectSoundTouch::ProcessStereo(
    // because Soundtouch wants them interleaved, i.e., each
    // Soundtouch sample is left-right pair.
    auto maxBlockSize = leftTrack->GetMaxBlockSize();
-   {
-      Floats leftBuffer{ maxBlockSize };
-      Floats rightBuffer{ maxBlockSize };
-      Floats soundTouchBuffer{ maxBlockSize * 2 };
-
-      // Go through the track one stereo buffer at a time.
-      // sourceSampleCount counts the sample at which the current buffer starts,
-      // per channel.
-      auto sourceSampleCount = start;
-      while (sourceSampleCount < end) {
-         auto blockSize = limitSampleBufferSize(
-            leftTrack->GetBestBlockSize(sourceSampleCount),
-            end - sourceSampleCount
-         );
-
-         // Get the samples from the tracks and put them in the buffers.
-         leftTrack->Get((samplePtr)(leftBuffer.get()), floatSample, sourceSampleCount, blockSize);
-         rightTrack->Get((samplePtr)(rightBuffer.get()), floatSample, sourceSampleCount, blockSize);
-
-         // Interleave into soundTouchBuffer.
-         for (decltype(blockSize) index = 0; index < blockSize; index++) {
-            soundTouchBuffer[index * 2] = leftBuffer[index];
-            soundTouchBuffer[(index * 2) + 1] = rightBuffer[index];
-         }
-
-         //Add samples to SoundTouch
-         mSoundTouch->putSamples(soundTouchBuffer.get(), blockSize);
-
-         //Get back samples from SoundTouch
-         unsigned int outputCount = mSoundTouch->numSamples();
-         if (outputCount > 0)
-            this->ProcessStereoResults(outputCount, outputLeftTrack.get(), outputRightTrack.get());
-
-         //Increment sourceSampleCount one blockfull of samples
-         sourceSampleCount += blockSize;
-
-         //Update the Progress meter
-         // mCurTrackNum is left track. Include right track.
-         int nWhichTrack = mCurTrackNum;
-         double frac = (sourceSampleCount - start).as_double() / len;
-         if (frac < 0.5)
-            frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-         else
-         {
-            nWhichTrack++;
-            frac -= 0.5;
-            frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-         }
-         if (TrackProgress(nWhichTrack, frac))
-            return false;
+   Floats leftBuffer{ maxBlockSize };
+   Floats rightBuffer{ maxBlockSize };
+   Floats soundTouchBuffer{ maxBlockSize * 2 };
+
+   // Go through the track one stereo buffer at a time.
+   // sourceSampleCount counts the sample at which the current buffer starts,
+   // per channel.
+   auto sourceSampleCount = start;
+   while (sourceSampleCount < end) {
+      auto blockSize = limitSampleBufferSize(
+         leftTrack->GetBestBlockSize(sourceSampleCount),
+         end - sourceSampleCount
+      );
+
+      // Get the samples from the tracks and put them in the buffers.
+      leftTrack->Get((samplePtr)(leftBuffer.get()), floatSample, sourceSampleCount, blockSize);
+      rightTrack->Get((samplePtr)(rightBuffer.get()), floatSample, sourceSampleCount, blockSize);
+
+      // Interleave into soundTouchBuffer.
+      for (decltype(blockSize) index = 0; index < blockSize; index++) {
+         soundTouchBuffer[index * 2] = leftBuffer[index];
+         soundTouchBuffer[(index * 2) + 1] = rightBuffer[index];
       }
 
-      // Tell SoundTouch to finish processing any remaining samples
-      mSoundTouch->flush();
+      //Add samples to SoundTouch
+      soundTouch.putSamples(soundTouchBuffer.get(), blockSize);
 
-      unsigned int outputCount = mSoundTouch->numSamples();
+      //Get back samples from SoundTouch
+      unsigned int outputCount = soundTouch.numSamples();
       if (outputCount > 0)
-         this->ProcessStereoResults(outputCount, outputLeftTrack.get(), outputRightTrack.get());
+         this->ProcessStereoResults(soundTouch, outputCount, sink);
 
-      // Flush the output WaveTracks (since they're buffered, too)
-      outputLeftTrack->Flush();
-      outputRightTrack->Flush();
-   }
+      //Increment sourceSampleCount one blockfull of samples
+      sourceSampleCount += blockSize;
 
-   // Take the output tracks and insert in place of the original
-   // sample data.
-   leftTrack->ClearAndPaste(
-      mCurT0, mCurT1, outputLeftTrack.get(), false, true, &warper);
-   rightTrack->ClearAndPaste(
-      mCurT0, mCurT1, outputRightTrack.get(), false, true, &warper);
+      //Update the Progress meter
+      sink.Progress((sourceSampleCount - start).as_double() / len);
+      if (sink.Cancelled())
+         return;
+   }
 
-   // Track the longest result length
-   double newLength = outputLeftTrack->GetEndTime();
-   m_maxNewLength = wxMax(m_maxNewLength, newLength);
-   newLength = outputRightTrack->GetEndTime();
-   m_maxNewLength = wxMax(m_maxNewLength, newLength);
+   // Tell SoundTouch to finish processing any remaining samples
+   soundTouch.flush();
 
-   //Return true because the effect processing succeeded.
-   return true;
+   unsigned int outputCount = soundTouch.numSamples();
+   if (outputCount > 0)
+      this->ProcessStereoResults(soundTouch, outputCount, sink);
 }
 
-bool EffectSoundTouch::ProcessStereoResults(const size_t outputCount,
-                                            WaveTrack* outputLeftTrack,
-                                            WaveTrack* outputRightTrack)
+void EffectSoundTouch::ProcessStereoResults(soundtouch::SoundTouch &soundTouch,
+                                            const size_t outputCount,
+                                            ParallelTrackJobs::Sink &sink)
 {
    Floats outputSoundTouchBuffer{ outputCount * 2 };
-   mSoundTouch->receiveSamples(outputSoundTouchBuffer.get(), outputCount);
+   soundTouch.receiveSamples(outputSoundTouchBuffer.get(), outputCount);
 
    // Dis-interleave outputSoundTouchBuffer into separate track buffers.
    Floats outputLeftBuffer{ outputCount };
@@ -373,10 +356,9 @@ bool EffectSoundTouch::ProcessStereoResults(const size_t outputCount,
       outputRightBuffer[index] = outputSoundTouchBuffer[(index*2)+1];
    }
 
-   outputLeftTrack->Append((samplePtr)outputLeftBuffer.get(), floatSample, outputCount);
-   outputRightTrack->Append((samplePtr)outputRightBuffer.get(), floatSample, outputCount);
-
-   return true;
+   const float *channels[] =
+      { outputLeftBuffer.get(), outputRightBuffer.get() };
+   sink.Put(channels, outputCount);
 }
 
 #endif // USE_SOUNDTOUCH
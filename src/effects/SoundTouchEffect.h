@@ -20,6 +20,9 @@
 #define __AUDACITY_EFFECT_SOUNDTOUCH__
 
 #include "Effect.h"
+#include "ParallelTrackJobs.h"
+
+#include <functional>
 
 // forward declaration of a class defined in SoundTouch.h
 // which is not included here
@@ -32,10 +35,6 @@ class WaveTrack;
 class EffectSoundTouch /* not final */ : public Effect
 {
 public:
-   
-   // Effect implementation
-
-   void End() override;
 
    // EffectSoundTouch implementation
 
@@ -48,9 +47,11 @@ public:
 protected:
    // Effect implementation
 
-   bool ProcessWithTimeWarper(const TimeWarper &warper);
+   // Sets the subclass-specific parameters of an engine; each track or
+   // stereo pair gets its own engine, so that they can be processed at once
+   using InitFunction = std::function< void(soundtouch::SoundTouch *soundtouch) >;
+   bool ProcessWithTimeWarper(InitFunction initer, const TimeWarper &warper);
 
-   std::unique_ptr<soundtouch::SoundTouch> mSoundTouch;
    double mCurT0;
    double mCurT1;
 
@@ -59,17 +60,17 @@ private:
 #ifdef USE_MIDI
    bool ProcessNoteTrack(NoteTrack *track, const TimeWarper &warper);
 #endif
-   bool ProcessOne(
+   // These run on worker threads, and give output to the sink
+   void ProcessOne(soundtouch::SoundTouch &soundTouch,
       WaveTrack * t, sampleCount start, sampleCount end,
-      const TimeWarper &warper);
-   bool ProcessStereo(WaveTrack* leftTrack, WaveTrack* rightTrack,
+      ParallelTrackJobs::Sink &sink);
+   void ProcessStereo(soundtouch::SoundTouch &soundTouch,
+                     WaveTrack* leftTrack, WaveTrack* rightTrack,
                      sampleCount start, sampleCount end,
-                      const TimeWarper &warper);
-   bool ProcessStereoResults(const size_t outputCount,
-                              WaveTrack* outputLeftTrack,
-                              WaveTrack* outputRightTrack);
-
-   int    mCurTrackNum;
+                     ParallelTrackJobs::Sink &sink);
+   void ProcessStereoResults(soundtouch::SoundTouch &soundTouch,
+                              const size_t outputCount,
+                              ParallelTrackJobs::Sink &sink);
 
    double m_maxNewLength;
 };
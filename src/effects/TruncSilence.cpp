@@ -620,9 +620,6 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
    // Keep position in overall silences list for optimization
    RegionList::iterator rit(silenceList.begin());
 
-   // Allocate buffer
-   Floats buffer{ blockLen };
-
    // Loop through current track
    while (*index < end) {
       if (inputLength && ((outLength >= previewLen) || (*index - start > wt->TimeToLongSamples(*minInputLength)))) {
@@ -688,54 +685,87 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
       // Limit size of current block if we've reached the end
       auto count = limitSampleBufferSize( blockLen, end - *index );
 
-      // Fill buffer
-      wt->Get((samplePtr)(buffer.get()), floatSample, *index, count);
+      // Find the quiet runs in current block, and take the loud samples
+      // between them.  Preview needs every run, to know where output
+      // reaches the wanted length.
+      const auto runs = wt->FindQuietRuns(*index, *index + count,
+         truncDbSilenceThreshold,
+         inputLength ? sampleCount{ 1 } : minSilenceFrames);
+      auto pos = *index;
+      // In preview, stop before the sample after those giving enough output
+      const auto limit = inputLength
+         ? std::min(previewLen, wt->TimeToLongSamples(*minInputLength) + 1)
+         : sampleCount{ 0 };
+      bool stopped = false;
+      if (inputLength && outLength >= limit) {
+         *inputLength = wt->LongSamplesToTime(pos) - wt->LongSamplesToTime(start);
+         stopped = true;
+      }
+      const auto takeLoud = [&](sampleCount next) {
+         // The first loud sample ends any silence
+         sampleCount allowed = 0;
+         if (*silentFrame >= minSilenceFrames) {
+            if (inputLength) {
+               switch (mActionIndex) {
+                  case kTruncate:
+                     outLength += wt->TimeToLongSamples(mTruncLongestAllowedSilence);
+                     break;
+                  case kCompress:
+                     allowed = wt->TimeToLongSamples(mInitialAllowedSilence);
+                     outLength += sampleCount(
+                        allowed.as_double() +
+                           (*silentFrame - allowed).as_double()
+                              * mSilenceCompressPercent / 100.0
+                     );
+                     break;
+                  // default: // Not currently used.
+               }
+            }
 
-      // Look for silenceList in current block
-      for (decltype(count) i = 0; i < count; ++i) {
-         if (inputLength && ((outLength >= previewLen) || (outLength > wt->TimeToLongSamples(*minInputLength)))) {
-            *inputLength = wt->LongSamplesToTime(*index + i) - wt->LongSamplesToTime(start);
-            break;
+            // Record the silent region
+            trackSilences.push_back(Region(
+               wt->LongSamplesToTime(pos - *silentFrame),
+               wt->LongSamplesToTime(pos)
+            ));
          }
-
-         if (fabs(buffer[i]) < truncDbSilenceThreshold) {
-            (*silentFrame)++;
+         else if (inputLength) {   // included as part of non-silence
+            outLength += *silentFrame;
          }
-         else {
-            sampleCount allowed = 0;
-            if (*silentFrame >= minSilenceFrames) {
-               if (inputLength) {
-                  switch (mActionIndex) {
-                     case kTruncate:
-                        outLength += wt->TimeToLongSamples(mTruncLongestAllowedSilence);
-                        break;
-                     case kCompress:
-                        allowed = wt->TimeToLongSamples(mInitialAllowedSilence);
-                        outLength += sampleCount(
-                           allowed.as_double() +
-                              (*silentFrame - allowed).as_double()
-                                 * mSilenceCompressPercent / 100.0
-                        );
-                        break;
-                     // default: // Not currently used.
-                  }
-               }
+         *silentFrame = 0;
 
-               // Record the silent region
-               trackSilences.push_back(Region(
-                  wt->LongSamplesToTime(*index + i - *silentFrame),
-                  wt->LongSamplesToTime(*index + i)
-               ));
-            }
-            else if (inputLength) {   // included as part of non-silence
-               outLength += *silentFrame;
+         if (inputLength) {
+            // Add non-silent samples to outLength
+            const auto needed = std::max(sampleCount{ 1 }, limit - outLength);
+            if (needed < next - pos) {
+               outLength += needed;
+               pos += needed;
+               *inputLength = wt->LongSamplesToTime(pos) - wt->LongSamplesToTime(start);
+               stopped = true;
+               return;
             }
-            *silentFrame = 0;
-            if (inputLength) {
-                ++outLength;   // Add non-silent sample to outLength
+            outLength += next - pos;
+            if (outLength >= limit && next < *index + count) {
+               *inputLength = wt->LongSamplesToTime(next) - wt->LongSamplesToTime(start);
+               stopped = true;
             }
          }
+         pos = next;
+      };
+
+      for (const auto &run : runs) {
+         if (stopped)
+            break;
+         if (run.first > pos) {
+            takeLoud(run.first);
+            if (stopped)
+               break;
+         }
+         *silentFrame += run.second - run.first;
+         pos = run.second;
       }
+      if (!stopped && pos < *index + count)
+         takeLoud(*index + count);
+
       // Next block
       *index += count;
    }
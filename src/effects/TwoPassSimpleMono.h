@@ -75,10 +75,11 @@ protected:
    int    mPass;
    bool   mSecondPassDisabled;
 
+   bool ProcessPass() override;
+
 private:
    bool ProcessOne(WaveTrack * t,
                    sampleCount start, sampleCount end);
-   bool ProcessPass() override;
 };
 
 #endif
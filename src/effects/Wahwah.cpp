@@ -25,6 +25,7 @@
 #include "../Experimental.h"
 
 #include <math.h>
+#include <algorithm>
 
 #include <wx/intl.h>
 #include <wx/slider.h>
@@ -147,7 +148,7 @@ bool EffectWahwah::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelName
 
    if (chanMap[0] == ChannelNameFrontRight)
    {
-      mMaster.phase += M_PI;
+      mMaster.phaseOffset = M_PI;
    }
 
    return true;
@@ -237,6 +238,34 @@ bool EffectWahwah::SetAutomationParameters(CommandParameters & parms)
 
 // Effect implementation
 
+bool EffectWahwah::SupportsParallelProcessing()
+{
+   return true;
+}
+
+bool EffectWahwah::AddParallelProcessor(unsigned WXUNUSED(numChannels),
+   ChannelNames chanMap, float sampleRate,
+   sampleCount WXUNUSED(start), sampleCount WXUNUSED(len))
+{
+   // Offset the right channel's phase, as ProcessInitialize does
+   EffectWahwahState slave;
+
+   InstanceInit(slave, sampleRate);
+   if (chanMap[0] == ChannelNameFrontRight)
+   {
+      slave.phaseOffset = M_PI;
+   }
+
+   mSlaves.push_back(slave);
+
+   return true;
+}
+
+bool EffectWahwah::SupportsChaining()
+{
+   return true;
+}
+
 void EffectWahwah::PopulateOrExchange(ShuttleGui & S)
 {
    S.SetBorder(5);
@@ -363,6 +392,7 @@ void EffectWahwah::InstanceInit(EffectWahwahState & data, float sampleRate)
 
    data.depth = mDepth / 100.0;
    data.freqofs = mFreqOfs / 100.0;
+   data.phaseOffset = 0;
    data.phase = mPhase * M_PI / 180.0;
    data.outgain = DB_TO_LINEAR(mOutGain);
 }
@@ -371,23 +401,25 @@ size_t EffectWahwah::InstanceProcess(EffectWahwahState & data, float **inBlock,
 {
    float *ibuf = inBlock[0];
    float *obuf = outBlock[0];
-   double frequency, omega, sn, cs, alpha;
-   double in, out;
 
    data.lfoskip = mFreq * 2 * M_PI / data.samplerate;
    data.depth = mDepth / 100.0;
    data.freqofs = mFreqOfs / 100.0;
 
-   data.phase = mPhase * M_PI / 180.0;
+   data.phase = mPhase * M_PI / 180.0 + data.phaseOffset;
    data.outgain = DB_TO_LINEAR(mOutGain);
 
-   for (decltype(blockLen) i = 0; i < blockLen; i++)
-   {
-      in = (double) ibuf[i];
+   // Keep the filter history in locals while the coefficients hold still
+   double xn1 = data.xn1, xn2 = data.xn2, yn1 = data.yn1, yn2 = data.yn2;
 
-      if ((data.skipcount++) % lfoskipsamples == 0)
+   for (decltype(blockLen) i = 0; i < blockLen;)
+   {
+      // The LFO moves the filter once every lfoskipsamples samples
+      const auto offset = data.skipcount % lfoskipsamples;
+      if (offset == 0)
       {
-         frequency = (1 + cos(data.skipcount * data.lfoskip + data.phase)) / 2;
+         double frequency, omega, sn, cs, alpha;
+         frequency = (1 + cos((data.skipcount + 1) * data.lfoskip + data.phase)) / 2;
          frequency = frequency * data.depth * (1 - data.freqofs) + data.freqofs;
          frequency = exp((frequency - 1) * 6);
          omega = M_PI * frequency;
@@ -400,17 +432,32 @@ size_t EffectWahwah::InstanceProcess(EffectWahwahState & data, float **inBlock,
          data.a0 = 1 + alpha;
          data.a1 = -2 * cs;
          data.a2 = 1 - alpha;
-      };
-      out = (data.b0 * in + data.b1 * data.xn1 + data.b2 * data.xn2 - data.a1 * data.yn1 - data.a2 * data.yn2) / data.a0;
-      data.xn2 = data.xn1;
-      data.xn1 = in;
-      data.yn2 = data.yn1;
-      data.yn1 = out;
-      out *= data.outgain;
-
-      obuf[i] = (float) out;
+      }
+      const auto count = std::min<size_t>(blockLen - i, lfoskipsamples - offset);
+
+      const double b0 = data.b0 / data.a0, b1 = data.b1 / data.a0,
+         b2 = data.b2 / data.a0, a1 = data.a1 / data.a0, a2 = data.a2 / data.a0;
+      const double outgain = data.outgain;
+      for (auto j = i; j < i + count; j++)
+      {
+         const double in = ibuf[j];
+         const double out = b0 * in + b1 * xn1 + b2 * xn2 - a1 * yn1 - a2 * yn2;
+         xn2 = xn1;
+         xn1 = in;
+         yn2 = yn1;
+         yn1 = out;
+         obuf[j] = (float) (out * outgain);
+      }
+
+      data.skipcount += count;
+      i += count;
    }
 
+   data.xn1 = xn1;
+   data.xn2 = xn2;
+   data.yn1 = yn1;
+   data.yn2 = yn2;
+
    return blockLen;
 }
 
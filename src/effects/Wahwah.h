@@ -29,6 +29,7 @@ public:
    double depth;
    double freqofs;
    double phase;
+   double phaseOffset; // added to the LFO phase: pi for a right channel
    double outgain;
    double lfoskip;
    unsigned long skipcount;
@@ -74,6 +75,10 @@ public:
 
    // Effect implementation
 
+   bool SupportsParallelProcessing() override;
+   bool AddParallelProcessor(unsigned numChannels, ChannelNames chanMap,
+      float sampleRate, sampleCount start, sampleCount len) override;
+   bool SupportsChaining() override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
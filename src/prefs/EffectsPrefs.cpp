@@ -230,15 +230,6 @@ void EffectsPrefs::PopulateOrExchange(ShuttleGui & S)
    S.EndStatic();
 #endif
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   S.StartStatic(XO("Instruction Set"));
-   {
-      S.TieCheckBox(XO("&Use SSE/SSE2/.../AVX"),
-                    wxT("/SSE/GUI"),
-                    true);
-   }
-   S.EndStatic();
-#endif
    S.EndScroller();
 }
 
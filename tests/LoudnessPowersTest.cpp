@@ -0,0 +1,214 @@
+#include "WaveClip.h"
+#include "DirManager.h"
+#include <cassert>
+#include <cmath>
+#include <ctime>
+#include <memory>
+#include <vector>
+#include <iostream>
+
+class LoudnessPowersTest
+{
+private:
+   std::shared_ptr<DirManager> mDirManager;
+   std::unique_ptr<WaveClip> mClip;
+   std::vector<float> mSamples;
+
+   static const size_t HopSize = 4410;
+
+   // Samples the weightings were given, which are all that were read
+   static size_t sWeighted;
+
+   // Leaves the samples as they are
+   static LoudnessWeighting Identity(double)
+   {
+      return [](float *, size_t len) { sWeighted += len; };
+   }
+
+   // Smooths the samples, so that each depends on those before it
+   static LoudnessWeighting Smooth(double)
+   {
+      float previous = 0;
+      return [previous](float *buffer, size_t len) mutable {
+         for (size_t ii = 0; ii < len; ++ii)
+            previous = buffer[ii] = 0.5f * (buffer[ii] + previous);
+         sWeighted += len;
+      };
+   }
+
+public:
+   LoudnessPowersTest()
+   {
+      std::cout << "==> Testing loudness powers of WaveClip\n";
+      srand(time(NULL));
+   }
+
+   void SetUp(size_t len)
+   {
+      DirManager::SetTempDir("/tmp/loudness-powers-test-dir");
+      mDirManager = DirManager::Create();
+
+      mClip = std::make_unique<WaveClip>(mDirManager, floatSample, 44100, 0);
+      mSamples.resize(len);
+      for (auto &sample : mSamples)
+         sample = (rand() % 20001) / 10000.0f - 1.0f;
+      mClip->Append((samplePtr)mSamples.data(), floatSample, len);
+      mClip->Flush();
+
+      sWeighted = 0;
+   }
+
+   void TearDown()
+   {
+      mClip.reset();
+      mDirManager.reset();
+      mSamples.clear();
+   }
+
+   // Powers of nHops whole hops of the clip from firstHop, or of all of
+   // them
+   std::vector<double> Measure(const WaveClip &clip,
+      LoudnessWeightingFactory weighting = Identity, bool cache = true,
+      size_t firstHop = 0, size_t nHops = 0)
+   {
+      if (!nHops)
+         nHops = mSamples.size() / HopSize - firstHop;
+      std::vector<double> powers(nHops, 0.0);
+      bool result = clip.AddLoudnessPowers(HopSize, firstHop, nHops,
+         powers.data(), weighting, cache,
+         [](sampleCount) { return true; });
+      assert(result);
+      return powers;
+   }
+
+   void TestPowers()
+   {
+      std::cout << "\tpowers should be the sums of squares of the hops..." << std::flush;
+
+      const auto powers = Measure(*mClip);
+      for (size_t hop = 0; hop < powers.size(); ++hop) {
+         double sum = 0;
+         for (size_t ii = hop * HopSize; ii < (hop + 1) * HopSize; ++ii)
+            sum += double(mSamples[ii]) * mSamples[ii];
+         assert(fabs(powers[hop] - sum) <= 1e-9 * sum);
+      }
+
+      std::cout << "ok\n";
+   }
+
+   void TestSecondMeasurementReusesCache()
+   {
+      /* The first measurement weights the whole clip, and the second
+       * reads no samples, but gets the same powers */
+
+      std::cout << "\ta second measurement should reuse the kept powers..." << std::flush;
+
+      const auto first = Measure(*mClip);
+      assert(sWeighted == mSamples.size());
+      const auto second = Measure(*mClip);
+      assert(sWeighted == mSamples.size());
+      assert(first == second);
+
+      std::cout << "ok\n";
+   }
+
+   void TestCopyReusesCache()
+   {
+      /* Effects measure copies of the tracks, which share what the
+       * originals keep */
+
+      std::cout << "\ta copy of a measured clip should reuse its powers..." << std::flush;
+
+      const auto first = Measure(*mClip);
+      WaveClip copy{ *mClip, mDirManager, true };
+      const auto second = Measure(copy);
+      assert(sWeighted == mSamples.size());
+      assert(first == second);
+
+      std::cout << "ok\n";
+   }
+
+   void TestChangeInvalidatesCache()
+   {
+      std::cout << "\ta changed clip should be measured again..." << std::flush;
+
+      Measure(*mClip);
+      float sample = 0.5f;
+      mClip->SetSamples((samplePtr)&sample, floatSample, 0, 1);
+      mSamples[0] = sample;
+      Measure(*mClip);
+      assert(sWeighted == 2 * mSamples.size());
+
+      std::cout << "ok\n";
+   }
+
+   void TestOtherWeightingMeasuresAgain()
+   {
+      /* Powers kept for one weighting are not given for another */
+
+      std::cout << "\tanother weighting should be measured again..." << std::flush;
+
+      const auto identity = Measure(*mClip, Identity);
+      const auto smooth = Measure(*mClip, Smooth);
+      assert(sWeighted == 2 * mSamples.size());
+      assert(identity != smooth);
+      assert(Measure(*mClip, Smooth) == smooth);
+      assert(sWeighted == 2 * mSamples.size());
+
+      std::cout << "ok\n";
+   }
+
+   void TestSameWithoutCache()
+   {
+      /* The filter starts at the clip's start whether or not the powers
+       * are kept, so hops measured alone, before or after the whole clip,
+       * get the same powers */
+
+      std::cout << "\thops measured alone should get the kept powers..." << std::flush;
+
+      const size_t firstHop = 10, nHops = 5;
+      const auto before = Measure(*mClip, Smooth, false, firstHop, nHops);
+      const auto all = Measure(*mClip, Smooth);
+      const auto after = Measure(*mClip, Smooth, false, firstHop, nHops);
+      for (size_t ii = 0; ii < nHops; ++ii) {
+         assert(before[ii] == all[firstHop + ii]);
+         assert(after[ii] == all[firstHop + ii]);
+      }
+
+      std::cout << "ok\n";
+   }
+
+};
+
+size_t LoudnessPowersTest::sWeighted;
+
+int main()
+{
+   LoudnessPowersTest tester;
+
+   tester.SetUp(100003);
+   tester.TestPowers();
+   tester.TearDown();
+
+   tester.SetUp(100003);
+   tester.TestSecondMeasurementReusesCache();
+   tester.TearDown();
+
+   tester.SetUp(100003);
+   tester.TestCopyReusesCache();
+   tester.TearDown();
+
+   tester.SetUp(100003);
+   tester.TestChangeInvalidatesCache();
+   tester.TearDown();
+
+   tester.SetUp(100003);
+   tester.TestOtherWeightingMeasuresAgain();
+   tester.TearDown();
+
+   tester.SetUp(100003);
+   tester.TestSameWithoutCache();
+   tester.TearDown();
+
+   return 0;
+}
@@ -0,0 +1,160 @@
+#include "effects/Phaser.h"
+#include "effects/Wahwah.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <iostream>
+
+class ParallelEffectTest
+{
+private:
+   std::vector<float> mLeft, mRight;
+
+   static constexpr size_t BlockSize = 512;
+   static constexpr float Rate = 44100.0f;
+
+public:
+   ParallelEffectTest()
+   {
+      std::cout << "==> Testing parallel processing of effects\n";
+      srand(time(NULL));
+   }
+
+   void SetUp(size_t len)
+   {
+      mLeft.resize(len);
+      mRight.resize(len);
+      for (auto &sample : mLeft)
+         sample = (rand() % 20001) / 10000.0f - 1.0f;
+      for (auto &sample : mRight)
+         sample = (rand() % 20001) / 10000.0f - 1.0f;
+   }
+
+   void TearDown()
+   {
+      mLeft.clear();
+      mRight.clear();
+   }
+
+   // Processes the channels of a stereo track one at a time with
+   // ProcessBlock, as ProcessTrack does
+   void ProcessOffline(Effect &effect,
+      std::vector<float> &left, std::vector<float> &right)
+   {
+      ChannelName leftMap[] = { ChannelNameFrontLeft, ChannelNameEOL };
+      ChannelName rightMap[] = { ChannelNameFrontRight, ChannelNameEOL };
+      effect.SetSampleRate(Rate);
+      left = ProcessChannel(effect, mLeft, leftMap);
+      right = ProcessChannel(effect, mRight, rightMap);
+   }
+
+   std::vector<float> ProcessChannel(
+      Effect &effect, std::vector<float> input, ChannelNames map)
+   {
+      std::vector<float> output(input.size());
+      bool result = effect.ProcessInitialize(input.size(), map);
+      assert(result);
+      for (size_t pos = 0; pos < input.size(); pos += BlockSize) {
+         const auto len = std::min(BlockSize, input.size() - pos);
+         float *in = &input[pos];
+         float *out = &output[pos];
+         effect.ProcessBlock(&in, &out, len);
+      }
+      effect.ProcessFinalize();
+      return output;
+   }
+
+   // Processes the channels with one parallel processor each, as
+   // ProcessPassParallel does
+   void ProcessParallel(Effect &effect,
+      std::vector<float> &left, std::vector<float> &right)
+   {
+      ChannelName leftMap[] = { ChannelNameFrontLeft, ChannelNameEOL };
+      ChannelName rightMap[] = { ChannelNameFrontRight, ChannelNameEOL };
+      const sampleCount len = mLeft.size();
+      effect.SetSampleRate(Rate);
+      bool result = effect.RealtimeInitialize() &&
+         effect.AddParallelProcessor(1, leftMap, Rate, 0, len) &&
+         effect.AddParallelProcessor(1, rightMap, Rate, 0, len);
+      assert(result);
+
+      std::vector<float> leftIn = mLeft, rightIn = mRight;
+      left.resize(mLeft.size());
+      right.resize(mRight.size());
+      for (size_t pos = 0; pos < mLeft.size(); pos += BlockSize) {
+         const auto count = std::min(BlockSize, mLeft.size() - pos);
+         float *in = &leftIn[pos];
+         float *out = &left[pos];
+         effect.RealtimeProcess(0, &in, &out, count);
+         in = &rightIn[pos];
+         out = &right[pos];
+         effect.RealtimeProcess(1, &in, &out, count);
+      }
+      effect.RealtimeFinalize();
+   }
+
+   void TestSameResults(Effect &effect, const char *name)
+   {
+      /* Both paths give the right channel the LFO half a cycle after
+       * the left one, so they agree, channel for channel */
+
+      std::cout << "\t" << name
+         << " in parallel should give the stereo output of ProcessBlock..."
+         << std::flush;
+
+      assert(effect.SupportsParallelProcessing());
+
+      std::vector<float> left, right, parallelLeft, parallelRight;
+      ProcessOffline(effect, left, right);
+      ProcessParallel(effect, parallelLeft, parallelRight);
+      for (size_t ii = 0; ii < mLeft.size(); ++ii) {
+         assert(fabs(left[ii] - parallelLeft[ii]) < 1e-6);
+         assert(fabs(right[ii] - parallelRight[ii]) < 1e-6);
+      }
+
+      std::cout << "ok\n";
+   }
+
+   void TestRightChannelOffset(Effect &effect, const char *name)
+   {
+      /* The same input in both channels comes out different, because of
+       * the phase offset */
+
+      std::cout << "\t" << name
+         << " in parallel should offset the phase of the right channel..."
+         << std::flush;
+
+      mRight = mLeft;
+      std::vector<float> left, right;
+      ProcessParallel(effect, left, right);
+      assert(left != right);
+
+      std::cout << "ok\n";
+   }
+
+};
+
+constexpr size_t ParallelEffectTest::BlockSize;
+constexpr float ParallelEffectTest::Rate;
+
+int main()
+{
+   ParallelEffectTest tester;
+   EffectPhaser phaser;
+   EffectWahwah wahwah;
+
+   // Several seconds, for several cycles of the LFOs
+   tester.SetUp(441000);
+   tester.TestSameResults(phaser, "Phaser");
+   tester.TestSameResults(wahwah, "Wahwah");
+   tester.TearDown();
+
+   tester.SetUp(441000);
+   tester.TestRightChannelOffset(phaser, "Phaser");
+   tester.TestRightChannelOffset(wahwah, "Wahwah");
+   tester.TearDown();
+
+   return 0;
+}
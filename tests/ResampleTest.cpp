@@ -0,0 +1,138 @@
+#include "Resample.h"
+#include "Prefs.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <iostream>
+
+class ResampleTest
+{
+private:
+   std::vector<float> mInput;
+
+public:
+   ResampleTest()
+   {
+      std::cout << "==> Testing Resample\n";
+      srand(time(NULL));
+   }
+
+   void SetUp(size_t len)
+   {
+      // The resamplers read their method from the preferences, and get
+      // the default from an empty file
+      gPrefs = new AudacityPrefs(wxT("ResampleTest"), wxEmptyString,
+         wxT("/tmp/resample-test.cfg"), wxEmptyString,
+         wxCONFIG_USE_LOCAL_FILE);
+
+      mInput.resize(len);
+      for (auto &sample : mInput)
+         sample = (rand() % 20001) / 10000.0f - 1.0f;
+   }
+
+   void TearDown()
+   {
+      delete gPrefs;
+      gPrefs = NULL;
+      mInput.clear();
+   }
+
+   std::vector<float> ProcessConstantRate(double factor)
+   {
+      std::vector<float> output;
+      bool result = Resample::ProcessConstantRate(factor, mInput.size(),
+         [&](float *buffer, sampleCount start, size_t len) {
+            std::copy(&mInput[start.as_size_t()],
+               &mInput[start.as_size_t()] + len, buffer);
+         },
+         [&](const float *buffer, size_t len) {
+            output.insert(output.end(), buffer, buffer + len);
+         },
+         [](sampleCount) { return true; });
+      assert(result);
+      return output;
+   }
+
+   // Resamples in one pass, giving all the output that the resampler
+   // flushes after the last input
+   std::vector<float> ProcessOnePass(double factor)
+   {
+      Resample resample(true, factor, factor);
+      const size_t outBufferLen = size_t(factor * mInput.size() + 10);
+      std::vector<float> output(outBufferLen);
+      size_t pos = 0, outLen = 0, outGenerated = 0;
+      do {
+         const auto results = resample.Process(factor,
+            mInput.data() + pos, mInput.size() - pos, true,
+            output.data() + outLen, outBufferLen - outLen);
+         pos += results.first;
+         outGenerated = results.second;
+         outLen += outGenerated;
+      } while (pos < mInput.size() || outGenerated > 0);
+      output.resize(outLen);
+      return output;
+   }
+
+   void TestOnePassLength()
+   {
+      /* A short stream is resampled in one pass, and the output includes
+       * the resampler's tail, so it lasts as long as the input */
+
+      std::cout << "\tshort output should have the length of the input, times the factor..." << std::flush;
+
+      const double factor = 48000.0 / 44100.0;
+      const auto output = ProcessConstantRate(factor);
+      assert(output.size() == size_t(llrint(mInput.size() * factor)));
+
+      std::cout << "ok\n";
+   }
+
+   void TestSegmentedLength()
+   {
+      std::cout << "\tlong output should have the length of the input, times the factor..." << std::flush;
+
+      for (double factor : { 48000.0 / 44100.0, 44100.0 / 48000.0, 0.5 }) {
+         const auto output = ProcessConstantRate(factor);
+         assert(output.size() == size_t(llrint(mInput.size() * factor)));
+      }
+
+      std::cout << "ok\n";
+   }
+
+   void TestSegmentedMatchesOnePass()
+   {
+      std::cout << "\tlong output resampled in segments should match one pass..." << std::flush;
+
+      const double factor = 44100.0 / 48000.0;
+      const auto segmented = ProcessConstantRate(factor);
+      const auto onePass = ProcessOnePass(factor);
+      assert(segmented.size() == onePass.size());
+      for (size_t ii = 0; ii < onePass.size(); ++ii)
+         assert(fabs(segmented[ii] - onePass[ii]) < 1e-6);
+
+      std::cout << "ok\n";
+   }
+
+};
+
+int main()
+{
+   ResampleTest tester;
+
+   tester.SetUp(100003);
+   tester.TestOnePassLength();
+   tester.TearDown();
+
+   // Long enough for several segments
+   tester.SetUp(3000000);
+   tester.TestSegmentedLength();
+   tester.TearDown();
+
+   tester.SetUp(3000000);
+   tester.TestSegmentedMatchesOnePass();
+   tester.TearDown();
+
+   return 0;
+}